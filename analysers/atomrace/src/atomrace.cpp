@@ -25,8 +25,8 @@
  * @file      atomrace.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-01-30
- * @date      Last Update 2019-02-05
- * @version   0.2.6
+ * @date      Last Update 2026-10-16
+ * @version   0.2.9
  */
 
 #include "anaconda/anaconda.h"
@@ -55,12 +55,7 @@ typedef struct CurrentAccess_s
    * @brief A source code location where the access originates from.
    */
   LOCATION location;
-  Backtrace bt; //!< A backtrace of a thread.
-
-  /**
-   * Constructs a CurrentAccess_s object.
-   */
-  CurrentAccess_s() : op(READ), thread(0), variable(), location(), bt() {}
+  BacktraceId bt; //!< A backtrace of a thread.
 
   /**
    * Constructs a CurrentAccess_s object.
@@ -68,10 +63,11 @@ typedef struct CurrentAccess_s
    * @param o A type of the access.
    * @param t A thread which is performing the access.
    * @param v A variable which is accessed.
-   * @param l A source code location where the access originates from.
+   * @param l A source code location where the access originates from (its
+   *   file name is interned by the framework, so it may be referenced).
    */
-  CurrentAccess_s(Operation o, THREADID t, VARIABLE v, LOCATION l) : op(o),
-    thread(t), variable(v), location(l), bt() {}
+  CurrentAccess_s(Operation o, THREADID t, VARIABLE v, const LOCATION& l)
+    : op(o), thread(t), variable(v), location(l), bt(0) {}
 } CurrentAccess;
 
 namespace
@@ -142,7 +138,6 @@ VOID beforeMemoryAccess(Operation op, THREADID tid, ADDRINT addr,
         + ((location.file.empty()) ? "<unknown>" : location.file) + "\n");
 
       // Helper variables
-      Backtrace bt;
       Symbols symbols;
       std::string tcloc;
 
@@ -165,10 +160,8 @@ VOID beforeMemoryAccess(Operation op, THREADID tid, ADDRINT addr,
       // Reuse the symbol list for the current thread
       symbols.clear();
 
-      // Get the backtrace of the current thread
-      THREAD_GetBacktrace(tid, bt);
-      // Translate the return addresses to locations
-      THREAD_GetBacktraceSymbols(bt, symbols);
+      // Translate the return addresses in the current backtrace to locations
+      THREAD_GetBacktraceSymbols(THREAD_GetBacktraceId(tid), symbols);
 
       CONSOLE_NOPREFIX("\n  Thread " + decstr(tid) + " backtrace:\n");
 
@@ -187,8 +180,8 @@ VOID beforeMemoryAccess(Operation op, THREADID tid, ADDRINT addr,
   { // If no thread is currently accessing the memory, record this access
     it = g_currentAccessMap.insert(CurrentAccessMap::value_type(addr,
       CurrentAccess(op, tid, variable, location))).first;
-    // Get the backtrace of the current thread
-    THREAD_GetBacktrace(tid, it->second.bt);
+    // Get the backtrace of the current thread (only its identifier is stored)
+    it->second.bt = THREAD_GetBacktraceId(tid);
   }
 
   // Now we can finally release the lock
@@ -300,6 +293,9 @@ PLUGIN_INIT_FUNCTION()
   ACCESS_AfterMemoryRead(afterMemoryRead);
   ACCESS_AfterMemoryWrite(afterMemoryWrite);
 
+  // Missing some accesses in frequently executed functions is acceptable
+  ACCESS_AllowSampling();
+
   // Initialise R/W mutex for guarding access to the last access map
   PIN_MutexInit(&g_currentAccessMapMutex);
 }
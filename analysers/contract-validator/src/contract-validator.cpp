@@ -26,12 +26,13 @@
  * @file      contract-validator.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2016-02-18
- * @date      Last Update 2019-02-05
- * @version   0.8.2
+ * @date      Last Update 2026-10-16
+ * @version   0.8.4
  */
 
 #include "anaconda/anaconda.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -97,6 +98,11 @@ namespace
   typedef std::map< LOCK, VectorClock > LockVectorClocks;
   LockVectorClocks g_locks; //!< Vector clocks for locks (L).
   PIN_RWMUTEX g_locksLock; //!< A lock guarding access to @c g_locks map.
+
+  /**
+   * @brief A set of names of functions used in the contracts to be checked.
+   */
+  std::set< std::string > g_alphabet;
 }
 
 // A helper macro for accessing a number uniquely identifying current thread
@@ -393,6 +399,18 @@ VOID functionExited(THREADID tid)
 #endif
 }
 
+/**
+ * Checks if a function is used in any of the contracts to be checked.
+ *
+ * @param idx An index of the function.
+ * @return @em True if the function is used in some contract, @em false
+ *   otherwise.
+ */
+BOOL isContractFunction(index_t idx)
+{
+  return g_alphabet.count(THREAD_GetFunctionName(idx)) != 0;
+}
+
 /**
  * Initialises the analyser.
  */
@@ -422,14 +440,24 @@ PLUGIN_INIT_FUNCTION()
   THREAD_ThreadForked(threadForked);
 
   // Register callback functions called when a function is executed
-  THREAD_FunctionEntered(functionEntered);
-  THREAD_FunctionExited(functionExited);
+  // (only functions used in the contracts are interesting for us)
+  THREAD_FunctionEntered(functionEntered, isContractFunction);
+  THREAD_FunctionExited(functionExited, isContractFunction);
 
   // Load the contracts to be checked
   Contract* contract = new Contract();
   contract->load("contracts");
   g_contracts.push_back(contract);
 
+  for (Target* target : contract->getTargets())
+  { // Remember the functions which need to be monitored
+    g_alphabet.insert(target->fa->alphabet.begin(), target->fa->alphabet.end());
+
+    for (Spoiler* spoiler : target->spoilers)
+      g_alphabet.insert(spoiler->fa->alphabet.begin(),
+        spoiler->fa->alphabet.end());
+  }
+
   // Dump the loaded contracts
   fs::ofstream f("contracts.dump");
   f << contract->toString();
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2012-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2012-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -20,19 +20,107 @@
 /**
  * @brief Contains the entry part of the event printer ANaConDA plugin.
  *
- * A file containing the entry part of the event printer ANaConDA plugin.
+ * A file containing the entry part of the event printer ANaConDA plugin. The
+ *   plugin either prints the events as text or writes them to a binary trace,
+ *   which can be printed as text later by the event printer decoder.
  *
  * @file      event-printer.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-01-05
- * @date      Last Update 2019-02-05
- * @version   0.2.1
+ * @date      Last Update 2026-10-16
+ * @version   0.3.3
  */
 
+#include <string.h>
+
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
 #include "anaconda/anaconda.h"
 
+#include "anaconda/utils/clock.hpp"
+#include "anaconda/utils/lockobj.hpp"
+#include "anaconda/utils/scopedlock.hpp"
 #include "anaconda/utils/plugin/settings.hpp"
 
+#include "trace.h"
+
+// A number of records a thread collects before writing them to the trace
+#define TRACE_BUFFER_SIZE 4096
+
+// Definitions of helper data types
+typedef std::unordered_map< std::string, UINT32 > StringTable;
+typedef std::unordered_map< index_t, UINT32 > FunctionTable;
+typedef std::unordered_map< const std::string*, UINT32 > FileTable;
+
+/**
+ * @brief A structure holding the last string a thread used in some item of
+ *   the records together with its ID.
+ */
+typedef struct LastString_s
+{
+  bool valid; //!< A flag determining if a string was already used.
+  std::string str; //!< The last string used.
+  UINT32 id; //!< An ID of the last string used.
+
+  /**
+   * Constructs a LastString_s object.
+   */
+  LastString_s() : valid(false), str(), id(0) {}
+} LastString;
+
+/**
+ * @brief A structure holding private data of a thread.
+ *
+ * @note The lock guards the records only, the plugin writes the records of
+ *   threads which are still running when it finishes.
+ */
+typedef struct ThreadData_s : public LockableObject
+{
+  THREADID tid; //!< A number identifying the thread.
+  std::vector< EventRecord > records; //!< Records not written to the trace.
+  StringTable strings; //!< IDs of strings already used by the thread.
+  FunctionTable functions; //!< IDs of names of functions (by their index).
+  FileTable files; //!< IDs of names of files (by their interned addresses).
+  LastString name; //!< The name of the last variable accessed.
+  LastString vtype; //!< The type of the last variable accessed.
+
+  /**
+   * Constructs a ThreadData_s object.
+   *
+   * @param t A number identifying the thread.
+   */
+  ThreadData_s(THREADID t) : tid(t) { records.reserve(TRACE_BUFFER_SIZE); }
+
+  /**
+   * Writes the records not written to the trace yet.
+   */
+  ~ThreadData_s();
+} ThreadData;
+
+namespace
+{ // Static global variables (usable only within this module)
+  /**
+   * @brief A flag determining if the events are written to a binary trace
+   *   (@em true) or printed as text (@em false).
+   */
+  bool g_binary = false;
+  std::ofstream g_trace; //!< A file containing the binary trace.
+  PIN_MUTEX g_traceLock; //!< A lock guarding the trace and the strings.
+  PIN_MUTEX g_threadsLock; //!< A lock guarding the private data of threads.
+  UINT64 g_records = 0; //!< A number of records written to the trace.
+  StringTable g_strings; //!< IDs of all strings used in the trace.
+  std::vector< const std::string* > g_stringsById; //!< Strings by their IDs.
+  ThreadData* g_threads[PIN_MAX_THREADS]; //!< Private data of all threads.
+
+  // A slot holding private data of a thread in the Thread Local Storage
+  TlsSlot< ThreadData > g_tls;
+}
+
+// A helper macro for accessing the Thread Local Storage (TLS) more easily
+#define TLS g_tls.get(tid)
+
 /**
  * Gets a declaration of a variable.
  *
@@ -60,7 +148,7 @@ std::string getVariableDeclaration(const VARIABLE& variable)
 VOID beforeMemoryRead(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("Before thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "Before thread " + decstr(tid)
     + " read " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " from memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -81,7 +169,7 @@ VOID beforeMemoryRead(THREADID tid, ADDRINT addr, UINT32 size,
 VOID afterMemoryRead(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("After thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "After thread " + decstr(tid)
     + " read " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " from memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -102,7 +190,7 @@ VOID afterMemoryRead(THREADID tid, ADDRINT addr, UINT32 size,
 VOID beforeMemoryWrite(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("Before thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "Before thread " + decstr(tid)
     + " written " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " to memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -123,7 +211,7 @@ VOID beforeMemoryWrite(THREADID tid, ADDRINT addr, UINT32 size,
 VOID afterMemoryWrite(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("After thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "After thread " + decstr(tid)
     + " written " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " to memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -144,7 +232,7 @@ VOID afterMemoryWrite(THREADID tid, ADDRINT addr, UINT32 size,
 VOID beforeAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("Before thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "Before thread " + decstr(tid)
     + " updated " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " at memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -165,7 +253,7 @@ VOID beforeAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
 VOID afterAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location)
 {
-  CONSOLE("After thread " + decstr(tid)
+  CONSOLE_ASYNC(tid, "After thread " + decstr(tid)
     + " updated " + decstr(size) + " " + ((size == 1) ? "byte" : "bytes")
     + " at memory address " + hexstr(addr)
     + "\n  variable " + getVariableDeclaration(variable)
@@ -182,8 +270,8 @@ VOID afterAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
  */
 VOID beforeLockAcquire(THREADID tid, LOCK lock)
 {
-  CONSOLE("Before lock acquired: thread " + decstr(tid) + ", lock " + lock
-    + "\n");
+  CONSOLE_ASYNC(tid, "Before lock acquired: thread " + decstr(tid)
+    + ", lock " + lock + "\n");
 }
 
 /**
@@ -194,8 +282,8 @@ VOID beforeLockAcquire(THREADID tid, LOCK lock)
  */
 VOID beforeLockRelease(THREADID tid, LOCK lock)
 {
-  CONSOLE("Before lock released: thread " + decstr(tid) + ", lock " + lock
-    + "\n");
+  CONSOLE_ASYNC(tid, "Before lock released: thread " + decstr(tid)
+    + ", lock " + lock + "\n");
 }
 
 /**
@@ -206,8 +294,8 @@ VOID beforeLockRelease(THREADID tid, LOCK lock)
  */
 VOID beforeSignal(THREADID tid, COND cond)
 {
-  CONSOLE("Before signal send: thread " + decstr(tid) + ", condition " + cond
-    + "\n");
+  CONSOLE_ASYNC(tid, "Before signal send: thread " + decstr(tid)
+    + ", condition " + cond + "\n");
 }
 
 /**
@@ -219,7 +307,8 @@ VOID beforeSignal(THREADID tid, COND cond)
  */
 VOID beforeWait(THREADID tid, COND cond)
 {
-  CONSOLE("Before wait: thread " + decstr(tid) + ", condition " + cond + "\n");
+  CONSOLE_ASYNC(tid, "Before wait: thread " + decstr(tid) + ", condition "
+    + cond + "\n");
 }
 
 /**
@@ -230,8 +319,8 @@ VOID beforeWait(THREADID tid, COND cond)
  */
 VOID afterLockAcquire(THREADID tid, LOCK lock)
 {
-  CONSOLE("After lock acquired: thread " + decstr(tid) + ", lock " + lock
-    + "\n");
+  CONSOLE_ASYNC(tid, "After lock acquired: thread " + decstr(tid)
+    + ", lock " + lock + "\n");
 }
 
 /**
@@ -242,8 +331,8 @@ VOID afterLockAcquire(THREADID tid, LOCK lock)
  */
 VOID afterLockRelease(THREADID tid, LOCK lock)
 {
-  CONSOLE("After lock released: thread " + decstr(tid) + ", lock " + lock
-    + "\n");
+  CONSOLE_ASYNC(tid, "After lock released: thread " + decstr(tid)
+    + ", lock " + lock + "\n");
 }
 
 /**
@@ -254,8 +343,8 @@ VOID afterLockRelease(THREADID tid, LOCK lock)
  */
 VOID afterSignal(THREADID tid, COND cond)
 {
-  CONSOLE("After signal send: thread " + decstr(tid) + ", condition " + cond
-    + "\n");
+  CONSOLE_ASYNC(tid, "After signal send: thread " + decstr(tid)
+    + ", condition " + cond + "\n");
 }
 
 /**
@@ -267,7 +356,8 @@ VOID afterSignal(THREADID tid, COND cond)
  */
 VOID afterWait(THREADID tid, COND cond)
 {
-  CONSOLE("After wait: thread " + decstr(tid) + ", condition " + cond + "\n");
+  CONSOLE_ASYNC(tid, "After wait: thread " + decstr(tid) + ", condition "
+    + cond + "\n");
 }
 
 /**
@@ -277,7 +367,7 @@ VOID afterWait(THREADID tid, COND cond)
  */
 VOID threadStarted(THREADID tid)
 {
-  CONSOLE("Thread " + decstr(tid) + " started.\n");
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " started.\n");
 }
 
 /**
@@ -287,7 +377,7 @@ VOID threadStarted(THREADID tid)
  */
 VOID threadFinished(THREADID tid)
 {
-  CONSOLE("Thread " + decstr(tid) + " finished.\n");
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " finished.\n");
 }
 
 /**
@@ -303,7 +393,7 @@ VOID functionEntered(THREADID tid)
   // Get a full signature of the currently executed function
   THREAD_GetCurrentFunction(tid, signature);
 
-  CONSOLE("Thread " + decstr(tid) + " started executing a function "
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " started executing a function "
     + signature + "\n");
 }
 
@@ -320,7 +410,7 @@ VOID functionExited(THREADID tid)
   // Get a full signature of the currently executed function
   THREAD_GetCurrentFunction(tid, signature);
 
-  CONSOLE("Thread " + decstr(tid) + " finished executing a function "
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " finished executing a function "
     + signature + "\n");
 }
 
@@ -334,8 +424,8 @@ VOID functionExited(THREADID tid)
  */
 VOID beforeJoin(THREADID tid, THREADID jtid)
 {
-  CONSOLE("Before thread " + decstr(tid) + " joined with thread " + decstr(jtid)
-    + "\n");
+  CONSOLE_ASYNC(tid, "Before thread " + decstr(tid) + " joined with thread "
+    + decstr(jtid) + "\n");
 }
 
 /**
@@ -348,8 +438,8 @@ VOID beforeJoin(THREADID tid, THREADID jtid)
  */
 VOID afterJoin(THREADID tid, THREADID jtid)
 {
-  CONSOLE("After thread " + decstr(tid) + " joined with thread " + decstr(jtid)
-    + "\n");
+  CONSOLE_ASYNC(tid, "After thread " + decstr(tid) + " joined with thread "
+    + decstr(jtid) + "\n");
 }
 
 /**
@@ -360,8 +450,8 @@ VOID afterJoin(THREADID tid, THREADID jtid)
  */
 VOID exceptionThrown(THREADID tid, const EXCEPTION& exception)
 {
-  CONSOLE("Thread " + decstr(tid) + " has thrown exception " + exception.name
-    + ".\n");
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " has thrown exception "
+    + exception.name + ".\n");
 }
 
 /**
@@ -372,8 +462,445 @@ VOID exceptionThrown(THREADID tid, const EXCEPTION& exception)
  */
 VOID exceptionCaught(THREADID tid, const EXCEPTION& exception)
 {
-  CONSOLE("Thread " + decstr(tid) + " has caught exception " + exception.name
-    + ".\n");
+  CONSOLE_ASYNC(tid, "Thread " + decstr(tid) + " has caught exception "
+    + exception.name + ".\n");
+}
+
+/**
+ * Writes the records collected by a thread to the binary trace.
+ *
+ * @warning The trace lock must be held when calling this function.
+ *
+ * @param data Private data of the thread.
+ */
+inline
+VOID writeRecords(ThreadData* data)
+{
+  if (data->records.empty()) return;
+
+  if (g_trace.is_open())
+  { // The trace is closed when the plugin finishes, drop any late records
+    g_trace.write(reinterpret_cast< const char* >(data->records.data()),
+      data->records.size() * sizeof(EventRecord));
+
+    g_records += data->records.size();
+  }
+
+  data->records.clear();
+}
+
+/**
+ * Writes the records not written to the trace yet.
+ */
+ThreadData_s::~ThreadData_s()
+{
+  { // The thread finished, the plugin does not need to flush its records now
+    ScopedLock lock(g_threadsLock);
+
+    if (g_threads[tid] == this) g_threads[tid] = NULL;
+  }
+
+  ScopedLock lock(g_traceLock);
+
+  writeRecords(this);
+}
+
+/**
+ * Gets an ID of a string stored in the binary trace.
+ *
+ * @note Each thread remembers the IDs of the strings it already used, so the
+ *   trace lock is needed only when the thread uses a string for the first time.
+ *
+ * @param data Private data of a thread.
+ * @param str A string.
+ * @return The ID of the string.
+ */
+inline
+UINT32 getStringId(ThreadData* data, const std::string& str)
+{
+  // Helper variables
+  StringTable::const_iterator it = data->strings.find(str);
+
+  if (it != data->strings.end()) return it->second;
+
+  // Helper variables
+  UINT32 id;
+
+  { // The string is new for this thread, but other threads might know it
+    ScopedLock lock(g_traceLock);
+
+    std::pair< StringTable::iterator, bool > result = g_strings.insert(
+      StringTable::value_type(str, g_stringsById.size()));
+
+    // Keys are not moved by rehashing, so we can keep pointers to them
+    if (result.second) g_stringsById.push_back(&result.first->first);
+
+    id = result.first->second;
+  }
+
+  data->strings.insert(StringTable::value_type(str, id));
+
+  return id;
+}
+
+/**
+ * Gets an ID of a name of a function stored in the binary trace.
+ *
+ * @param data Private data of a thread.
+ * @param idx An index of the function.
+ * @return The ID of the name of the function.
+ */
+inline
+UINT32 getFunctionId(ThreadData* data, index_t idx)
+{
+  // Helper variables
+  FunctionTable::const_iterator it = data->functions.find(idx);
+
+  if (it != data->functions.end()) return it->second;
+
+  // Helper variables
+  UINT32 id = getStringId(data, THREAD_GetFunctionName(idx));
+
+  data->functions.insert(FunctionTable::value_type(idx, id));
+
+  return id;
+}
+
+/**
+ * Gets an ID of a string stored in the binary trace if the string differs from
+ *   the last string used in the same item of the records.
+ *
+ * @note Names and types of variables are filled in for each access, so they
+ *   cannot be identified by their addresses. Consecutive accesses often touch
+ *   the same variable (and the after callbacks always do), so comparing with
+ *   the last string is enough to avoid hashing the string most of the time.
+ *
+ * @param data Private data of a thread.
+ * @param str A string.
+ * @param last The last string used in the same item of the records.
+ * @return The ID of the string.
+ */
+inline
+UINT32 getStringId(ThreadData* data, const std::string& str, LastString& last)
+{
+  if (last.valid && last.str == str) return last.id;
+
+  last.valid = true;
+  last.str = str;
+  last.id = getStringId(data, str);
+
+  return last.id;
+}
+
+/**
+ * Gets an ID of a name of a file stored in the binary trace.
+ *
+ * @note The framework interns the names of files in source code locations, so
+ *   the names of files can be identified by their addresses.
+ *
+ * @param data Private data of a thread.
+ * @param file A name of the file (interned by the framework).
+ * @return The ID of the name of the file.
+ */
+inline
+UINT32 getFileId(ThreadData* data, const std::string& file)
+{
+  // Helper variables
+  FileTable::const_iterator it = data->files.find(&file);
+
+  if (it != data->files.end()) return it->second;
+
+  // Helper variables
+  UINT32 id = getStringId(data, file);
+
+  data->files.insert(FileTable::value_type(&file, id));
+
+  return id;
+}
+
+/**
+ * Creates a record representing an event.
+ *
+ * @param type A type of the event.
+ * @param tid A thread which generated the event.
+ * @return A record with the type, the thread and the time of the event set
+ *   and all other items cleared.
+ */
+inline
+EventRecord createRecord(EventType type, THREADID tid)
+{
+  // Helper variables
+  EventRecord record = EventRecord();
+
+  record.type = type;
+  record.tid = tid;
+  record.time = getMonotonicTime();
+
+  return record;
+}
+
+/**
+ * Stores a record representing an event to the binary trace.
+ *
+ * @note The records are locked as the plugin might be writing them to the
+ *   trace when it finishes while the thread is still running.
+ *
+ * @param data Private data of a thread which generated the event.
+ * @param record A record representing the event.
+ */
+inline
+VOID storeRecord(ThreadData* data, const EventRecord& record)
+{
+  data->lock();
+
+  if (data->records.size() == TRACE_BUFFER_SIZE)
+  { // The buffer is full, write the records to the trace
+    ScopedLock lock(g_traceLock);
+
+    writeRecords(data);
+  }
+
+  data->records.push_back(record);
+
+  data->unlock();
+}
+
+/**
+ * Stores information about an access to a memory to the binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_BEFORE_READ, @c ET_AFTER_READ, etc.).
+ *
+ * @param tid A thread which performed the access.
+ * @param addr An address accessed.
+ * @param size A size in bytes of the data accessed.
+ * @param variable A structure containing information about a variable stored
+ *   at the address accessed.
+ * @param location A structure containing information about a location of the
+ *   instruction which performed the access.
+ */
+template< EventType ET >
+VOID traceMemoryAccess(THREADID tid, ADDRINT addr, UINT32 size,
+  const VARIABLE& variable, const LOCATION& location)
+{
+  // Helper variables
+  ThreadData* data = TLS;
+  EventRecord record = createRecord(ET, tid);
+
+  record.addr = addr;
+  record.size = size;
+  record.name = getStringId(data, variable.name, data->name);
+  record.vtype = getStringId(data, variable.type, data->vtype);
+  record.offset = variable.offset;
+  record.file = getFileId(data, location.file);
+  record.line = location.line;
+
+  storeRecord(data, record);
+}
+
+/**
+ * Stores information about an operation with a lock to the binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_BEFORE_LOCK_ACQUIRE, etc.).
+ *
+ * @param tid A thread which performed the operation.
+ * @param lock An object representing the lock.
+ */
+template< EventType ET >
+VOID traceLockOperation(THREADID tid, LOCK lock)
+{
+  // Helper variables
+  EventRecord record = createRecord(ET, tid);
+
+  record.addr = lock.q();
+
+  storeRecord(TLS, record);
+}
+
+/**
+ * Stores information about an operation with a condition to the binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_BEFORE_SIGNAL, etc.).
+ *
+ * @param tid A thread which performed the operation.
+ * @param cond An object representing the condition.
+ */
+template< EventType ET >
+VOID traceCondOperation(THREADID tid, COND cond)
+{
+  // Helper variables
+  EventRecord record = createRecord(ET, tid);
+
+  record.addr = cond.q();
+
+  storeRecord(TLS, record);
+}
+
+/**
+ * Stores information about the threads joining together to the binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_BEFORE_JOIN or @c ET_AFTER_JOIN).
+ *
+ * @param tid A number identifying the thread which joins with another thread.
+ * @param jtid A number identifying the thread which is joined with the first
+ *   thread.
+ */
+template< EventType ET >
+VOID traceJoin(THREADID tid, THREADID jtid)
+{
+  // Helper variables
+  EventRecord record = createRecord(ET, tid);
+
+  record.addr = jtid;
+
+  storeRecord(TLS, record);
+}
+
+/**
+ * Stores information about a thread which started or finished to the binary
+ *   trace.
+ *
+ * @tparam ET A type of the event (@c ET_THREAD_STARTED or @c
+ *   ET_THREAD_FINISHED).
+ *
+ * @param tid A number identifying the thread.
+ */
+template< EventType ET >
+VOID traceThread(THREADID tid)
+{
+  storeRecord(TLS, createRecord(ET, tid));
+}
+
+/**
+ * Stores information about a function entered or exited by a thread to the
+ *   binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_FUNCTION_ENTERED or @c
+ *   ET_FUNCTION_EXITED).
+ *
+ * @param tid A number identifying the thread.
+ */
+template< EventType ET >
+VOID traceFunction(THREADID tid)
+{
+  // Helper variables
+  ThreadData* data = TLS;
+  EventRecord record = createRecord(ET, tid);
+
+  // Use the index of the function, so we do not need to copy its name
+  record.name = getFunctionId(data, THREAD_GetCurrentFunctionIndex(tid));
+
+  storeRecord(data, record);
+}
+
+/**
+ * Stores information about an exception thrown or caught by a thread to the
+ *   binary trace.
+ *
+ * @tparam ET A type of the event (@c ET_EXCEPTION_THROWN or @c
+ *   ET_EXCEPTION_CAUGHT).
+ *
+ * @param tid A number identifying the thread.
+ * @param exception An object representing the exception.
+ */
+template< EventType ET >
+VOID traceException(THREADID tid, const EXCEPTION& exception)
+{
+  // Helper variables
+  ThreadData* data = TLS;
+  EventRecord record = createRecord(ET, tid);
+
+  record.name = getStringId(data, exception.name);
+
+  storeRecord(data, record);
+}
+
+/**
+ * Initialises thread local storage (TLS) used when writing the binary trace.
+ *
+ * @param tid A number identifying the thread owning the TLS.
+ */
+VOID initThreadData(THREADID tid)
+{
+  // Helper variables
+  ThreadData* data = new ThreadData(tid);
+
+  g_tls.set(tid, data);
+
+  // Remember the data, so we can write records of running threads at the end
+  ScopedLock lock(g_threadsLock);
+
+  g_threads[tid] = data;
+}
+
+/**
+ * Opens the binary trace.
+ *
+ * @param path A path to the file to which the trace should be written.
+ * @return @em True if the trace was opened, @em false otherwise.
+ */
+bool openTrace(const std::string& path)
+{
+  g_trace.open(path.c_str(), std::ios::out | std::ios::trunc
+    | std::ios::binary);
+
+  if (!g_trace.is_open()) return false;
+
+  // Helper variables
+  EventTraceHeader header = EventTraceHeader();
+
+  memcpy(header.magic, EVENT_TRACE_MAGIC, sizeof(header.magic));
+  header.version = EVENT_TRACE_VERSION;
+
+  g_trace.write(reinterpret_cast< const char* >(&header), sizeof(header));
+
+  return true;
+}
+
+/**
+ * Writes the records not written yet, the strings and the footer to the binary
+ *   trace and closes it.
+ */
+VOID closeTrace()
+{
+  { // Some threads might still be running, write their records too
+    ScopedLock lock(g_threadsLock);
+
+    for (THREADID tid = 0; tid < PIN_MAX_THREADS; tid++)
+    { // Wait until the thread stores its current record before writing them
+      if (g_threads[tid] == NULL) continue;
+
+      g_threads[tid]->lock();
+
+      { // The lock order is the same as when the thread writes the records
+        ScopedLock traceLock(g_traceLock);
+
+        writeRecords(g_threads[tid]);
+      }
+
+      g_threads[tid]->unlock();
+    }
+  }
+
+  ScopedLock lock(g_traceLock);
+
+  // Helper variables
+  EventTraceFooter footer = EventTraceFooter();
+
+  for (const std::string* str : g_stringsById)
+  { // Write the strings ordered by their IDs, including the terminating NULs
+    g_trace.write(str->c_str(), str->size() + 1);
+
+    footer.size += str->size() + 1;
+  }
+
+  footer.records = g_records;
+  footer.strings = g_stringsById.size();
+
+  memcpy(footer.magic, EVENT_TRACE_MAGIC, sizeof(footer.magic));
+
+  g_trace.write(reinterpret_cast< const char* >(&footer), sizeof(footer));
+
+  g_trace.close();
 }
 
 /**
@@ -400,71 +927,121 @@ PLUGIN_INIT_FUNCTION()
     FLAG("monitor.function.exits", true)
     FLAG("monitor.exception.throws", true)
     FLAG("monitor.exception.catches", true)
+    OPTION("trace.format", std::string, "text")
+    OPTION("trace.file", std::string, "events.trace")
     ;
 
   // Load plugin's settings, continue on error
   LOAD_SETTINGS(settings, "event-printer.conf");
 
+  if (settings.get< std::string >("trace.format") == "binary")
+  { // Write the events to a binary trace instead of printing them
+    PIN_MutexInit(&g_traceLock);
+    PIN_MutexInit(&g_threadsLock);
+
+    g_binary = openTrace(settings.get< std::string >("trace.file"));
+
+    if (!g_binary)
+    { // Printing the events is better than nothing
+      CONSOLE_NOPREFIX("warning: could not open file "
+        + settings.get< std::string >("trace.file")
+        + ", printing the events instead\n");
+    }
+  }
+
   // Helper macros
   #define ENABLED(flag) settings.enabled(flag)
+  #define PRINTER(text, binary) (g_binary ? binary : text)
+
+  // Threads need their private data before they generate any events
+  if (g_binary) THREAD_ThreadStarted(initThreadData);
 
   // Register callback functions called before access events
   if (ENABLED("monitor.access.reads"))
-    ACCESS_BeforeMemoryRead(beforeMemoryRead);
+    ACCESS_BeforeMemoryRead(PRINTER(beforeMemoryRead,
+      traceMemoryAccess< ET_BEFORE_READ >));
   if (ENABLED("monitor.access.writes"))
-    ACCESS_BeforeMemoryWrite(beforeMemoryWrite);
+    ACCESS_BeforeMemoryWrite(PRINTER(beforeMemoryWrite,
+      traceMemoryAccess< ET_BEFORE_WRITE >));
   if (ENABLED("monitor.access.updates"))
-    ACCESS_BeforeAtomicUpdate(beforeAtomicUpdate);
+    ACCESS_BeforeAtomicUpdate(PRINTER(beforeAtomicUpdate,
+      traceMemoryAccess< ET_BEFORE_UPDATE >));
 
   // Register callback functions called after access events
   if (ENABLED("monitor.access.reads"))
-    ACCESS_AfterMemoryRead(afterMemoryRead);
+    ACCESS_AfterMemoryRead(PRINTER(afterMemoryRead,
+      traceMemoryAccess< ET_AFTER_READ >));
   if (ENABLED("monitor.access.writes"))
-    ACCESS_AfterMemoryWrite(afterMemoryWrite);
+    ACCESS_AfterMemoryWrite(PRINTER(afterMemoryWrite,
+      traceMemoryAccess< ET_AFTER_WRITE >));
   if (ENABLED("monitor.access.updates"))
-    ACCESS_AfterAtomicUpdate(afterAtomicUpdate);
+    ACCESS_AfterAtomicUpdate(PRINTER(afterAtomicUpdate,
+      traceMemoryAccess< ET_AFTER_UPDATE >));
 
   // Register callback functions called before synchronisation events
   if (ENABLED("monitor.sync.acquires"))
-    SYNC_BeforeLockAcquire(beforeLockAcquire);
+    SYNC_BeforeLockAcquire(PRINTER(beforeLockAcquire,
+      traceLockOperation< ET_BEFORE_LOCK_ACQUIRE >));
   if (ENABLED("monitor.sync.releases"))
-    SYNC_BeforeLockRelease(beforeLockRelease);
+    SYNC_BeforeLockRelease(PRINTER(beforeLockRelease,
+      traceLockOperation< ET_BEFORE_LOCK_RELEASE >));
   if (ENABLED("monitor.sync.signals"))
-    SYNC_BeforeSignal(beforeSignal);
+    SYNC_BeforeSignal(PRINTER(beforeSignal,
+      traceCondOperation< ET_BEFORE_SIGNAL >));
   if (ENABLED("monitor.sync.waits"))
-    SYNC_BeforeWait(beforeWait);
+    SYNC_BeforeWait(PRINTER(beforeWait,
+      traceCondOperation< ET_BEFORE_WAIT >));
   if (ENABLED("monitor.sync.joins"))
-    SYNC_BeforeJoin(beforeJoin);
+    SYNC_BeforeJoin(PRINTER(beforeJoin, traceJoin< ET_BEFORE_JOIN >));
 
   // Register callback functions called after synchronisation events
   if (ENABLED("monitor.sync.acquires"))
-    SYNC_AfterLockAcquire(afterLockAcquire);
+    SYNC_AfterLockAcquire(PRINTER(afterLockAcquire,
+      traceLockOperation< ET_AFTER_LOCK_ACQUIRE >));
   if (ENABLED("monitor.sync.releases"))
-    SYNC_AfterLockRelease(afterLockRelease);
+    SYNC_AfterLockRelease(PRINTER(afterLockRelease,
+      traceLockOperation< ET_AFTER_LOCK_RELEASE >));
   if (ENABLED("monitor.sync.signals"))
-    SYNC_AfterSignal(afterSignal);
+    SYNC_AfterSignal(PRINTER(afterSignal,
+      traceCondOperation< ET_AFTER_SIGNAL >));
   if (ENABLED("monitor.sync.waits"))
-    SYNC_AfterWait(afterWait);
+    SYNC_AfterWait(PRINTER(afterWait,
+      traceCondOperation< ET_AFTER_WAIT >));
   if (ENABLED("monitor.sync.joins"))
-    SYNC_AfterJoin(afterJoin);
+    SYNC_AfterJoin(PRINTER(afterJoin, traceJoin< ET_AFTER_JOIN >));
 
   // Register callback functions called when a thread starts or finishes
   if (ENABLED("monitor.thread.starts"))
-    THREAD_ThreadStarted(threadStarted);
+    THREAD_ThreadStarted(PRINTER(threadStarted,
+      traceThread< ET_THREAD_STARTED >));
   if (ENABLED("monitor.thread.ends"))
-    THREAD_ThreadFinished(threadFinished);
+    THREAD_ThreadFinished(PRINTER(threadFinished,
+      traceThread< ET_THREAD_FINISHED >));
 
   // Register callback functions called when a function is executed
   if (ENABLED("monitor.function.enters"))
-    THREAD_FunctionEntered(functionEntered);
+    THREAD_FunctionEntered(PRINTER(functionEntered,
+      traceFunction< ET_FUNCTION_ENTERED >));
   if (ENABLED("monitor.function.exits"))
-    THREAD_FunctionExited(functionExited);
+    THREAD_FunctionExited(PRINTER(functionExited,
+      traceFunction< ET_FUNCTION_EXITED >));
 
   // Register callback functions called when an exception is thrown or caught
   if (ENABLED("monitor.exception.throws"))
-    EXCEPTION_ExceptionThrown(exceptionThrown);
+    EXCEPTION_ExceptionThrown(PRINTER(exceptionThrown,
+      traceException< ET_EXCEPTION_THROWN >));
   if (ENABLED("monitor.exception.catches"))
-    EXCEPTION_ExceptionCaught(exceptionCaught);
+    EXCEPTION_ExceptionCaught(PRINTER(exceptionCaught,
+      traceException< ET_EXCEPTION_CAUGHT >));
+}
+
+/**
+ * Finishes the event printer plugin.
+ */
+PLUGIN_FINISH_FUNCTION()
+{
+  // The binary trace is complete only after its footer is written
+  if (g_binary) closeTrace();
 }
 
 /** End of file event-printer.cpp **/
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Contains definitions of the binary format of event traces.
+ *
+ * A file containing definitions of the binary format of event traces written
+ *   by the event printer plugin. The traces are written in the native byte
+ *   order of the machine which produced them.
+ *
+ * @note This file does not depend on PIN, so tools processing the traces may
+ *   include it too.
+ *
+ * @file      trace.h
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#ifndef __TRACE_H__
+  #define __TRACE_H__
+
+#include <stdint.h>
+
+// A magic number identifying event traces (including the trailing NUL)
+#define EVENT_TRACE_MAGIC "ANCEVTR"
+
+// A version of the format of event traces
+#define EVENT_TRACE_VERSION 1
+
+/**
+ * @brief An enumeration of types of events stored in event traces.
+ */
+typedef enum EventType_e
+{
+  ET_BEFORE_READ,          //!< Before a thread reads from a memory.
+  ET_AFTER_READ,           //!< After a thread reads from a memory.
+  ET_BEFORE_WRITE,         //!< Before a thread writes to a memory.
+  ET_AFTER_WRITE,          //!< After a thread writes to a memory.
+  ET_BEFORE_UPDATE,        //!< Before a thread atomically updates a memory.
+  ET_AFTER_UPDATE,         //!< After a thread atomically updates a memory.
+  ET_BEFORE_LOCK_ACQUIRE,  //!< Before a thread acquires a lock.
+  ET_BEFORE_LOCK_RELEASE,  //!< Before a thread releases a lock.
+  ET_BEFORE_SIGNAL,        //!< Before a thread signals a condition.
+  ET_BEFORE_WAIT,          //!< Before a thread waits on a condition.
+  ET_BEFORE_JOIN,          //!< Before a thread joins with another thread.
+  ET_AFTER_LOCK_ACQUIRE,   //!< After a thread acquires a lock.
+  ET_AFTER_LOCK_RELEASE,   //!< After a thread releases a lock.
+  ET_AFTER_SIGNAL,         //!< After a thread signals a condition.
+  ET_AFTER_WAIT,           //!< After a thread waits on a condition.
+  ET_AFTER_JOIN,           //!< After a thread joins with another thread.
+  ET_THREAD_STARTED,       //!< A thread started.
+  ET_THREAD_FINISHED,      //!< A thread finished.
+  ET_FUNCTION_ENTERED,     //!< A thread entered a function.
+  ET_FUNCTION_EXITED,      //!< A thread exited a function.
+  ET_EXCEPTION_THROWN,     //!< A thread has thrown an exception.
+  ET_EXCEPTION_CAUGHT,     //!< A thread has caught an exception.
+  ET_COUNT                 //!< A number of types of events.
+} EventType;
+
+/**
+ * @brief A structure representing a header of an event trace.
+ *
+ * The header is followed by the records (see EventRecord), the strings (see
+ *   EventTraceFooter) and the footer. The number of records is known only
+ *   when the trace is complete, so it is stored in the footer.
+ */
+typedef struct EventTraceHeader_s
+{
+  char magic[8]; //!< A magic number (@c EVENT_TRACE_MAGIC).
+  uint32_t version; //!< A version of the format.
+  uint32_t reserved; //!< Reserved (keeps the records aligned).
+} EventTraceHeader;
+
+/**
+ * @brief A structure representing an event.
+ *
+ * The meaning of the items depends on the type of the event. Names, types and
+ *   files are stored as IDs of strings (see EventTraceFooter).
+ */
+typedef struct EventRecord_s
+{
+  uint32_t type; //!< A type of the event (an item of EventType).
+  uint32_t tid; //!< A thread which generated the event.
+  uint64_t time; //!< A time (in nanoseconds) at which the event occurred.
+  /**
+   * @brief An accessed address, an index of a lock or a condition or a thread
+   *   with which the thread joined.
+   */
+  uint64_t addr;
+  uint32_t size; //!< A number of bytes accessed.
+  /**
+   * @brief An ID of a name of a variable, a function or an exception.
+   */
+  uint32_t name;
+  uint32_t vtype; //!< An ID of a type of a variable.
+  uint32_t offset; //!< An offset within a variable which was accessed.
+  uint32_t file; //!< An ID of a file containing the accessing instruction.
+  int32_t line; //!< A line containing the accessing instruction.
+} EventRecord;
+
+/**
+ * @brief A structure representing a footer of an event trace.
+ *
+ * The footer is preceded by @c strings NUL-terminated strings occupying @c
+ *   size bytes. The n-th string is the string with ID n.
+ */
+typedef struct EventTraceFooter_s
+{
+  uint64_t records; //!< A number of records.
+  uint64_t size; //!< A size of the strings in bytes.
+  uint32_t strings; //!< A number of strings.
+  uint32_t reserved; //!< Reserved (keeps the magic number aligned).
+  char magic[8]; //!< A magic number (@c EVENT_TRACE_MAGIC).
+} EventTraceFooter;
+
+#endif /* __TRACE_H__ */
+
+/** End of file trace.h **/
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief A program printing binary event traces in a text form.
+ *
+ * A program printing binary event traces written by the event printer plugin
+ *   in the same text form in which the plugin prints the events.
+ *
+ * @file      decode.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/trace.h"
+
+/**
+ * @brief A class representing a binary event trace loaded into the memory.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+class EventTrace
+{
+  private: // Internal data
+    std::vector< EventRecord > m_records; //!< Records representing events.
+    std::vector< std::string > m_strings; //!< Strings (indexed by their IDs).
+  public: // Methods for loading the trace
+    /**
+     * Loads a binary event trace from a file.
+     *
+     * @param path A path to the file.
+     * @return An empty string if the trace was loaded successfully or a
+     *   description of the problem which prevented the trace from loading.
+     */
+    std::string load(const char* path)
+    {
+      // Helper variables
+      std::ifstream f(path, std::ifstream::in | std::ifstream::binary);
+      EventTraceHeader header;
+      EventTraceFooter footer;
+
+      if (!f) return "cannot open the file";
+
+      if (!f.read(reinterpret_cast< char* >(&header), sizeof(header))
+        || memcmp(header.magic, EVENT_TRACE_MAGIC, sizeof(header.magic)) != 0)
+        return "not an event trace";
+
+      if (header.version != EVENT_TRACE_VERSION)
+        return "unsupported version";
+
+      // The footer is written when the trace is complete, get its position
+      f.seekg(0, std::ifstream::end);
+
+      // Helper variables
+      uint64_t size = f.tellg();
+
+      if (size < sizeof(header) + sizeof(footer)
+        || !f.seekg(size - sizeof(footer))
+        || !f.read(reinterpret_cast< char* >(&footer), sizeof(footer))
+        || memcmp(footer.magic, EVENT_TRACE_MAGIC, sizeof(footer.magic)) != 0)
+        return "incomplete trace (the program did not finish properly)";
+
+      // Check the sizes first, so the computations below cannot overflow
+      if (footer.records > size || footer.size > size
+        || sizeof(header) + footer.records * sizeof(EventRecord) + footer.size
+          + sizeof(footer) != size) return "corrupted trace";
+
+      m_records.resize(footer.records);
+
+      // Helper variables
+      std::string strings(footer.size, '\0');
+
+      f.seekg(sizeof(header));
+
+      if (!f.read(reinterpret_cast< char* >(m_records.data()),
+          m_records.size() * sizeof(EventRecord))
+        || !f.read(&strings[0], strings.size())) return "truncated trace";
+
+      for (size_t pos = 0; pos < strings.size(); )
+      { // The strings are NUL-terminated and ordered by their IDs
+        m_strings.push_back(strings.c_str() + pos);
+
+        pos += m_strings.back().size() + 1;
+      }
+
+      if (m_strings.size() != footer.strings) return "corrupted strings";
+
+      return "";
+    }
+
+    /**
+     * Sorts the events by the time at which they occurred.
+     *
+     * @note The threads write their events in batches, so events of different
+     *   threads are interleaved in the trace only at the batch boundaries.
+     */
+    void sort()
+    {
+      std::stable_sort(m_records.begin(), m_records.end(),
+        [] (const EventRecord& a, const EventRecord& b)
+        { return a.time < b.time; });
+    }
+  public: // Methods for printing the trace
+    /**
+     * Prints all events in the trace.
+     *
+     * @param s A stream to which the events should be printed.
+     * @return @em True if all events were printed, @em false if some of them
+     *   are corrupted.
+     */
+    bool print(std::ostream& s)
+    {
+      for (const EventRecord& record : m_records)
+      { // Print the events in the same form as the plugin would print them
+        if (!print(s, record)) return false;
+      }
+
+      return true;
+    }
+  private: // Internal helper methods
+    /**
+     * Gets a string stored in the trace.
+     *
+     * @param id An ID of the string.
+     * @return The string or an empty string if the trace does not contain any
+     *   string with the specified ID.
+     */
+    const std::string& str(uint32_t id)
+    {
+      // Helper variables
+      static const std::string empty;
+
+      return (id < m_strings.size()) ? m_strings[id] : empty;
+    }
+
+    /**
+     * Gets a declaration of an accessed variable.
+     *
+     * @param record A record representing an access to a memory.
+     * @return A string containing the declaration of the variable.
+     */
+    std::string getVariableDeclaration(const EventRecord& record)
+    {
+      // Helper variables
+      std::ostringstream decl;
+
+      // Format the name, type and offset to a 'type name[+offset]' string
+      if (!str(record.vtype).empty()) decl << str(record.vtype) << " ";
+      decl << (str(record.name).empty() ? "<unknown>" : str(record.name));
+      if (record.offset != 0) decl << "+" << record.offset;
+
+      return decl.str();
+    }
+
+    /**
+     * Prints an event.
+     *
+     * @param s A stream to which the event should be printed.
+     * @param r A record representing the event.
+     * @return @em True if the event was printed, @em false if the record is
+     *   corrupted.
+     */
+    bool print(std::ostream& s, const EventRecord& r)
+    {
+      // Helper variables
+      static const char* access[] = { "read", "written", "updated" };
+      static const char* preposition[] = { "from", "to", "at" };
+
+      switch (r.type)
+      { // Print the event in the same form as the plugin would print it
+        case ET_BEFORE_READ:
+        case ET_AFTER_READ:
+        case ET_BEFORE_WRITE:
+        case ET_AFTER_WRITE:
+        case ET_BEFORE_UPDATE:
+        case ET_AFTER_UPDATE:
+          s << ((r.type % 2 == 0) ? "Before" : "After") << " thread " << r.tid
+            << " " << access[r.type / 2] << " " << r.size << " "
+            << ((r.size == 1) ? "byte" : "bytes") << " "
+            << preposition[r.type / 2] << " memory address 0x" << std::hex
+            << r.addr << std::dec << "\n  variable "
+            << getVariableDeclaration(r) << "\n  accessed at line " << r.line
+            << " in file "
+            << (str(r.file).empty() ? "<unknown>" : str(r.file)) << "\n";
+          break;
+        case ET_BEFORE_LOCK_ACQUIRE:
+          s << "Before lock acquired: thread " << r.tid << ", lock LOCK(index="
+            << r.addr << ")\n";
+          break;
+        case ET_BEFORE_LOCK_RELEASE:
+          s << "Before lock released: thread " << r.tid << ", lock LOCK(index="
+            << r.addr << ")\n";
+          break;
+        case ET_BEFORE_SIGNAL:
+          s << "Before signal send: thread " << r.tid
+            << ", condition COND(index=" << r.addr << ")\n";
+          break;
+        case ET_BEFORE_WAIT:
+          s << "Before wait: thread " << r.tid << ", condition COND(index="
+            << r.addr << ")\n";
+          break;
+        case ET_BEFORE_JOIN:
+          s << "Before thread " << r.tid << " joined with thread " << r.addr
+            << "\n";
+          break;
+        case ET_AFTER_LOCK_ACQUIRE:
+          s << "After lock acquired: thread " << r.tid << ", lock LOCK(index="
+            << r.addr << ")\n";
+          break;
+        case ET_AFTER_LOCK_RELEASE:
+          s << "After lock released: thread " << r.tid << ", lock LOCK(index="
+            << r.addr << ")\n";
+          break;
+        case ET_AFTER_SIGNAL:
+          s << "After signal send: thread " << r.tid
+            << ", condition COND(index=" << r.addr << ")\n";
+          break;
+        case ET_AFTER_WAIT:
+          s << "After wait: thread " << r.tid << ", condition COND(index="
+            << r.addr << ")\n";
+          break;
+        case ET_AFTER_JOIN:
+          s << "After thread " << r.tid << " joined with thread " << r.addr
+            << "\n";
+          break;
+        case ET_THREAD_STARTED:
+          s << "Thread " << r.tid << " started.\n";
+          break;
+        case ET_THREAD_FINISHED:
+          s << "Thread " << r.tid << " finished.\n";
+          break;
+        case ET_FUNCTION_ENTERED:
+          s << "Thread " << r.tid << " started executing a function "
+            << str(r.name) << "\n";
+          break;
+        case ET_FUNCTION_EXITED:
+          s << "Thread " << r.tid << " finished executing a function "
+            << str(r.name) << "\n";
+          break;
+        case ET_EXCEPTION_THROWN:
+          s << "Thread " << r.tid << " has thrown exception " << str(r.name)
+            << ".\n";
+          break;
+        case ET_EXCEPTION_CAUGHT:
+          s << "Thread " << r.tid << " has caught exception " << str(r.name)
+            << ".\n";
+          break;
+        default: // Unknown type of event, the trace is corrupted
+          return false;
+      }
+
+      return true;
+    }
+};
+
+/**
+ * Prints binary event traces in a text form.
+ *
+ * @param argc A number of arguments passed to the program.
+ * @param argv A list of arguments passed to the program.
+ * @return @em 0 if all traces were printed successfully, @em 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+  // Helper variables
+  bool sort = true;
+  int first = 1;
+  int result = 0;
+
+  if (argc > 1 && strcmp(argv[1], "--unsorted") == 0)
+  { // Print the events in the order in which they are stored in the trace
+    sort = false;
+    first = 2;
+  }
+
+  if (first >= argc)
+  { // At least one trace must be specified
+    std::cerr << "usage: " << argv[0] << " [--unsorted] <trace>...\n";
+    return 1;
+  }
+
+  for (int i = first; i < argc; i++)
+  { // Print all of the traces given, one after another
+    EventTrace trace;
+
+    // Helper variables
+    std::string error = trace.load(argv[i]);
+
+    if (!error.empty())
+    { // Skip traces which cannot be loaded
+      std::cerr << argv[i] << ": " << error << "\n";
+      result = 1;
+      continue;
+    }
+
+    if (sort) trace.sort();
+
+    if (!trace.print(std::cout))
+    { // Some of the events are corrupted, the rest of them would be too
+      std::cerr << argv[i] << ": invalid event\n";
+      result = 1;
+    }
+  }
+
+  return result;
+}
+
+/** End of file decode.cpp **/
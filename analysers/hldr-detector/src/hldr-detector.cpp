@@ -26,8 +26,8 @@
  * @file      hldr-detector.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-11-21
- * @date      Last Update 2019-02-05
- * @version   0.9.9
+ * @date      Last Update 2026-10-16
+ * @version   0.9.11
  */
 
 #include "anaconda/anaconda.h"
@@ -81,8 +81,8 @@ typedef struct View_s
    */
   std::atomic< int > refs;
   timestamp_t timestamp; //!< A timestamp of the time the view was completed.
-  Backtrace startbt; //!< A backtrace at the start of an atomic region.
-  Backtrace endbt; //!< A backtrace at the end of an atomic region.
+  BacktraceId startbt; //!< A backtrace at the start of an atomic region.
+  BacktraceId endbt; //!< A backtrace at the end of an atomic region.
   std::atomic< int > depth; //!< A number of nested atomic regions encountered.
 } View;
 
@@ -466,7 +466,6 @@ std::string locations(View::ContainerType addresses,
   std::map< ADDRINT, View::ContainerType > instructions)
 {
   // Helper variables
-  LOCATION location;
   std::string output;
 
   for (View::Iterator it = addresses.begin(); it != addresses.end(); it++)
@@ -476,7 +475,7 @@ std::string locations(View::ContainerType addresses,
     for (View::Iterator iit = instructions[*it].begin();
       iit != instructions[*it].end(); iit++)
     { // Get a source code location corresponding to the obtained instruction
-      ACCESS_GetLocation(*iit, location);
+      const LOCATION& location = ACCESS_GetLocation(*iit);
 
       // Append the location to the list of locations accessing the addresses
       output += "    " + location.file + ":" + decstr(location.line) + "\n";
@@ -669,7 +668,7 @@ VOID atomicRegionEntered(THREADID tid)
   { // Not entering a nested atomic region, need to create a new view
     TLS_SetThreadData(g_currentViewTlsKey, new View(), tid);
 
-    THREAD_GetBacktrace(tid, VIEW->startbt); // Save the current backtrace
+    VIEW->startbt = THREAD_GetBacktraceId(tid); // Save the current backtrace
   }
   else
   {
@@ -734,7 +733,7 @@ VOID atomicRegionExited(THREADID tid)
 
   VIEW->timestamp = g_clock++; // Save the time the view was completed
 
-  THREAD_GetBacktrace(tid, VIEW->endbt); // Save the current backtrace
+  VIEW->endbt = THREAD_GetBacktraceId(tid); // Save the current backtrace
 
   // First check the current (new) view against the views of other threads
   checkThisViewAgainstOtherHistories(tid, VIEW);
@@ -26,8 +26,8 @@
  * @file      statistics-collector.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2017-05-19
- * @date      Last Update 2019-02-06
- * @version   0.1.1
+ * @date      Last Update 2026-10-16
+ * @version   0.3.1
  */
 
 #include "anaconda/anaconda.h"
@@ -47,7 +47,7 @@ namespace
      */
     struct MemoryOperations_s
     {
-      std::map< std::string, UINT64 > all; //!< All memory operations.
+      std::map< index_t, UINT64 > all; //!< All memory operations.
       std::stack< UINT64 * > active; //!< Active memory operations.
     } memops;
 
@@ -57,55 +57,35 @@ namespace
     ThreadData_s() {}
   } ThreadData;
 
-  // A key for accessing private data of a thread in the Thread Local Storage
-  TLS_KEY g_tlsKey = TLS_CreateThreadDataKey(
-    [] (VOID* data) { delete static_cast< ThreadData* >(data); }
-  );
+  // A slot holding private data of a thread in the Thread Local Storage
+  TlsSlot< ThreadData > g_tls;
 }
 
 // A helper macro for accessing the Thread Local Storage (TLS) more easily
-#define TLS static_cast< ThreadData* >(TLS_GetThreadData(g_tlsKey, tid))
+#define TLS g_tls.get(tid)
 
 /**
  * Updates information about the number of memory operations performed.
  *
- * @param tid A thread which performed the read.
- * @param addr An address from which were the data read.
- * @param size A size in bytes of the data read.
- */
-VOID beforeMemoryRead(THREADID tid, ADDRINT addr, UINT32 size,
-  const VARIABLE& variable)
-{
-  // Update the number of memory operations performed in the current function
-  ++(*TLS->memops.active.top());
-}
-
-/**
- * Updates information about the number of memory operations performed.
+ * @note The framework delivers the memory accesses before a thread enters or
+ *   exits a function, so all accesses in a batch belong to the same function.
  *
- * @param tid A thread which performed the read.
- * @param addr An address from which were the data read.
- * @param size A size in bytes of the data read.
+ * @param tid A thread which performed the memory accesses.
+ * @param records An array of records describing the memory accesses.
+ * @param count A number of records in the array.
  */
-VOID beforeMemoryWrite(THREADID tid, ADDRINT addr, UINT32 size,
-  const VARIABLE& variable)
+VOID memoryAccessed(THREADID tid, const ACCESS_RECORD* records, UINT32 count)
 {
-  // Update the number of memory operations performed in the current function
-  ++(*TLS->memops.active.top());
-}
+  // Helper variables
+  UINT64 memops = 0;
+
+  for (UINT32 i = 0; i < count; ++i)
+  { // Atomic updates are both reads and writes, count them as two operations
+    memops += (records[i].type == ART_UPDATE) ? 2 : 1;
+  }
 
-/**
- * Updates information about the number of memory operations performed.
- *
- * @param tid A thread which performed the atomic update.
- * @param addr An address at which were the data atomically updated.
- * @param size A size in bytes of the data atomically updated.
- */
-VOID beforeAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
-  const VARIABLE& variable)
-{
   // Update the number of memory operations performed in the current function
-  (*TLS->memops.active.top()) += 2;
+  (*TLS->memops.active.top()) += memops;
 }
 
 /**
@@ -115,15 +95,10 @@ VOID beforeAtomicUpdate(THREADID tid, ADDRINT addr, UINT32 size,
  */
 VOID functionEntered(THREADID tid)
 {
-  // Helper variables
-  std::string function;
-
-  // Get the name of the function we are entering
-  THREAD_GetCurrentFunction(tid, function);
-
   // Find the counter holding the number of memory operations performed by the
   // function we are entering (if the counter does not exist, create a new one)
-  TLS->memops.active.push(&TLS->memops.all[function]);
+  TLS->memops.active.push(&TLS->memops.all[
+    THREAD_GetCurrentFunctionIndex(tid)]);
 }
 
 /**
@@ -145,10 +120,11 @@ VOID functionExited(THREADID tid)
 VOID threadStarted(THREADID tid)
 {
   // Initialise thread local storage
-  TLS_SetThreadData(g_tlsKey, new ThreadData(), tid);
+  g_tls.set(tid, new ThreadData());
 
   // Some memory operations at the beginning may not belong to any function
-  TLS->memops.active.push(&TLS->memops.all["<none>"]);
+  // (the index of an unknown function is used for them)
+  TLS->memops.active.push(&TLS->memops.all[0]);
 }
 
 /**
@@ -160,14 +136,15 @@ VOID threadStarted(THREADID tid)
 VOID threadFinished(THREADID tid)
 {
   // Helper variables
-  std::map< std::string, UINT64 >::iterator it;
+  std::map< index_t, UINT64 >::iterator it;
 
   CONSOLE("Statistics\n");
   CONSOLE("----------\n");
 
   for (it = TLS->memops.all.begin(); it != TLS->memops.all.end(); ++it)
   { // Print the number of memory operations performed by each function
-    CONSOLE(it->first + ": " + decstr(it->second) + "\n");
+    CONSOLE((THREAD_GetFunctionName(it->first).empty() ? "<none>"
+      : THREAD_GetFunctionName(it->first)) + ": " + decstr(it->second) + "\n");
   }
 }
 
@@ -176,9 +153,7 @@ VOID threadFinished(THREADID tid)
  */
 PLUGIN_INIT_FUNCTION()
 {
-  ACCESS_BeforeMemoryRead(beforeMemoryRead);
-  ACCESS_BeforeMemoryWrite(beforeMemoryWrite);
-  ACCESS_BeforeAtomicUpdate(beforeAtomicUpdate);
+  ACCESS_RegisterBatchConsumer(memoryAccessed);
 
   THREAD_FunctionEntered(functionEntered);
   THREAD_FunctionExited(functionExited);
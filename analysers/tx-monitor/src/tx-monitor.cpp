@@ -25,8 +25,8 @@
  * @file      tx-monitor.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-10-01
- * @date      Last Update 2019-02-06
- * @version   0.6.2
+ * @date      Last Update 2026-10-15
+ * @version   0.6.3
  */
 
 #define MONITOR_AVERAGE_TX_TIME 0
@@ -35,13 +35,14 @@
 
 #include "anaconda/anaconda.h"
 
-#if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
-  #include <boost/date_time/posix_time/posix_time.hpp>
+#if MONITOR_AVERAGE_TX_TIME == 1
+  #include <atomic>
 #endif
 
 #if INJECT_NOISE == 1
   #include <iostream>
   #include <fstream>
+  #include <sstream>
   #include <string>
 
   #include <boost/random/mersenne_twister.hpp>
@@ -51,6 +52,10 @@
 #include "atomic.hpp"
 
 #if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
+  #include "anaconda/utils/clock.hpp"
+#endif
+
+#if INJECT_NOISE == 1
   #include "anaconda/utils/scopedlock.hpp"
 #endif
 
@@ -59,25 +64,17 @@
 namespace boost { void throw_exception(std::exception const& e) { return; } }
 #endif
 
-#if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
-// Namespace aliases
-namespace pt = boost::posix_time;
-#endif
-
 namespace
 { // Static global variables (usable only within this module)
-#if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
-  PIN_MUTEX g_timeLock; //!< A lock guarding access to local time.
-#endif
-
 #if MONITOR_AVERAGE_TX_TIME == 1
-  VOID freeTimestamp(VOID* data) { delete static_cast< pt::ptime* >(data); };
+  VOID freeTimestamp(VOID* data) { delete static_cast< UINT64* >(data); };
 
   TLS_KEY g_timestampTlsKey = TLS_CreateThreadDataKey(freeTimestamp);
 
-  PIN_MUTEX g_txTimeLock; //!< A lock guarding access to total transaction time.
-
-  pt::time_duration g_txTimeTotal(0, 0, 0, 0);
+  /**
+   * @brief A total time (in nanoseconds) spent in committed transactions.
+   */
+  std::atomic< UINT64 > g_txTimeTotal(0);
 #endif
 
 #if INJECT_NOISE == 1
@@ -127,30 +124,13 @@ namespace
 
 #if MONITOR_AVERAGE_TX_TIME == 1
 // Helper macros
-#define TIMESTAMP *static_cast< pt::ptime* >(TLS_GetThreadData(g_timestampTlsKey, tid))
+#define TIMESTAMP *static_cast< UINT64* >(TLS_GetThreadData(g_timestampTlsKey, tid))
 #endif
 #if INJECT_NOISE == 1
 // Helper macros
 #define TX_TYPE *static_cast< UINT32* >(TLS_GetThreadData(g_txTypeTlsKey, tid))
 #endif
 
-#if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
-/**
- * Gets the current time.
- *
- * @return The current time.
- */
-inline
-pt::ptime getTime()
-{
-  // Boost implementation of local_time() might call functions from the C or C++
-  // libraries, but C and C++ libraries linked into pintools are not thread-safe
-  ScopedLock lock(g_timeLock);
-
-  return pt::microsec_clock::local_time(); // Now we can safely access the time
-}
-#endif
-
 #if INJECT_NOISE == 1
 /**
  * Generates a random frequency, i.e., an integer number from 0 to 999.
@@ -182,19 +162,19 @@ VOID injectNoise(THREADID tid, UINT32 frequency, UINT32 strength)
 {
   if (randomFrequency() < frequency)
   { // We are under the frequency threshold, insert the noise
-    pt::ptime end = getTime() + pt::microseconds(strength);
+    UINT64 end = getDeadline(strength * NSECS_PER_USEC);
 
 #if PRINT_INJECTED_NOISE == 1
-    pt::ptime now; // Helper variables
+    UINT64 now; // Helper variables
 
-    while ((now = getTime()) < end)
+    while ((now = getMonotonicTime()) < end)
 #else
-    while (getTime() < end)
+    while (getMonotonicTime() < end)
 #endif
     { // Strength determines how many loop iterations we should perform
 #if PRINT_INJECTED_NOISE == 1
       CONSOLE("Thread " + decstr(tid) + ": looping ("
-        + decstr((end - now).total_microseconds())
+        + decstr((end - now) / NSECS_PER_USEC)
         + " microseconds remaining).\n");
 #endif
 
@@ -208,7 +188,7 @@ VOID injectNoise(THREADID tid, UINT32 frequency, UINT32 strength)
 VOID threadStarted(THREADID tid)
 {
 #if MONITOR_AVERAGE_TX_TIME == 1
-  TLS_SetThreadData(g_timestampTlsKey, new pt::ptime(), tid);
+  TLS_SetThreadData(g_timestampTlsKey, new UINT64(0), tid);
 #endif
 #if INJECT_NOISE == 1
   TLS_SetThreadData(g_txTypeTlsKey, new UINT32, tid);
@@ -270,7 +250,7 @@ VOID afterTxStart(THREADID tid, ADDRINT* result)
   ATOMIC::OPS::Increment< INT64 >(&g_afterTxStartCnt, 1);
 
 #if MONITOR_AVERAGE_TX_TIME == 1
-  TIMESTAMP = getTime();
+  TIMESTAMP = getMonotonicTime();
 #endif
 //  CONSOLE("After thread " + decstr(tid) + " starts a transaction\n");
 }
@@ -312,11 +292,9 @@ VOID afterTxCommit(THREADID tid, ADDRINT* result)
     ATOMIC::OPS::Increment< INT64 >(&g_afterTxCommitCnt, 1);
 
 #if MONITOR_AVERAGE_TX_TIME == 1
-    pt::time_duration txTime = getTime() - TIMESTAMP;
-
-    ScopedLock lock(g_txTimeLock);
-
-    g_txTimeTotal += txTime;
+    // Transactions of different threads may be accumulated concurrently
+    g_txTimeTotal.fetch_add(getMonotonicTime() - TIMESTAMP,
+      std::memory_order_relaxed);
 #endif
 //    CONSOLE("Thread " + decstr(tid) + ": transaction executed in "
 //      + decstr(txtime.total_microseconds()) + " microseconds.\n");
@@ -391,23 +369,12 @@ PLUGIN_INIT_FUNCTION()
   TM_AfterTxRead(afterTxRead);
   TM_AfterTxWrite(afterTxWrite);
 
-#if MONITOR_AVERAGE_TX_TIME == 1 || INJECT_NOISE == 1
-  // A lock guarding access to local time
-  PIN_MutexInit(&g_timeLock);
-#endif
-
-#if MONITOR_AVERAGE_TX_TIME == 1
-  // A lock guarding access to total transaction time
-  PIN_MutexInit(&g_txTimeLock);
-#endif
-
 #if INJECT_NOISE == 1
   // Initialise a lock guarding access to the random number generator
   PIN_MutexInit(&g_rngLock);
 
   // Initialise the random number generator
-  g_rng.seed(static_cast< RngEngine::result_type >(
-    getTime().time_of_day().fractional_seconds()));
+  g_rng.seed(static_cast< RngEngine::result_type >(getMonotonicTime()));
 
   std::string line;
   std::ifstream nconfig("conf/noise.conf");
@@ -461,7 +428,7 @@ PLUGIN_FINISH_FUNCTION()
   CONSOLE_NOPREFIX("  Transactions aborted per-thread:" + aborts + "\n");
 #if MONITOR_AVERAGE_TX_TIME == 1
   CONSOLE_NOPREFIX("  Average transaction execution time: "
-    + decstr((g_txTimeTotal / g_afterTxCommitCnt).total_microseconds())
+    + decstr(g_txTimeTotal.load() / g_afterTxCommitCnt / NSECS_PER_USEC)
     + " microseconds.\n");
 #endif
 #if INJECT_NOISE == 1
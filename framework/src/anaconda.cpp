@@ -25,12 +25,16 @@
  * @file      anaconda.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-17
- * @date      Last Update 2020-04-14
- * @version   0.17
+ * @date      Last Update 2026-10-16
+ * @version   0.18.17
  */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 #ifdef TARGET_LINUX
   #include <unistd.h>
   #include <fcntl.h>
@@ -47,6 +51,7 @@
 #include "config.h"
 #include "index.h"
 #include "mapper.h"
+#include "output.h"
 #include "settings.h"
 #include "version.h"
 
@@ -78,12 +83,96 @@
     IARG_PTR, hi, \
     IARG_END)
 
+// Only variables and stack accesses need to be identified using the registers
+#define NEEDS_REGISTERS(ai) ((ai) & (AI_VARIABLE | AI_ON_STACK))
+
+/**
+ * @brief A structure describing how an instruction computes an address of the
+ *   memory it accesses.
+ *
+ * @note Two accesses in a basic block described by the same structure access
+ *   the same address if none of the registers used to compute the address is
+ *   modified between them.
+ */
+typedef struct MemoryOperand_s
+{
+  REG base; //!< A base register.
+  REG index; //!< An index register.
+  REG segment; //!< A segment register.
+  UINT32 scale; //!< A scale applied to the index register.
+  ADDRDELTA displacement; //!< A displacement (or absolute address).
+  UINT32 size; //!< A size in bytes of the memory accessed.
+  BOOL read; //!< A flag determining if the memory is read.
+  BOOL written; //!< A flag determining if the memory is written.
+
+  /**
+   * Checks if two memory operands access the same memory in the same way.
+   *
+   * @param mo A memory operand.
+   * @return @em True if the memory operands access the same memory in the same
+   *   way, @em false otherwise.
+   */
+  bool operator==(const MemoryOperand_s& mo) const
+  {
+    return base == mo.base && index == mo.index && segment == mo.segment
+      && scale == mo.scale && displacement == mo.displacement
+      && size == mo.size && read == mo.read && written == mo.written;
+  }
+
+  /**
+   * Checks if a memory operand uses a register to compute the address.
+   *
+   * @param reg A (full) register.
+   * @return @em True if the register is used to compute the address, @em false
+   *   otherwise.
+   */
+  bool uses(REG reg) const
+  {
+    return base == reg || index == reg || segment == reg;
+  }
+
+  /**
+   * Checks if two memory operands may access the same memory.
+   *
+   * @param mo A memory operand.
+   * @return @em True if the memory operands may access the same memory,
+   *   @em false if they certainly access different memory.
+   */
+  bool overlaps(const MemoryOperand_s& mo) const
+  {
+    if (base != mo.base || index != mo.index || segment != mo.segment
+      || scale != mo.scale) return true; // Address cannot be compared
+
+    // Same registers used, the displacements determine the memory accessed
+    return displacement < mo.displacement + (ADDRDELTA)mo.size
+      && mo.displacement < displacement + (ADDRDELTA)size;
+  }
+} MemoryOperand;
+
+/**
+ * @brief An enumeration describing what is known about a memory accessed.
+ */
+typedef enum MemoryState_e
+{
+  MS_UNKNOWN,  //!< Nothing is known about the memory at instrumentation time.
+  MS_READONLY, //!< The memory is read-only.
+  MS_WRITABLE  //!< The memory is writable.
+} MemoryState;
+
 // Type definitions
 typedef VOID (*INSERTCALLFUNPTR)(INS ins, IPOINT ipoint, AFUNPTR funptr, ...);
+typedef std::vector< MemoryOperand > MemoryOperandList;
 
 namespace
 { // Static global variables (usable only within this module)
-  PredecessorsMonitor< FileWriter >* g_predsMon;
+  PredecessorsMonitor< BinaryFileWriter >* g_predsMon;
+
+  // Routines whose accesses are instrumented per basic block (in trace mode)
+  std::set< ADDRINT > g_monitoredRoutines;
+  // Memory access instrumentation settings used in trace mode
+  MemoryAccessSettings* g_traceMas = NULL;
+  // A flag determining if read-only memory of the images is remembered
+  bool g_readOnlyMemory = false;
 
 #ifdef TARGET_LINUX
   int g_origStdout;
@@ -182,14 +271,183 @@ VOID instrumentCallStackOperation(INS ins, VOID* data)
   }
 }
 
+/**
+ * Checks if a memory operand of an instruction accesses the stack.
+ *
+ * @note A memory operand is considered to access the stack if its address is
+ *   computed from the stack pointer or base pointer. Code compiled without the
+ *   frame pointer may use the base pointer as a general purpose register, so
+ *   this check is only used when the user explicitly allows it.
+ *
+ * @param ins An instruction.
+ * @param memOpIdx An index of the memory operand of the instruction.
+ * @return @em True if the memory operand accesses the stack, @em false
+ *   otherwise.
+ */
+inline
+BOOL isStackAccess(INS ins, UINT32 memOpIdx)
+{
+  REG base = REG_FullRegName(INS_OperandMemoryBaseReg(ins,
+    INS_MemoryOperandIndexToOperandIndex(ins, memOpIdx)));
+
+  return base == REG_STACK_PTR || base == REG_GBP;
+}
+
+/**
+ * Gets an address accessed by a memory operand of an instruction if it can be
+ *   computed at instrumentation time, i.e., if it is an absolute address or an
+ *   address relative to the instruction pointer.
+ *
+ * @param ins An instruction.
+ * @param memOpIdx An index of the memory operand of the instruction.
+ * @param addr A reference to a variable to which will be stored the address.
+ * @return @em True if the address can be computed at instrumentation time,
+ *   @em false otherwise.
+ */
+inline
+BOOL getStaticAddress(INS ins, UINT32 memOpIdx, ADDRINT& addr)
+{
+  // Memory operands are indexed differently than the other operands
+  UINT32 opIdx = INS_MemoryOperandIndexToOperandIndex(ins, memOpIdx);
+
+  // Helper variables
+  REG base = INS_OperandMemoryBaseReg(ins, opIdx);
+
+  addr = INS_OperandMemoryDisplacement(ins, opIdx);
+
+  if (REG_valid(INS_OperandMemoryIndexReg(ins, opIdx))
+    || REG_valid(INS_OperandMemorySegmentReg(ins, opIdx)))
+  { // Address computed from registers (segments are used for TLS accesses)
+    return false;
+  }
+
+  if (REG_FullRegName(base) == REG_INST_PTR)
+  { // Address relative to the instruction following the current instruction
+    addr += INS_NextAddress(ins);
+  }
+  else if (REG_valid(base))
+  { // Address computed from a register
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Checks if a memory operand of an instruction accesses a read-only memory.
+ *
+ * @note Only addresses which can be computed at instrumentation time, i.e.,
+ *   absolute addresses or addresses relative to the instruction pointer, are
+ *   checked. The check for other addresses must be done at runtime.
+ *
+ * @param ins An instruction.
+ * @param memOpIdx An index of the memory operand of the instruction.
+ * @return @c MS_READONLY if the memory operand accesses a read-only memory,
+ *   @c MS_WRITABLE if it accesses a writable memory or @c MS_UNKNOWN if the
+ *   accessed address cannot be determined at instrumentation time.
+ */
+inline
+MemoryState isReadOnlyMemoryAccess(INS ins, UINT32 memOpIdx)
+{
+  // Helper variables
+  ADDRINT addr;
+
+  if (!getStaticAddress(ins, memOpIdx, addr)) return MS_UNKNOWN;
+
+  return isReadOnlyMemory(addr) ? MS_READONLY : MS_WRITABLE;
+}
+
+/**
+ * Inserts a call checking if a memory access performed by a memory operand of
+ *   an instruction should be monitored before the instruction.
+ *
+ * @param ins An instruction.
+ * @param memOpIdx An index of the memory operand of the instruction.
+ * @param predicated @em True if the check should be performed only if the
+ *   instruction is executed, @em false if it should be performed always.
+ * @param writable @em True if the memory operand must access a writable memory
+ *   for the access to be monitored, @em false otherwise.
+ * @param sampled @em True if the function performing the access must be sampled
+ *   for the access to be monitored, @em false otherwise.
+ * @return A function inserting a call executed only if the memory access should
+ *   be monitored. This function must be called immediately.
+ */
+inline
+INSERTCALLFUNPTR insertAccessFilter(INS ins, UINT32 memOpIdx, BOOL predicated,
+  BOOL writable, BOOL sampled)
+{
+  // At least one of the conditions must be checked
+  assert(writable || sampled);
+
+  // Helper variables
+  INSERTCALLFUNPTR insertIfCall = (predicated)
+    ? INS_InsertIfPredicatedCall : INS_InsertIfCall;
+
+  if (writable && sampled)
+    insertIfCall(
+      ins, IPOINT_BEFORE, (AFUNPTR)isSampledWritableMemoryAccess,
+      IARG_FAST_ANALYSIS_CALL,
+      IARG_THREAD_ID,
+      IARG_MEMORYOP_EA, memOpIdx,
+      IARG_END);
+  else if (writable)
+    insertIfCall(
+      ins, IPOINT_BEFORE, (AFUNPTR)isWritableMemory,
+      IARG_FAST_ANALYSIS_CALL,
+      IARG_MEMORYOP_EA, memOpIdx,
+      IARG_END);
+  else
+    insertIfCall(
+      ins, IPOINT_BEFORE, (AFUNPTR)isSampledMemoryAccess,
+      IARG_FAST_ANALYSIS_CALL,
+      IARG_THREAD_ID,
+      IARG_END);
+
+  return (predicated) ? INS_InsertThenPredicatedCall : INS_InsertThenCall;
+}
+
+/**
+ * Inserts a call checking if a memory access of an instruction is monitored,
+ *   i.e., if it was not filtered out before the instruction, after the
+ *   instruction.
+ *
+ * @param ins An instruction.
+ * @param memAccInfo A structure containing static (non-changing) information
+ *   about the access.
+ * @param predicated @em True if the check should be performed only if the
+ *   instruction is executed, @em false if it should be performed always.
+ * @return A function inserting a call executed only if the memory access is
+ *   monitored. This function must be called immediately.
+ */
+inline
+INSERTCALLFUNPTR insertMonitoredAccessCheck(INS ins,
+  MemoryAccessInfo* memAccInfo, BOOL predicated)
+{
+  ((predicated) ? INS_InsertIfPredicatedCall : INS_InsertIfCall)(
+    ins, IPOINT_AFTER, (AFUNPTR)isMemoryAccessMonitored,
+    IARG_FAST_ANALYSIS_CALL,
+    IARG_THREAD_ID,
+    IARG_PTR, memAccInfo,
+    IARG_END);
+
+  return (predicated) ? INS_InsertThenPredicatedCall : INS_InsertThenCall;
+}
+
 /**
  * Instruments all memory accesses (reads and writes) of an instruction.
  *
  * @param ins An instruction whose memory accesses should be instrumented.
  * @param mas An object containing memory access instrumentation settings.
+ * @param skip A bit mask of memory accesses which should not be instrumented,
+ *   i.e., if the N-th bit is set, the N-th memory access is not instrumented.
+ * @param block A structure containing information about the accesses which
+ *   are stored for the batch consumers together at the end of the basic block
+ *   containing the instruction or @em NULL if each access should be stored
+ *   separately. Updated with the accesses of the instruction stored together.
  */
 inline
-VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
+VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas, UINT32 skip = 0,
+  BlockAccessInfo* block = NULL)
 {
   // Get the number of memory accesses (reads/writes) done by the instruction
   UINT32 memOpCount = INS_MemoryOperandCount(ins);
@@ -236,6 +494,8 @@ VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
 
   for (UINT32 memOpIdx = 0; memOpIdx < memOpCount; memOpIdx++)
   { // Instrument all memory accesses (reads and writes)
+    if (skip & (1 << memOpIdx)) continue; // Access merged with a previous one
+
     if (INS_MemoryOperandIsWritten(ins, memOpIdx))
     { // The memOpIdx-th memory access is a write or update access
       access = (INS_MemoryOperandIsRead(ins, memOpIdx))
@@ -246,6 +506,37 @@ VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
       access = &mas.reads;
     }
 
+    if (mas.skipStackAccesses && !access->localAccesses
+      && isStackAccess(ins, memOpIdx))
+    { // Nobody needs to know about accesses to local variables, skip them
+      continue;
+    }
+
+    // Helper variables
+    BOOL checkWritable = false;
+    BOOL filter = false;
+
+    if (mas.skipReadOnlyAccesses && !isStackAccess(ins, memOpIdx))
+    { // Stack is always writable, other memory might be read-only
+      switch (isReadOnlyMemoryAccess(ins, memOpIdx))
+      { // Skip accesses which are known to access read-only memory
+        case MS_READONLY: // Address known, read-only memory accessed
+          continue;
+        case MS_UNKNOWN: // Address not known, check it before the access
+          checkWritable = true;
+          break;
+        default: // Address known, writable memory accessed
+          break;
+      }
+    }
+
+    // Accesses might need to be filtered out before calling the analysis code
+    filter = checkWritable || mas.sampling;
+
+    // If a function is called before the access, it also stores the access for
+    // the batch consumers, so only one of them is called (and filtered)
+    assert(access->beforeAccess == NULL || access->recordAccess == NULL);
+
     // Static (non-changing) information about the memory access
     MemoryAccessInfo* memAccInfo = new MemoryAccessInfo(memOpIdx,
       INS_MemoryOperandSize(ins, memOpIdx), memAccInsInfo);
@@ -253,39 +544,113 @@ VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
     if (INS_HasRealRep(ins))
     { // Do not use predicated calls for REP instructions (they seems broken)
       if (access->beforeRepAccess != NULL)
+      { // Capture the registers only if some callback function needs them
+        INSERTCALLFUNPTR beforeCall = (filter)
+          ? insertAccessFilter(ins, memOpIdx, false, checkWritable,
+            mas.sampling)
+          : INS_InsertCall;
+
+        if (NEEDS_REGISTERS(access->beforeAccessInfo))
+          beforeCall(
+            ins, IPOINT_BEFORE, access->beforeRepAccess,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_CONST_CONTEXT,
+            IARG_EXECUTING,
+            IARG_PTR, memAccInfo,
+            IARG_END);
+        else
+          beforeCall(
+            ins, IPOINT_BEFORE, access->beforeRepAccess,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_PTR, NULL,
+            IARG_EXECUTING,
+            IARG_PTR, memAccInfo,
+            IARG_END);
+      }
+      if (access->afterRepAccess != NULL)
         INS_InsertCall(
-          ins, IPOINT_BEFORE, access->beforeRepAccess,
+          ins, IPOINT_AFTER, access->afterRepAccess,
           IARG_FAST_ANALYSIS_CALL,
           IARG_THREAD_ID,
-          IARG_MEMORYOP_EA, memOpIdx,
-          IARG_CONST_CONTEXT,
-          IARG_EXECUTING,
           IARG_PTR, memAccInfo,
           IARG_END);
-      if (access->afterRepAccess != NULL)
-        INS_InsertCall(
-          ins, IPOINT_AFTER, access->afterRepAccess,
+      if (access->recordRepAccess != NULL)
+        ((filter) ? insertAccessFilter(ins, memOpIdx, false,
+          checkWritable, mas.sampling) : INS_InsertCall)(
+          ins, IPOINT_BEFORE, access->recordRepAccess,
           IARG_FAST_ANALYSIS_CALL,
           IARG_THREAD_ID,
+          IARG_MEMORYOP_EA, memOpIdx,
+          IARG_EXECUTING,
           IARG_PTR, memAccInfo,
           IARG_END);
     }
     else
     { // Use predicated calls for conditional instructions, normal for others
       if (access->beforeAccess != NULL)
-        insertCall(
-          ins, IPOINT_BEFORE, access->beforeAccess,
+      { // Capture the registers only if some callback function needs them
+        INSERTCALLFUNPTR beforeCall = (filter)
+          ? insertAccessFilter(ins, memOpIdx, INS_IsPredicated(ins),
+            checkWritable, mas.sampling)
+          : insertCall;
+
+        if (NEEDS_REGISTERS(access->beforeAccessInfo))
+          beforeCall(
+            ins, IPOINT_BEFORE, access->beforeAccess,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_CONST_CONTEXT,
+            IARG_PTR, memAccInfo,
+            IARG_END);
+        else
+          beforeCall(
+            ins, IPOINT_BEFORE, access->beforeAccess,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_PTR, NULL,
+            IARG_PTR, memAccInfo,
+            IARG_END);
+      }
+      if (access->afterAccess != NULL)
+        ((filter)
+          ? insertMonitoredAccessCheck(ins, memAccInfo, INS_IsPredicated(ins))
+          : insertCall)(
+          ins, IPOINT_AFTER, access->afterAccess,
           IARG_FAST_ANALYSIS_CALL,
           IARG_THREAD_ID,
-          IARG_MEMORYOP_EA, memOpIdx,
-          IARG_CONST_CONTEXT,
           IARG_PTR, memAccInfo,
           IARG_END);
-      if (access->afterAccess != NULL)
-        insertCall(
-          ins, IPOINT_AFTER, access->afterAccess,
+      if (access->recordAccess != NULL && block != NULL && !filter
+        && !INS_IsPredicated(ins) && block->count < BLOCK_MAX_ACCESSES)
+      { // Store only the address now, the access is stored for the batch
+        // consumers at the end of the basic block with the other accesses
+        INS_InsertCall(
+          ins, IPOINT_BEFORE, (AFUNPTR)storeBlockAccess,
+          IARG_FAST_ANALYSIS_CALL,
+          IARG_THREAD_ID,
+          IARG_MEMORYOP_EA, memOpIdx,
+          IARG_UINT32, block->count,
+          IARG_END);
+
+        block->accesses[block->count] = memAccInfo;
+        block->types[block->count++] = (access == &mas.reads) ? ART_READ
+          : (access == &mas.writes) ? ART_WRITE : ART_UPDATE;
+      }
+      else if (access->recordAccess != NULL)
+        ((filter)
+          ? insertAccessFilter(ins, memOpIdx, INS_IsPredicated(ins),
+            checkWritable, mas.sampling)
+          : insertCall)(
+          ins, IPOINT_BEFORE, access->recordAccess,
           IARG_FAST_ANALYSIS_CALL,
           IARG_THREAD_ID,
+          IARG_MEMORYOP_EA, memOpIdx,
           IARG_PTR, memAccInfo,
           IARG_END);
     }
@@ -296,6 +661,53 @@ VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
       if (!g_predsMon->hasPredecessor(INS_Address(ins))) continue;
     }
 
+    if (std::count(access->noise->filters.begin(), access->noise->filters.end(),
+      NF_SHARED_VARS))
+    { // Do not insert noise before accesses which cannot touch shared variables
+      ADDRINT addr; // Only global variables have statically known addresses
+
+      if (getStaticAddress(ins, memOpIdx, addr))
+      { // The accessed variable is known now, decide where to place the noise
+        if (!isSharedVariableNoisePoint(addr, access->noise)) continue;
+      }
+      else
+      { // Address computed from registers (e.g. an element of an array or a
+        // variable accessed through the global offset table), check it later
+        if (isStackAccess(ins, memOpIdx)) continue; // Locals are never shared
+
+        if (access->noise->filter != NULL)
+        { // The filters might need the registers, spill the context for them
+          insertCall(
+            ins, IPOINT_BEFORE, access->noise->svarsFilter,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_UINT32, INS_MemoryOperandSize(ins, memOpIdx),
+            IARG_ADDRINT, RTN_Address(INS_Rtn(ins)),
+            IARG_ADDRINT, INS_Address(ins),
+            IARG_CONST_CONTEXT,
+            IARG_PTR, access->noise,
+            IARG_END);
+        }
+        else
+        { // No filters, the check needs only the address, not the registers
+          insertCall(
+            ins, IPOINT_BEFORE, access->noise->svarsFilter,
+            IARG_FAST_ANALYSIS_CALL,
+            IARG_THREAD_ID,
+            IARG_MEMORYOP_EA, memOpIdx,
+            IARG_UINT32, INS_MemoryOperandSize(ins, memOpIdx),
+            IARG_ADDRINT, RTN_Address(INS_Rtn(ins)),
+            IARG_ADDRINT, INS_Address(ins),
+            IARG_PTR, NULL,
+            IARG_PTR, access->noise,
+            IARG_END);
+        }
+
+        continue; // The noise is injected through the check above
+      }
+    }
+
     if (access->noise->filter != NULL)
     { // Some filters active, let them determine if noise should be injected
       insertCall(
@@ -323,6 +735,106 @@ VOID instrumentMemoryAccess(INS ins, MemoryAccessSettings& mas)
   }
 }
 
+/**
+ * Gets a description of how an instruction computes an address of the memory
+ *   accessed by one of its memory operands.
+ *
+ * @param ins An instruction.
+ * @param memOpIdx An index of the memory operand of the instruction.
+ * @return A description of how the instruction computes the address.
+ */
+inline
+MemoryOperand getMemoryOperand(INS ins, UINT32 memOpIdx)
+{
+  // Memory operands are indexed differently than the other operands
+  UINT32 opIdx = INS_MemoryOperandIndexToOperandIndex(ins, memOpIdx);
+
+  MemoryOperand mo;
+
+  mo.base = REG_FullRegName(INS_OperandMemoryBaseReg(ins, opIdx));
+  mo.index = REG_FullRegName(INS_OperandMemoryIndexReg(ins, opIdx));
+  mo.segment = INS_OperandMemorySegmentReg(ins, opIdx);
+  mo.scale = INS_OperandMemoryScale(ins, opIdx);
+  mo.displacement = INS_OperandMemoryDisplacement(ins, opIdx);
+  mo.size = INS_MemoryOperandSize(ins, memOpIdx);
+  mo.read = INS_MemoryOperandIsRead(ins, memOpIdx);
+  mo.written = INS_MemoryOperandIsWritten(ins, memOpIdx);
+
+  if (mo.base == REG_INST_PTR)
+  { // The address is relative to the next instruction, make it absolute, so
+    // accesses to the same address from different instructions will match
+    mo.base = REG_INVALID();
+    mo.displacement += INS_NextAddress(ins);
+  }
+
+  return mo;
+}
+
+/**
+ * Finds memory accesses of an instruction which access the same address in the
+ *   same way as some previous instruction in the same basic block.
+ *
+ * @note Only accesses which are always performed (not predicated and without
+ *   a REP prefix) are considered. Atomic updates are never merged and act as
+ *   a barrier, i.e., no access after them is merged with an access before.
+ *   Writes act as a barrier for the accesses which may access the same memory.
+ *
+ * @param ins An instruction.
+ * @param seen A list of memory operands of the previous instructions in the
+ *   basic block which may be used to access the same address. Updated with
+ *   the memory operands of the instruction.
+ * @return A bit mask of memory accesses which access the same address as some
+ *   previous instruction, i.e., if the N-th bit is set, the N-th memory access
+ *   can be merged with a previous access.
+ */
+inline
+UINT32 findMergeableMemoryAccesses(INS ins, MemoryOperandList& seen)
+{
+  // Helper variables
+  UINT32 mergeable = 0;
+
+  if (INS_IsAtomicUpdate(ins))
+  { // Atomic updates synchronise threads, do not merge accesses across them
+    seen.clear();
+  }
+  else if (!INS_IsPredicated(ins) && !INS_HasRealRep(ins))
+  { // Accesses of these instructions are always performed, we can merge them
+    for (UINT32 memOpIdx = 0; memOpIdx < INS_MemoryOperandCount(ins);
+      memOpIdx++)
+    { // Check if some previous instruction accessed the same memory
+      MemoryOperand mo = getMemoryOperand(ins, memOpIdx);
+
+      if (mo.written)
+      { // Accesses before a write cannot be merged with accesses after it,
+        // e.g., merging two reads with a write in between would hide the
+        // read-write-read pattern from the atomicity violation detectors
+        seen.erase(std::remove_if(seen.begin(), seen.end(),
+          [&mo] (const MemoryOperand& prev)
+          { return prev.overlaps(mo) && !(prev == mo); }), seen.end());
+      }
+
+      if (std::find(seen.begin(), seen.end(), mo) != seen.end())
+      { // Same address accessed in the same way before, merge the accesses
+        mergeable |= 1 << memOpIdx;
+      }
+      else
+      { // First access to this address in the basic block, remember it
+        seen.push_back(mo);
+      }
+    }
+  }
+
+  for (UINT32 i = 0; i < INS_MaxNumWRegs(ins); i++)
+  { // Addresses computed from the modified registers are not the same anymore
+    REG reg = REG_FullRegName(INS_RegW(ins, i));
+
+    seen.erase(std::remove_if(seen.begin(), seen.end(),
+      [reg] (const MemoryOperand& mo) { return mo.uses(reg); }), seen.end());
+  }
+
+  return mergeable;
+}
+
 /**
  * Inserts a noise-injecting hook (callback) before a function.
  *
@@ -364,6 +876,42 @@ VOID instrumentNoisePoint(INS ins, NoiseSettings* ns)
     IARG_END);
 }
 
+/**
+ * Instruments a routine whose memory accesses are sampled, i.e., monitored only
+ *   in some of its executions.
+ *
+ * @note The sampling decision is made when the routine is entered and holds
+ *   until the routine returns. Decisions made for the callers are restored when
+ *   the routine returns. The decisions are tracked by the values of the stack
+ *   pointer, so routines left without returning do not leave stale decisions.
+ *
+ * @param rtn An object representing the routine.
+ */
+inline
+VOID instrumentSampledRoutine(RTN rtn)
+{
+  RTN_InsertCall(
+    rtn, IPOINT_BEFORE, (AFUNPTR)beforeSampledFunctionExecuted,
+    IARG_FAST_ANALYSIS_CALL,
+    IARG_THREAD_ID,
+    IARG_REG_VALUE, REG_STACK_PTR,
+    IARG_ADDRINT, indexFunction(rtn),
+    // The decision must be made before the first access is checked
+    IARG_CALL_ORDER, CALL_ORDER_FIRST,
+    IARG_END);
+
+  for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins))
+  { // Restore the decision made for the caller when returning to it
+    if (INS_IsRet(ins))
+      INS_InsertCall(
+        ins, IPOINT_BEFORE, (AFUNPTR)beforeSampledFunctionReturned,
+        IARG_FAST_ANALYSIS_CALL,
+        IARG_THREAD_ID,
+        IARG_REG_VALUE, REG_STACK_PTR,
+        IARG_END);
+  }
+}
+
 /**
  * Instruments an image (executable, shared object, dynamic library, ...).
  *
@@ -409,6 +957,9 @@ VOID instrumentImage(IMG img, VOID* v)
     // Open the image and extract debugging information from it
     DIE_Open(img);
 
+    // Find where the shared variables are, noise might be placed before them
+    registerSharedVariables(img);
+
     if (settings->get< bool >("show-dbg-info"))
     { // Print the extracted debugging information
       DIE_Print(img);
@@ -438,6 +989,20 @@ VOID instrumentImage(IMG img, VOID* v)
   filter.access.disable = settings->disableMemoryAccessMonitoring(img,
     filter.access.reason.image);
 
+  if (settings->get< bool >("instrumentation.skip-readonly-accesses"))
+  { // Remember where the read-only sections are, accesses to them are skipped
+    for (SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec))
+    { // Sections which are not loaded to memory cannot be accessed
+      if (SEC_Mapped(sec) && !SEC_IsWriteable(sec))
+        registerReadOnlyMemory(SEC_Address(sec),
+          SEC_Address(sec) + SEC_Size(sec));
+    }
+  }
+
+  // Memory accesses might be instrumented per basic block instead of routine
+  bool traceMode = settings->get< std::string >("instrumentation.mode")
+    == "trace";
+
   // Framework settings contain information about read and write noise
   MemoryAccessSettings mas(settings);
 
@@ -517,9 +1082,20 @@ VOID instrumentImage(IMG img, VOID* v)
               instrumentStackFrameOperation(ins);
             }
 #endif
+            // In trace mode, accesses are instrumented per basic block later
+            if (traceMode) continue;
+
             // Check if the instruction accesses memory and instrument it if yes
             instrumentMemoryAccess(ins, mas);
           }
+
+          // Let the trace instrumentation know it should instrument accesses
+          if (traceMode) g_monitoredRoutines.insert(RTN_Address(rtn));
+
+          if (mas.sampling)
+          { // Decide which executions of the routine will be monitored
+            instrumentSampledRoutine(rtn);
+          }
         }
       }
 
@@ -562,6 +1138,90 @@ VOID instrumentImage(IMG img, VOID* v)
   }
 }
 
+/**
+ * Instruments memory accesses in a trace (a sequence of basic blocks).
+ *
+ * Memory accesses are processed per basic block. Accesses to the same address
+ *   which are performed repeatedly in a single basic block are merged, i.e.,
+ *   only the first of them is instrumented. As basic blocks end with calls,
+ *   no synchronisation operation can be performed between merged accesses.
+ *
+ * Accesses stored only for the batch consumers are stored by a single call
+ *   per basic block, which gets a table describing the accesses. Before each
+ *   access, only its address is stored by an inlined analysis code. Filtered
+ *   and predicated accesses are still stored one by one, so they may precede
+ *   the other accesses of the basic block in the batch.
+ *
+ * @param trace An object representing the trace.
+ * @param v A pointer to arbitrary data.
+ */
+VOID instrumentTrace(TRACE trace, VOID* v)
+{
+  // Get the routine containing the trace (its first instruction to be exact)
+  RTN rtn = TRACE_Rtn(trace);
+
+  // Instrument only accesses in routines where they should be monitored
+  if (!RTN_Valid(rtn) || !g_monitoredRoutines.count(RTN_Address(rtn))) return;
+
+  if (g_traceMas == NULL)
+  { // All callback functions are registered now, setup the instrumentation
+    g_traceMas = new MemoryAccessSettings(static_cast< Settings* >(v));
+
+    setupMemoryAccessSettings(*g_traceMas);
+  }
+
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl))
+  { // Find the repeated accesses in each basic block and instrument the rest
+    MemoryOperandList seen;
+    BlockAccessInfo* block = new BlockAccessInfo();
+
+    for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins))
+    { // Merged accesses are skipped, instrument all other accesses
+      instrumentMemoryAccess(ins, *g_traceMas,
+        findMergeableMemoryAccesses(ins, seen), block);
+    }
+
+    if (block->count == 0)
+    { // No access is stored at the end of the basic block
+      delete block;
+
+      continue;
+    }
+
+    // Inserted after the addresses are stored, so it is called after them
+    INS_InsertCall(
+      BBL_InsTail(bbl), IPOINT_BEFORE, (AFUNPTR)recordBlockAccesses,
+      IARG_FAST_ANALYSIS_CALL,
+      IARG_THREAD_ID,
+      IARG_PTR, block,
+      IARG_END);
+  }
+}
+
+/**
+ * Forgets information about an image (executable, shared object, dynamic
+ *   library, ...) which is being unloaded.
+ *
+ * @param img An object representing the image.
+ * @param v A pointer to arbitrary data.
+ */
+VOID unloadImage(IMG img, VOID* v)
+{
+  if (g_readOnlyMemory)
+  { // The memory of the image might be reused, it might not be read-only then
+    unregisterReadOnlyMemory(IMG_LowAddress(img), IMG_HighAddress(img) + 1);
+  }
+
+  // The memory of the image might be reused by other (not shared) variables
+  unregisterSharedVariables(IMG_LowAddress(img), IMG_HighAddress(img) + 1);
+
+  // Another image might be loaded at the same address, its routines might not
+  // be monitored, so forget the routines of this image
+  g_monitoredRoutines.erase(
+    g_monitoredRoutines.lower_bound(IMG_LowAddress(img)),
+    g_monitoredRoutines.upper_bound(IMG_HighAddress(img)));
+}
+
 /**
  * Instruments a routine.
  *
@@ -578,6 +1238,18 @@ VOID instrumentRoutine(RTN rtn, VOID *v)
     return;
   }
 
+  // Helper variables
+  index_t idx = indexFunction(rtn);
+  const FunctionCallbacks* callbacks = getFunctionCallbacks(idx);
+
+  if (callbacks == NULL)
+  { // Analysers are not interested in the execution of this function
+    LOG("  [-] Execution of function " + RTN_Name(rtn)
+      + " will not be monitored (no subscribers).\n");
+
+    return;
+  }
+
   // Routine needs to be opened before its instructions can be instrumented
   RTN_Open(rtn);
 
@@ -586,7 +1258,8 @@ VOID instrumentRoutine(RTN rtn, VOID *v)
     IARG_FAST_ANALYSIS_CALL,
     IARG_THREAD_ID,
     IARG_REG_VALUE, REG_STACK_PTR,
-    IARG_ADDRINT, indexFunction(rtn),
+    IARG_ADDRINT, idx,
+    IARG_PTR, callbacks,
     // Hook callback functions may use the data updated by the above function,
     // so call the above callback function before the hook callback functions
     IARG_CALL_ORDER, CALL_ORDER_DEFAULT - 10,
@@ -606,10 +1279,14 @@ VOID instrumentInstruction(INS ins, VOID *v)
 {
   // Helper variables
   NoiseSettings* ns = NULL;
-  LOCATION location;
+  INT32 line = -1;
+  std::string file;
 
   // Get the location in the source code for which was the instruction generated
-  PIN_GetSourceLocation(INS_Address(ins), NULL, &location.line, &location.file);
+  PIN_GetSourceLocation(INS_Address(ins), NULL, &line, &file);
+
+  // Most instructions are not noise points, do not index their locations
+  LOCATION location(file, line);
 
   if (Settings::Get()->isNoisePoint(&location, &ns))
   { // The instruction is a noise point, need to inject noise before it
@@ -620,18 +1297,12 @@ VOID instrumentInstruction(INS ins, VOID *v)
 }
 
 /**
- * Cleans up and frees all resources allocated by the ANaConDA framework.
- *
- * @note This function is called when the program being analysed exits.
- *
- * @param code An OS specific termination code of the program.
- * @param v A pointer to arbitrary data.
+ * Restores the standard output and error output if the program closed them.
  */
-void onProgramExit(INT32 code, VOID* v)
+inline
+VOID restoreStandardOutputs()
 {
 #ifdef TARGET_LINUX
-  // Make sure stdout and stderr are still usable before shutting down analysers
-  // as the analysers may need to output something in their finish functions
   if (fcntl(STDOUT_FILENO, F_GETFD) == -1)
   { // Stdout already closed, restore it
     dup2(g_origStdout, STDOUT_FILENO);
@@ -642,6 +1313,39 @@ void onProgramExit(INT32 code, VOID* v)
     dup2(g_origStderr, STDERR_FILENO);
   }
 #endif
+}
+
+/**
+ * Stops the internal threads of the ANaConDA framework.
+ *
+ * @note This function is called when the program being analysed is about to
+ *   exit, before its threads are terminated. Internal threads cannot be waited
+ *   for safely after that.
+ *
+ * @param v A pointer to arbitrary data.
+ */
+VOID onProgramExiting(VOID* v)
+{
+  // The output thread prints the buffered output before it finishes
+  restoreStandardOutputs();
+
+  // Print the buffered output, the rest is printed directly
+  finishOutputModule();
+}
+
+/**
+ * Cleans up and frees all resources allocated by the ANaConDA framework.
+ *
+ * @note This function is called when the program being analysed exits.
+ *
+ * @param code An OS specific termination code of the program.
+ * @param v A pointer to arbitrary data.
+ */
+void onProgramExit(INT32 code, VOID* v)
+{
+  // Make sure stdout and stderr are still usable before shutting down analysers
+  // as the analysers may need to output something in their finish functions
+  restoreStandardOutputs();
 
   // The pointer 'v' is a pointer to an object containing framework settings
   Settings* settings = static_cast< Settings* >(v);
@@ -698,6 +1402,11 @@ void setupInstrumentation(Settings* settings)
       static_cast< VOID* >(settings));
   }
 
+  if (settings->get< std::string >("instrumentation.mode") == "trace")
+  { // Instrument memory accesses per basic block instead of per routine
+    TRACE_AddInstrumentFunction(instrumentTrace, static_cast< VOID* >(settings));
+  }
+
   // TODO: Call this only when the location noise is in use
   INS_AddInstrumentFunction(instrumentInstruction, 0);
 }
@@ -752,6 +1461,7 @@ int main(int argc, char* argv[])
   setupIndexModule();
 
   // Register parts of the framework that need to be setup
+  settings->registerSetupFunction(setupOutputModule);
   settings->registerSetupFunction(setupRandomModule);
   settings->registerSetupFunction(setupThreadModule);
   settings->registerSetupFunction(setupAccessModule);
@@ -800,7 +1510,15 @@ int main(int argc, char* argv[])
   // Register callback functions called when an existing thread finishes
   PIN_AddThreadFiniFunction(threadFinished, 0);
 
+  // Read-only memory of unloaded images is not read-only anymore
+  g_readOnlyMemory = settings->get< bool >(
+    "instrumentation.skip-readonly-accesses");
+
+  // Register callback functions called when an image is unloaded
+  IMG_AddUnloadFunction(unloadImage, 0);
+
   // Register callback functions called when the program to be analysed exits
+  PIN_AddPrepareForFiniFunction(onProgramExiting, 0);
   PIN_AddFiniFunction(onProgramExit, static_cast< VOID* >(settings));
 
   // Call the function supporting the chosen types of concurrent coverage
@@ -810,7 +1528,7 @@ int main(int argc, char* argv[])
 
   if (settings->get< bool >("coverage.synchronisation"))
   { // The framework should monitor the synchronisation coverage, enable it
-    static SyncCoverageMonitor< FileWriter >&
+    static SyncCoverageMonitor< BinaryFileWriter >&
       syncMon = settings->getCoverageMonitors().sync;
 
     // Cannot call the monitor methods directly, wrap the calls into lambdas
@@ -826,26 +1544,26 @@ int main(int argc, char* argv[])
 
   if (settings->get< bool >("coverage.sharedvars"))
   { // The framework should monitor shared variables, enable their monitoring
-    static SharedVariablesMonitor< FileWriter >&
+    static SharedVariablesMonitor< BinaryFileWriter >&
       svarsMon = settings->getCoverageMonitors().svars;
 
     // Cannot call the monitor methods directly, wrap the calls into lambdas
     // (using captures would make the lambdas incompatible with the standard
     // functions we need to register, so we use a static reference instead)
-    ACCESS_BeforeMemoryRead((MEMREADAVOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, BOOL isLocal) -> VOID
-      { svarsMon.beforeVariableAccessed(tid, addr, variable, isLocal); }));
-    ACCESS_BeforeMemoryWrite((MEMWRITEAVOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, BOOL isLocal) -> VOID
-      { svarsMon.beforeVariableAccessed(tid, addr, variable, isLocal); }));
-    ACCESS_BeforeAtomicUpdate((MEMUPDATEAVOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, BOOL isLocal) -> VOID
-      { svarsMon.beforeVariableAccessed(tid, addr, variable, isLocal); }));
+    ACCESS_BeforeMemoryRead((MEMREADAOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, BOOL isLocal) -> VOID
+      { svarsMon.beforeVariableAccessed(tid, addr, isLocal); }));
+    ACCESS_BeforeMemoryWrite((MEMWRITEAOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, BOOL isLocal) -> VOID
+      { svarsMon.beforeVariableAccessed(tid, addr, isLocal); }));
+    ACCESS_BeforeAtomicUpdate((MEMUPDATEAOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, BOOL isLocal) -> VOID
+      { svarsMon.beforeVariableAccessed(tid, addr, isLocal); }));
   }
 
   if (settings->get< bool >("coverage.predecessors"))
   { // The framework should monitor the predecessors, enable their monitoring
-    static PredecessorsMonitor< FileWriter >&
+    static PredecessorsMonitor< BinaryFileWriter >&
       predsMon = settings->getCoverageMonitors().preds;
 
     // Cannot call the monitor methods directly, wrap the calls into lambdas
@@ -855,18 +1573,15 @@ int main(int argc, char* argv[])
       { predsMon.beforeFunctionEntered(tid); }));
     THREAD_FunctionExited((THREADFUNPTR)([] (THREADID tid) -> VOID
       { predsMon.beforeFunctionExited(tid); }));
-    ACCESS_BeforeMemoryRead((MEMREADAVIOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, ADDRINT ins,
-      BOOL isLocal) -> VOID
-      { predsMon.beforeVariableAccessed(tid, addr, variable, ins, isLocal); }));
-    ACCESS_BeforeMemoryWrite((MEMWRITEAVIOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, ADDRINT ins,
-      BOOL isLocal) -> VOID
-      { predsMon.beforeVariableAccessed(tid, addr, variable, ins, isLocal); }));
-    ACCESS_BeforeAtomicUpdate((MEMUPDATEAVIOFUNPTR)([] (THREADID tid,
-      ADDRINT addr, UINT32 size, const VARIABLE& variable, ADDRINT ins,
-      BOOL isLocal) -> VOID
-      { predsMon.beforeVariableAccessed(tid, addr, variable, ins, isLocal); }));
+    ACCESS_BeforeMemoryRead((MEMREADAIOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, ADDRINT ins, BOOL isLocal) -> VOID
+      { predsMon.beforeVariableAccessed(tid, addr, ins, isLocal); }));
+    ACCESS_BeforeMemoryWrite((MEMWRITEAIOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, ADDRINT ins, BOOL isLocal) -> VOID
+      { predsMon.beforeVariableAccessed(tid, addr, ins, isLocal); }));
+    ACCESS_BeforeAtomicUpdate((MEMUPDATEAIOFUNPTR)([] (THREADID tid,
+      ADDRINT addr, UINT32 size, ADDRINT ins, BOOL isLocal) -> VOID
+      { predsMon.beforeVariableAccessed(tid, addr, ins, isLocal); }));
   }
 
 #if ANACONDA_PRINT_EXECUTED_FUNCTIONS == 1
@@ -25,8 +25,8 @@
  * @file      anaconda.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-11-04
- * @date      Last Update 2016-07-26
- * @version   0.4.2
+ * @date      Last Update 2026-10-16
+ * @version   0.9.4
  */
 
 #ifndef __PINTOOL_ANACONDA__ANACONDA_H__
@@ -46,12 +46,45 @@
 // Functions for retrieving information about framework settings
 API_FUNCTION std::string SETTINGS_GetConfigFile(const std::string& path);
 
+// Definitions of memory-access-related special data types
+/**
+ * @brief An enumeration describing the types of memory accesses stored in the
+ *   memory access records.
+ */
+typedef enum AccessRecordType_e
+{
+  ART_READ   = 0, //!< A read access.
+  ART_WRITE  = 1, //!< A write access.
+  ART_UPDATE = 2  //!< An atomic update access.
+} AccessRecordType;
+
+/**
+ * @brief A structure representing a memory access delivered to the batch
+ *   consumers.
+ *
+ * @note The record is kept compact (32 bytes on 64-bit systems), so two of
+ *   them fit into a single cache line.
+ */
+typedef struct AccessRecord_s
+{
+  ADDRINT addr; //!< An accessed address.
+  ADDRINT ins; //!< An address of the instruction which performed the access.
+  THREADID tid; //!< A thread which performed the access.
+  UINT32 size; //!< A size in bytes of the memory accessed.
+  UINT8 type; //!< A type of the access (an item of AccessRecordType).
+  UINT8 index; //!< An index of the memory operand of the instruction.
+} ACCESS_RECORD;
+
 // Definitions of memory-access-related callback functions
 typedef VOID (*MEMREADAFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size);
 typedef VOID (*MEMREADAVFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable);
 typedef VOID (*MEMREADAVLFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location);
+typedef VOID (*MEMREADAOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  BOOL isLocal);
+typedef VOID (*MEMREADAIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  ADDRINT ins, BOOL isLocal);
 typedef VOID (*MEMREADAVOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, BOOL isLocal);
 typedef VOID (*MEMREADAVIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
@@ -61,6 +94,10 @@ typedef VOID (*MEMWRITEAVFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable);
 typedef VOID (*MEMWRITEAVLFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location);
+typedef VOID (*MEMWRITEAOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  BOOL isLocal);
+typedef VOID (*MEMWRITEAIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  ADDRINT ins, BOOL isLocal);
 typedef VOID (*MEMWRITEAVOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, BOOL isLocal);
 typedef VOID (*MEMWRITEAVIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
@@ -70,40 +107,69 @@ typedef VOID (*MEMUPDATEAVFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable);
 typedef VOID (*MEMUPDATEAVLFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, const LOCATION& location);
+typedef VOID (*MEMUPDATEAOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  BOOL isLocal);
+typedef VOID (*MEMUPDATEAIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
+  ADDRINT ins, BOOL isLocal);
 typedef VOID (*MEMUPDATEAVOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, BOOL isLocal);
 typedef VOID (*MEMUPDATEAVIOFUNPTR)(THREADID tid, ADDRINT addr, UINT32 size,
   const VARIABLE& variable, ADDRINT ins, BOOL isLocal);
+typedef VOID (*MEMBATCHFUNPTR)(THREADID tid, const ACCESS_RECORD* records,
+  UINT32 count);
 
 // Functions for registering memory-access-related callback functions
+API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryRead(MEMREADAVIOFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVIOFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVIOFUNPTR callback);
 
+API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryRead(MEMREADAVIOFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterMemoryWrite(MEMWRITEAVIOFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVLFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAOFUNPTR callback);
+API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAIOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVOFUNPTR callback);
 API_FUNCTION VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVIOFUNPTR callback);
 
+API_FUNCTION VOID ACCESS_RegisterBatchConsumer(MEMBATCHFUNPTR callback);
+
+// Functions for changing how memory accesses are monitored
+API_FUNCTION VOID ACCESS_AllowSampling();
+
 // Functions for retrieving information about accesses
-API_FUNCTION VOID ACCESS_GetLocation(ADDRINT ins, LOCATION& location);
+API_FUNCTION const LOCATION& ACCESS_GetLocation(ADDRINT ins);
 
 // Definitions of synchronisation-related callback functions
 typedef VOID (*LOCKFUNPTR)(THREADID tid, LOCK lock);
@@ -126,11 +192,13 @@ API_FUNCTION VOID SYNC_AfterJoin(JOINFUNPTR callback);
 // Definitions of thread-related special data types
 typedef std::deque< ADDRINT > Backtrace;
 typedef std::vector< std::string > Symbols;
+typedef ADDRINT BacktraceId;
 
 // Definitions of thread-related callback functions
 typedef VOID (*THREADFUNPTR)(THREADID tid);
 typedef VOID (*FORKFUNPTR)(THREADID tid, THREADID ntid);
 typedef VOID (*ARG1FUNPTR)(THREADID tid, ADDRINT* arg);
+typedef BOOL (*FUNCTIONFILTERFUNPTR)(index_t idx);
 
 // Functions for registering thread-related callback functions
 API_FUNCTION VOID THREAD_ThreadStarted(THREADFUNPTR callback);
@@ -139,6 +207,10 @@ API_FUNCTION VOID THREAD_ThreadForked(FORKFUNPTR callback);
 
 API_FUNCTION VOID THREAD_FunctionEntered(THREADFUNPTR callback);
 API_FUNCTION VOID THREAD_FunctionExited(THREADFUNPTR callback);
+API_FUNCTION VOID THREAD_FunctionEntered(THREADFUNPTR callback,
+  FUNCTIONFILTERFUNPTR filter);
+API_FUNCTION VOID THREAD_FunctionExited(THREADFUNPTR callback,
+  FUNCTIONFILTERFUNPTR filter);
 
 API_FUNCTION VOID THREAD_FunctionExecuted(const char* name, ARG1FUNPTR beforecb,
   UINT32 arg, ARG1FUNPTR aftercb);
@@ -148,10 +220,15 @@ API_FUNCTION VOID THREAD_FunctionExecuted(const char* name, ARG1FUNPTR callback,
 // Functions for retrieving information about threads
 API_FUNCTION VOID THREAD_GetBacktrace(THREADID tid, Backtrace& bt);
 API_FUNCTION VOID THREAD_GetBacktraceSymbols(Backtrace& bt, Symbols& symbols);
+API_FUNCTION BacktraceId THREAD_GetBacktraceId(THREADID tid);
+API_FUNCTION VOID THREAD_GetBacktraceSymbols(BacktraceId id, Symbols& symbols);
 API_FUNCTION VOID THREAD_GetThreadCreationLocation(THREADID tid,
   std::string& location);
 API_FUNCTION VOID THREAD_GetCurrentFunction(THREADID tid,
   std::string& function);
+API_FUNCTION index_t THREAD_GetCurrentFunctionIndex(THREADID tid);
+API_FUNCTION const std::string& THREAD_GetFunctionName(index_t idx);
+API_FUNCTION const std::string& THREAD_GetFunctionImage(index_t idx);
 API_FUNCTION THREADID THREAD_GetThreadId();
 API_FUNCTION PIN_THREAD_UID THREAD_GetThreadUid();
 
@@ -181,6 +258,31 @@ API_FUNCTION VOID TM_AfterTxAbort(AFTERTXABORTFUNPTR callback);
 API_FUNCTION VOID TM_AfterTxRead(AFTERTXREADFUNPTR callback);
 API_FUNCTION VOID TM_AfterTxWrite(AFTERTXWRITEFUNPTR callback);
 
+// Definitions of output-related special data types
+/**
+ * @brief An enumeration of channels to which the messages may be printed.
+ */
+typedef enum OutputChannel_e
+{
+  OC_CONSOLE          = 0, //!< A console (like @c CONSOLE).
+  OC_CONSOLE_NOPREFIX = 1, //!< A console (like @c CONSOLE_NOPREFIX).
+  OC_LOG              = 2  //!< A log file (like @c LOG).
+} OutputChannel;
+
+// Functions for printing messages without blocking other threads
+API_FUNCTION VOID OUTPUT_Print(THREADID tid, OutputChannel channel,
+  const char* message, UINT32 length);
+API_FUNCTION VOID OUTPUT_Print(THREADID tid, OutputChannel channel,
+  const std::string& message);
+
+// Helper macros for printing messages without blocking other threads
+#define CONSOLE_ASYNC(tid, message) \
+  OUTPUT_Print(tid, OC_CONSOLE, message)
+#define CONSOLE_NOPREFIX_ASYNC(tid, message) \
+  OUTPUT_Print(tid, OC_CONSOLE_NOPREFIX, message)
+#define LOG_ASYNC(tid, message) \
+  OUTPUT_Print(tid, OC_LOG, message)
+
 #endif /* __PINTOOL_ANACONDA__ANACONDA_H__ */
 
 /** End of file anaconda.h **/
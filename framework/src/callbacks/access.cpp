@@ -26,15 +26,21 @@
  * @file      access.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-19
- * @date      Last Update 2019-06-10
- * @version   0.11
+ * @date      Last Update 2026-10-16
+ * @version   0.16.8
  */
 
 #include "access.h"
 
+#include <algorithm>
+#include <atomic>
+
+#include <boost/foreach.hpp>
+
 #include "libdie-wrapper/pin_die.h"
 
 #include "../anaconda.h"
+#include "../index.h"
 
 #include "../monitors/preds.hpp"
 #include "../monitors/svars.hpp"
@@ -82,12 +88,60 @@ typedef VOID (*MEMUPDATEINVALIDFUNPTR)();
 static VOID deleteThreadData(void* threadData);
 static VOID deleteMemoryAccesses(void* memoryAccesses);
 static VOID deleteRepExecutedFlag(void* repExecutedFlag);
+static VOID deleteAccessBatch(void* accessBatch);
+
+/**
+ * @brief A structure containing settings of the adaptive sampling of memory
+ *   accesses.
+ *
+ * @note All rates are given in tenths of a percent (0-1000).
+ */
+typedef struct SamplingSettings_s
+{
+  bool allowed; //!< A flag determining if the analyser tolerates sampling.
+  bool enabled; //!< A flag determining if the user requested sampling.
+  UINT32 initialRate; //!< A rate used for functions executed for the first time.
+  UINT32 minimumRate; //!< A rate below which the rate is never decreased.
+  UINT32 backoff; //!< A factor by which the rate is decreased after a burst.
+  UINT32 burst; //!< A number of consecutive executions sampled in a burst.
+
+  /**
+   * Constructs a SamplingSettings_s object.
+   */
+  SamplingSettings_s() : allowed(false), enabled(false), initialRate(1000),
+    minimumRate(1), backoff(10), burst(10) {}
+} SamplingSettings;
+
+/**
+ * @brief A structure containing addresses accessed by a thread in the basic
+ *   block it is currently executing.
+ */
+typedef struct alignas(CACHE_LINE_SIZE) BlockAddresses_s
+{
+  ADDRINT addr[BLOCK_MAX_ACCESSES]; //!< Addresses indexed by access slots.
+} BlockAddresses;
+
+// Type definitions
+typedef std::vector< MEMBATCHFUNPTR > BatchConsumerContainerType;
 
 namespace
 { // Static global variables (usable only within this module)
-  TLS_KEY g_threadDataTlsKey = PIN_CreateThreadDataKey(deleteThreadData);
-  TLS_KEY g_memoryAccessesTlsKey = PIN_CreateThreadDataKey(deleteMemoryAccesses);
-  TLS_KEY g_repExecutedFlagTlsKey = PIN_CreateThreadDataKey(deleteRepExecutedFlag);
+  TLS_KEY g_threadDataTlsKey = TLS_CreateThreadDataKey(deleteThreadData);
+  TLS_KEY g_memoryAccessesTlsKey = TLS_CreateThreadDataKey(deleteMemoryAccesses);
+  TLS_KEY g_repExecutedFlagTlsKey = TLS_CreateThreadDataKey(deleteRepExecutedFlag);
+  TLS_KEY g_accessBatchTlsKey = TLS_CreateThreadDataKey(deleteAccessBatch);
+
+  BatchConsumerContainerType g_batchConsumers;
+  UINT32 g_batchSize = 1024; //!< A number of records a batch can hold.
+
+  // Sorted read-only memory ranges, replaced as a whole when images are loaded
+  std::atomic< const MemoryRangeList* > g_readOnlyMemory(new MemoryRangeList());
+
+  SamplingSettings g_sampling; //!< Settings of the adaptive sampling.
+
+  // Addresses accessed in basic blocks, indexed directly by thread IDs, so
+  // the analysis code storing them is simple enough to be inlined by PIN
+  BlockAddresses g_blockAddresses[PIN_MAX_THREADS];
 }
 
 /**
@@ -100,19 +154,126 @@ typedef enum AccessType_e
   UPDATE //!< An atomic update access.
 } AccessType;
 
+/**
+ * @brief A structure deciding which executions of a function are sampled.
+ *
+ * Executions are sampled in bursts. A function executed for the first time is
+ *   sampled with the initial rate. After each burst, the rate is decreased by
+ *   the back-off factor until it reaches the minimum rate, so rarely executed
+ *   (cold) functions are sampled much more often than the hot ones.
+ */
+typedef struct SamplingCounter_s
+{
+  UINT32 rate; //!< A current sampling rate (in tenths of a percent).
+  UINT32 burst; //!< A number of executions left in the current burst.
+  UINT32 skip; //!< A number of executions to skip before the next burst.
+
+  /**
+   * Constructs a SamplingCounter_s object.
+   */
+  SamplingCounter_s() : rate(g_sampling.initialRate), burst(0), skip(0) {}
+
+  /**
+   * Decides if the next execution of a function should be sampled.
+   *
+   * @return @em True if the execution should be sampled, @em false otherwise.
+   */
+  bool sample()
+  {
+    if (burst != 0) { --burst; return true; } // Burst in progress
+    if (skip != 0) { --skip; return false; } // Waiting for the next burst
+
+    // Start a new burst and skip enough executions after it to get the rate
+    burst = g_sampling.burst - 1;
+    skip = g_sampling.burst * (1000 - rate) / rate;
+
+    // The more often is the function executed, the less often we sample it
+    rate = std::max(rate / g_sampling.backoff, g_sampling.minimumRate);
+
+    return true;
+  }
+} SamplingCounter;
+
+/**
+ * @brief A structure representing a sampling decision of a function waiting
+ *   for a function it called to return.
+ */
+typedef struct SampledFrame_s
+{
+  /**
+   * @brief A value of the stack pointer register when the callee was entered,
+   *   i.e., the address of the return address of the callee.
+   */
+  ADDRINT sp;
+  BOOL sampled; //!< A sampling decision of the caller.
+
+  /**
+   * Constructs a SampledFrame_s object.
+   *
+   * @param s A value of the stack pointer register when the callee was entered.
+   * @param d A sampling decision of the caller.
+   */
+  SampledFrame_s(ADDRINT s, BOOL d) : sp(s), sampled(d) {}
+} SampledFrame;
+
 /**
  * @brief A structure holding private data of a thread.
  */
 typedef struct ThreadData_s
 {
   ADDRINT splow; //!< The lowest value of stack pointer seen in the execution.
+  /**
+   * @brief A flag determining if the currently executed function is sampled,
+   *   i.e., if its memory accesses should be monitored.
+   */
+  BOOL sampled;
+  /**
+   * @brief Sampling decisions of the functions waiting for the currently
+   *   executed function to return.
+   */
+  std::vector< SampledFrame > sampledStack;
+  /**
+   * @brief Sampling counters of the functions executed by the thread (indexed
+   *   by the indexes of the functions).
+   */
+  std::vector< SamplingCounter > counters;
 
   /**
    * Constructs a ThreadData_s object.
    */
-  ThreadData_s() : splow(-1) {}
+  ThreadData_s() : splow(-1), sampled(true), sampledStack(), counters() {}
 } ThreadData;
 
+/**
+ * @brief A structure holding memory accesses performed by a thread which were
+ *   not yet delivered to the batch consumers.
+ */
+typedef struct AccessBatch_s
+{
+  ACCESS_RECORD* records; //!< A cache-aligned array of access records.
+  UINT32 count; //!< A number of access records stored in the array.
+  UINT32 capacity; //!< A maximum number of access records in the array.
+  char* memory; //!< A memory block in which the array is stored.
+
+  /**
+   * Constructs an AccessBatch_s object.
+   *
+   * @param c A maximum number of access records the batch can hold.
+   */
+  AccessBatch_s(UINT32 c) : records(NULL), count(0), capacity(c),
+    memory(new char[c * sizeof(ACCESS_RECORD) + CACHE_LINE_SIZE])
+  { // Do not let the records of different threads share a cache line
+    records = reinterpret_cast< ACCESS_RECORD* >(
+      (reinterpret_cast< ADDRINT >(memory) + CACHE_LINE_SIZE - 1)
+      & ~static_cast< ADDRINT >(CACHE_LINE_SIZE - 1));
+  }
+
+  /**
+   * Destroys an AccessBatch_s object.
+   */
+  ~AccessBatch_s() { delete[] memory; }
+} AccessBatch;
+
 /**
  * @brief A structure containing traits information of callback functions.
  */
@@ -148,18 +309,24 @@ DEFINE_CALLBACK_TRAITS(READ, INVALID);
 DEFINE_CALLBACK_TRAITS(READ, A);
 DEFINE_CALLBACK_TRAITS(READ, AV);
 DEFINE_CALLBACK_TRAITS(READ, AVL);
+DEFINE_CALLBACK_TRAITS(READ, AO);
+DEFINE_CALLBACK_TRAITS(READ, AIO);
 DEFINE_CALLBACK_TRAITS(READ, AVO);
 DEFINE_CALLBACK_TRAITS(READ, AVIO);
 DEFINE_CALLBACK_TRAITS(WRITE, INVALID);
 DEFINE_CALLBACK_TRAITS(WRITE, A);
 DEFINE_CALLBACK_TRAITS(WRITE, AV);
 DEFINE_CALLBACK_TRAITS(WRITE, AVL);
+DEFINE_CALLBACK_TRAITS(WRITE, AO);
+DEFINE_CALLBACK_TRAITS(WRITE, AIO);
 DEFINE_CALLBACK_TRAITS(WRITE, AVO);
 DEFINE_CALLBACK_TRAITS(WRITE, AVIO);
 DEFINE_CALLBACK_TRAITS(UPDATE, INVALID);
 DEFINE_CALLBACK_TRAITS(UPDATE, A);
 DEFINE_CALLBACK_TRAITS(UPDATE, AV);
 DEFINE_CALLBACK_TRAITS(UPDATE, AVL);
+DEFINE_CALLBACK_TRAITS(UPDATE, AO);
+DEFINE_CALLBACK_TRAITS(UPDATE, AIO);
 DEFINE_CALLBACK_TRAITS(UPDATE, AVO);
 DEFINE_CALLBACK_TRAITS(UPDATE, AVIO);
 
@@ -193,6 +360,16 @@ VOID deleteRepExecutedFlag(void* repExecutedFlag)
   delete[] static_cast< BOOL* >(repExecutedFlag);
 }
 
+/**
+ * Deletes a batch of memory accesses created during thread start.
+ *
+ * @param accessBatch A batch of memory accesses.
+ */
+VOID deleteAccessBatch(void* accessBatch)
+{
+  delete static_cast< AccessBatch* >(accessBatch);
+}
+
 /**
  * Gets an object holding private data of a thread.
  *
@@ -202,7 +379,7 @@ VOID deleteRepExecutedFlag(void* repExecutedFlag)
 inline
 ThreadData* getThreadData(THREADID tid)
 {
-  return static_cast< ThreadData* >(PIN_GetThreadData(g_threadDataTlsKey, tid));
+  return static_cast< ThreadData* >(TLS_GetThreadData(g_threadDataTlsKey, tid));
 }
 
 /**
@@ -214,7 +391,7 @@ ThreadData* getThreadData(THREADID tid)
 inline
 MemoryAccess* getLastMemoryAccesses(THREADID tid)
 {
-  return static_cast< MemoryAccess* >(PIN_GetThreadData(g_memoryAccessesTlsKey,
+  return static_cast< MemoryAccess* >(TLS_GetThreadData(g_memoryAccessesTlsKey,
     tid));
 }
 
@@ -227,7 +404,20 @@ MemoryAccess* getLastMemoryAccesses(THREADID tid)
 inline
 BOOL* getRepExecutedFlag(THREADID tid)
 {
-  return static_cast< BOOL* >(PIN_GetThreadData(g_repExecutedFlagTlsKey, tid));
+  return static_cast< BOOL* >(TLS_GetThreadData(g_repExecutedFlagTlsKey, tid));
+}
+
+/**
+ * Gets a batch of memory accesses performed by a thread.
+ *
+ * @param tid A number identifying the thread.
+ * @return A batch of memory accesses performed by the thread.
+ */
+inline
+AccessBatch* getAccessBatch(THREADID tid)
+{
+  return static_cast< AccessBatch* >(TLS_GetThreadData(g_accessBatchTlsKey,
+    tid));
 }
 
 /**
@@ -255,6 +445,39 @@ void getVariable(ADDRINT rtnAddr, ADDRINT insAddr, ADDRINT accessedAddr,
     variable.name, variable.type, &variable.offset); /* output */
 }
 
+/**
+ * Stores a memory access to a batch which will be delivered to all callback
+ *   functions registered by a user to process memory accesses in bulk.
+ *
+ * @note This function is called before an instruction accesses a memory.
+ *
+ * @tparam AT A type of the access (read, write, atomic update, etc.).
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @param addr An address of the data accessed.
+ * @param memAccInfo A structure containing static (non-changing) information
+ *   about the access.
+ */
+template < AccessType AT >
+VOID PIN_FAST_ANALYSIS_CALL recordMemoryAccess(THREADID tid, ADDRINT addr,
+  MemoryAccessInfo* memAccInfo)
+{
+  AccessBatch* batch = getAccessBatch(tid);
+
+  // Append the access to the batch, the batch is never full at this point
+  ACCESS_RECORD& record = batch->records[batch->count];
+
+  record.addr = addr;
+  record.ins = memAccInfo->instruction->address;
+  record.tid = tid;
+  record.size = memAccInfo->size;
+  record.type = (AT == READ) ? ART_READ : (AT == WRITE) ? ART_WRITE : ART_UPDATE;
+  record.index = memAccInfo->index;
+
+  // Deliver the accesses as soon as there is no space left for the next one
+  if (++batch->count == batch->capacity) flushAccessBatch(tid);
+}
+
 /**
  * Calls all callback functions registered by a user to be called before
  *   accessing a memory.
@@ -267,7 +490,8 @@ void getVariable(ADDRINT rtnAddr, ADDRINT insAddr, ADDRINT accessedAddr,
  *
  * @param tid A number identifying the thread which performed the access.
  * @param addr An address of the data accessed.
- * @param registers A structure containing register values.
+ * @param registers A structure containing register values or @em NULL if no
+ *   registered callback function needs information extracted from them.
  * @param memAccInfo A structure containing static (non-changing) information
  *   about the access.
  */
@@ -314,19 +538,23 @@ VOID PIN_FAST_ANALYSIS_CALL beforeMemoryAccess(THREADID tid, ADDRINT addr,
   if (AI & AI_LOCATION)
   { // Extract location information if it has not been cached yet
     if (memAccInfo->instruction->location == NULL)
-    { // No location cached, create an empty location object
-      memAccInfo->instruction->location = new LOCATION();
+    { // No location cached, helper variables for extracting the location
+      INT32 line = -1;
+      std::string file;
 
       // Analysis functions need to get the client lock for extracting locations
       PIN_LockClient();
 
       // Get the source code location where the memory access originates from
-      PIN_GetSourceLocation(memAccInfo->instruction->address, NULL,
-        &memAccInfo->instruction->location->line,
-        &memAccInfo->instruction->location->file);
+      PIN_GetSourceLocation(memAccInfo->instruction->address, NULL, &line,
+        &file);
 
       // Do not hold the client lock longer that is absolutely necessary
       PIN_UnlockClient();
+
+      // Cache the location from the index, it shares the interned file path
+      memAccInfo->instruction->location = retrieveLocation(indexLocation(file,
+        line));
     }
   }
 
@@ -375,6 +603,45 @@ VOID PIN_FAST_ANALYSIS_CALL beforeMemoryAccess(THREADID tid, ADDRINT addr,
         memAccInfo->instruction->address, addr >= THREAD_DATA->splow);
     }
   }
+
+  if (IS_REGISTERED(CT_AIO))
+  { // Call all registered AIO-type callback functions
+    typedef callback_traits< AT, CT_AIO > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::before.begin();
+      it != Traits::before.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, addr, memAccInfo->size, memAccInfo->instruction->address,
+        addr >= THREAD_DATA->splow);
+    }
+  }
+
+  if (IS_REGISTERED(CT_AO))
+  { // Call all registered AO-type callback functions
+    typedef callback_traits< AT, CT_AO > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::before.begin();
+      it != Traits::before.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, addr, memAccInfo->size, addr >= THREAD_DATA->splow);
+    }
+  }
+
+  if (IS_REGISTERED(CT_A))
+  { // Call all registered A-type callback functions
+    typedef callback_traits< AT, CT_A > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::before.begin();
+      it != Traits::before.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, addr, memAccInfo->size);
+    }
+  }
+
+  if (AI & AI_BATCH)
+  { // Store the access for the batch consumers in the same analysis call
+    recordMemoryAccess< AT >(tid, addr, memAccInfo);
+  }
 }
 
 /**
@@ -389,7 +656,8 @@ VOID PIN_FAST_ANALYSIS_CALL beforeMemoryAccess(THREADID tid, ADDRINT addr,
  *
  * @param tid A number identifying the thread which performed the access.
  * @param addr An address of the data accessed.
- * @param registers A structure containing register values.
+ * @param registers A structure containing register values or @em NULL if no
+ *   registered callback function needs information extracted from them.
  * @param isExecuting @em True if the REP instruction will be executed, @em
  *   false otherwise.
  * @param memAccInfo A structure containing static (non-changing) information
@@ -488,6 +756,41 @@ VOID PIN_FAST_ANALYSIS_CALL afterMemoryAccess(THREADID tid,
     }
   }
 
+  if (IS_REGISTERED(CT_AIO))
+  { // Call all registered AIO-type callback functions
+    typedef callback_traits< AT, CT_AIO > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::after.begin();
+      it != Traits::after.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, memAcc.addr, memAccInfo->size,
+        memAccInfo->instruction->address, memAcc.addr >= THREAD_DATA->splow);
+    }
+  }
+
+  if (IS_REGISTERED(CT_AO))
+  { // Call all registered AO-type callback functions
+    typedef callback_traits< AT, CT_AO > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::after.begin();
+      it != Traits::after.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, memAcc.addr, memAccInfo->size,
+        memAcc.addr >= THREAD_DATA->splow);
+    }
+  }
+
+  if (IS_REGISTERED(CT_A))
+  { // Call all registered A-type callback functions
+    typedef callback_traits< AT, CT_A > Traits;
+
+    for (typename Traits::container_type::iterator it = Traits::after.begin();
+      it != Traits::after.end(); it++)
+    { // Call all callback functions registered by the user (used analyser)
+      (*it)(tid, memAcc.addr, memAccInfo->size);
+    }
+  }
+
   // Clear the information about the memory access
   memAcc = MemoryAccess();
 }
@@ -520,6 +823,258 @@ VOID PIN_FAST_ANALYSIS_CALL afterRepMemoryAccess(THREADID tid,
   }
 }
 
+/**
+ * Stores a memory access to a batch which will be delivered to all callback
+ *   functions registered by a user to process memory accesses in bulk.
+ *
+ * @note This function is called before a REP instruction accesses a memory.
+ *
+ * @tparam AT A type of the access (read, write, atomic update, etc.).
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @param addr An address of the data accessed.
+ * @param isExecuting @em True if the REP instruction will be executed, @em
+ *   false otherwise.
+ * @param memAccInfo A structure containing static (non-changing) information
+ *   about the access.
+ */
+template < AccessType AT >
+VOID PIN_FAST_ANALYSIS_CALL recordRepMemoryAccess(THREADID tid, ADDRINT addr,
+  BOOL isExecuting, MemoryAccessInfo* memAccInfo)
+{
+  if (isExecuting)
+  { // Record the access only if the instruction will be executed
+    recordMemoryAccess< AT >(tid, addr, memAccInfo);
+  }
+}
+
+/**
+ * Stores an address accessed by a memory access performed in a basic block.
+ *   The access is stored to a batch later, together with all other accesses
+ *   performed in the basic block.
+ *
+ * @note This function is called before an instruction accesses a memory. It
+ *   does not call any other function, so PIN can inline it.
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @param addr An address of the data accessed.
+ * @param slot An index of the access among the accesses performed in the basic
+ *   block.
+ */
+VOID PIN_FAST_ANALYSIS_CALL storeBlockAccess(THREADID tid, ADDRINT addr,
+  UINT32 slot)
+{
+  g_blockAddresses[tid].addr[slot] = addr;
+}
+
+/**
+ * Stores all memory accesses performed in a basic block to a batch which will
+ *   be delivered to all callback functions registered by a user to process
+ *   memory accesses in bulk.
+ *
+ * @note This function is called before the last instruction of a basic block
+ *   is executed. Basic blocks end with calls, so the accesses are stored
+ *   before any synchronisation function is called.
+ *
+ * @param tid A number identifying the thread which performed the accesses.
+ * @param block A structure containing static (non-changing) information about
+ *   the accesses performed in the basic block.
+ */
+VOID PIN_FAST_ANALYSIS_CALL recordBlockAccesses(THREADID tid,
+  BlockAccessInfo* block)
+{
+  // Helper variables
+  AccessBatch* batch = getAccessBatch(tid);
+  const ADDRINT* addrs = g_blockAddresses[tid].addr;
+
+  for (UINT32 i = 0; i < block->count; i++)
+  { // Append the accesses to the batch in the order they were performed
+    ACCESS_RECORD& record = batch->records[batch->count];
+
+    record.addr = addrs[i];
+    record.ins = block->accesses[i]->instruction->address;
+    record.tid = tid;
+    record.size = block->accesses[i]->size;
+    record.type = block->types[i];
+    record.index = block->accesses[i]->index;
+
+    // Deliver the accesses as soon as there is no space left for the next one
+    if (++batch->count == batch->capacity) flushAccessBatch(tid);
+  }
+}
+
+/**
+ * Delivers all memory accesses stored in a batch of a thread to all callback
+ *   functions registered by a user to process memory accesses in bulk.
+ *
+ * @note This function is called when the batch is full and before the thread
+ *   performs a synchronisation operation, enters or exits a function or when
+ *   the thread finishes.
+ *
+ * @param tid A number identifying the thread.
+ */
+VOID flushAccessBatch(THREADID tid)
+{
+  // No batches are created if nobody is interested in them
+  if (g_batchConsumers.empty()) return;
+
+  AccessBatch* batch = getAccessBatch(tid);
+
+  if (batch->count == 0) return; // Nothing to deliver
+
+  for (BatchConsumerContainerType::iterator it = g_batchConsumers.begin();
+    it != g_batchConsumers.end(); it++)
+  { // Call all callback functions registered by the user (used analyser)
+    (*it)(tid, batch->records, batch->count);
+  }
+
+  batch->count = 0; // The batch may be reused now
+}
+
+/**
+ * Checks if a memory at a specific address can be written to.
+ *
+ * @note This function is called before an instruction accesses a memory and
+ *   decides if the analysis functions for the access should be called.
+ *
+ * @param addr An address of the memory.
+ * @return A non-zero value if the memory can be written to, zero otherwise.
+ */
+ADDRINT PIN_FAST_ANALYSIS_CALL isWritableMemory(ADDRINT addr)
+{
+  return !isReadOnlyMemory(addr);
+}
+
+/**
+ * Checks if a memory access should be monitored, i.e., if the function which
+ *   performs the memory access is sampled.
+ *
+ * @note This function is called before an instruction accesses a memory and
+ *   decides if the analysis functions for the access should be called.
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @return A non-zero value if the memory access should be monitored, zero
+ *   otherwise.
+ */
+ADDRINT PIN_FAST_ANALYSIS_CALL isSampledMemoryAccess(THREADID tid)
+{
+  return THREAD_DATA->sampled;
+}
+
+/**
+ * Checks if a memory access should be monitored, i.e., if the function which
+ *   performs the memory access is sampled and the memory at a specific address
+ *   can be written to.
+ *
+ * @note This function is called before an instruction accesses a memory and
+ *   decides if the analysis functions for the access should be called.
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @param addr An address of the memory.
+ * @return A non-zero value if the memory access should be monitored, zero
+ *   otherwise.
+ */
+ADDRINT PIN_FAST_ANALYSIS_CALL isSampledWritableMemoryAccess(THREADID tid,
+  ADDRINT addr)
+{
+  return THREAD_DATA->sampled && !isReadOnlyMemory(addr);
+}
+
+/**
+ * Restores the sampling decision made for a function whose stack frame lies at
+ *   or above a specific address, i.e., removes the decisions of all functions
+ *   whose frames lie below it. These functions have either already returned or
+ *   were left without returning (e.g., by a tail call, a long jump or when an
+ *   exception was thrown).
+ *
+ * @param td A structure holding private data of a thread.
+ * @param sp A value of the stack pointer register.
+ */
+inline
+VOID unwindSampledStack(ThreadData* td, ADDRINT sp)
+{
+  while (!td->sampledStack.empty() && td->sampledStack.back().sp < sp)
+  { // The stack grows downwards, these frames are no longer on the stack
+    td->sampled = td->sampledStack.back().sampled;
+    td->sampledStack.pop_back();
+  }
+}
+
+/**
+ * Decides if the memory accesses performed by a function should be monitored.
+ *
+ * @note This function is called immediately before a thread executes the first
+ *   instruction of a function.
+ *
+ * @param tid A number identifying the thread executing the function.
+ * @param sp A value of the stack pointer register.
+ * @param idx An index of the function.
+ */
+VOID PIN_FAST_ANALYSIS_CALL beforeSampledFunctionExecuted(THREADID tid,
+  ADDRINT sp, ADDRINT idx)
+{
+  ThreadData* td = THREAD_DATA;
+
+  // The function is executed for the first time, create a counter for it
+  if (idx >= td->counters.size()) td->counters.resize(idx + 1);
+
+  // Forget the decisions of functions which were left without returning
+  unwindSampledStack(td, sp);
+
+  if (td->sampledStack.empty() || td->sampledStack.back().sp != sp)
+  { // Restore the decision made for the current function when the callee
+    // returns, in case of a tail call, the frame (and the decision which will
+    // be restored when the callee returns) belongs to the original caller
+    td->sampledStack.push_back(SampledFrame(sp, td->sampled));
+  }
+
+  td->sampled = td->counters[idx].sample();
+}
+
+/**
+ * Restores the sampling decision made for a function to which a thread is
+ *   returning.
+ *
+ * @note This function is called immediately before a \c RETURN instruction is
+ *   executed.
+ *
+ * @param tid A number identifying the thread.
+ * @param sp A value of the stack pointer register.
+ */
+VOID PIN_FAST_ANALYSIS_CALL beforeSampledFunctionReturned(THREADID tid,
+  ADDRINT sp)
+{
+  ThreadData* td = THREAD_DATA;
+
+  // Forget the decisions of functions which were left without returning
+  unwindSampledStack(td, sp);
+
+  // Returning from a function whose execution we did not see, ignore it
+  if (td->sampledStack.empty() || td->sampledStack.back().sp != sp) return;
+
+  td->sampled = td->sampledStack.back().sampled;
+  td->sampledStack.pop_back();
+}
+
+/**
+ * Checks if a memory access is being monitored, i.e., if the callback functions
+ *   called before the memory access were executed.
+ *
+ * @note This function is called after an instruction accesses a memory and
+ *   decides if the analysis functions for the access should be called.
+ *
+ * @param tid A number identifying the thread which performed the access.
+ * @param memAccInfo A structure containing static (non-changing) information
+ *   about the access.
+ * @return A non-zero value if the memory access is being monitored, zero
+ *   otherwise.
+ */
+ADDRINT PIN_FAST_ANALYSIS_CALL isMemoryAccessMonitored(THREADID tid,
+  MemoryAccessInfo* memAccInfo)
+{
+  return getLastMemoryAccesses(tid)[memAccInfo->index].memAccInfo != NULL;
+}
+
 /**
  * Initialises TLS (thread local storage) data for a thread.
  *
@@ -531,24 +1086,104 @@ VOID PIN_FAST_ANALYSIS_CALL afterRepMemoryAccess(THREADID tid,
 VOID initMemoryAccessTls(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v)
 {
   // Allocate memory for storing private data of the starting thread
-  PIN_SetThreadData(g_threadDataTlsKey, new ThreadData(), tid);
+  TLS_SetThreadData(g_threadDataTlsKey, new ThreadData(), tid);
+
+  // There can only be two simultaneous memory accesses at one time, because no
+  // Intel instruction have more that 2 memory accesses, this will suffice then
+  TLS_SetThreadData(g_memoryAccessesTlsKey, new MemoryAccess[2], tid);
+
+  // After callback functions do not know if REP instructions were executed and
+  // they may perform 2 memory accesses (i.e. there may be 1 or 2 before calls)
+  TLS_SetThreadData(g_repExecutedFlagTlsKey, new BOOL[2], tid);
+
+  // Memory accesses are buffered only if some analyser processes them in bulk
+  if (!g_batchConsumers.empty())
+    TLS_SetThreadData(g_accessBatchTlsKey, new AccessBatch(g_batchSize), tid);
+}
+
+/**
+ * Setups the memory access monitoring.
+ *
+ * @param settings An object containing the ANaConDA framework's settings.
+ */
+VOID setupAccessModule(Settings* settings)
+{
+  // A batch must be able to hold at least one memory access
+  g_batchSize = std::max(settings->get< int >("access.batch-size"), 1);
+
+  // Load the settings of the adaptive sampling of memory accesses
+  g_sampling.enabled = settings->get< bool >("sampling.enabled");
+  g_sampling.initialRate = std::min(std::max(
+    settings->get< int >("sampling.initial-rate"), 1), 1000);
+  g_sampling.minimumRate = std::min(std::max(
+    settings->get< int >("sampling.minimum-rate"), 1), 1000);
+  g_sampling.backoff = std::max(settings->get< int >("sampling.backoff"), 1);
+  g_sampling.burst = std::max(settings->get< int >("sampling.burst"), 1);
+}
+
+/**
+ * Registers a range of memory which cannot be written to.
+ *
+ * @note This function is called at instrumentation time when an image is
+ *   loaded. The analysis functions may search the ranges at the same time,
+ *   so a new list of ranges is created and published instead of updating the
+ *   current list. The old list is never freed as some thread might still be
+ *   using it, but images are not loaded often, so it does not matter much.
+ *
+ * @param low The lowest address in the range.
+ * @param high The first address after the range.
+ */
+VOID registerReadOnlyMemory(ADDRINT low, ADDRINT high)
+{
+  if (low >= high) return; // Empty range, nothing to register
+
+  MemoryRangeList* ranges = new MemoryRangeList(*g_readOnlyMemory.load());
+
+  // Keep the ranges sorted, the analysis functions use binary search on them
+  ranges->insert(std::upper_bound(ranges->begin(), ranges->end(),
+    MemoryRange(low, high)), MemoryRange(low, high));
+
+  g_readOnlyMemory.store(ranges, std::memory_order_release);
+}
+
+/**
+ * Unregisters all ranges of memory which cannot be written to lying in a range
+ *   of memory which is being freed (e.g., when an image is unloaded).
+ *
+ * @param low The lowest address of the memory being freed.
+ * @param high The first address after the memory being freed.
+ */
+VOID unregisterReadOnlyMemory(ADDRINT low, ADDRINT high)
+{
+  MemoryRangeList* ranges = new MemoryRangeList();
 
-  // There can only be two simultaneous memory accesses at one time, because no
-  // Intel instruction have more that 2 memory accesses, this will suffice then
-  PIN_SetThreadData(g_memoryAccessesTlsKey, new MemoryAccess[2], tid);
+  BOOST_FOREACH(const MemoryRange& range, *g_readOnlyMemory.load())
+  { // Keep only ranges outside of the memory being freed
+    if (range.high <= low || range.low >= high) ranges->push_back(range);
+  }
 
-  // After callback functions do not know if REP instructions were executed and
-  // they may perform 2 memory accesses (i.e. there may be 1 or 2 before calls)
-  PIN_SetThreadData(g_repExecutedFlagTlsKey, new BOOL[2], tid);
+  g_readOnlyMemory.store(ranges, std::memory_order_release);
 }
 
 /**
- * Setups the synchronisation coverage monitoring.
+ * Checks if a memory at a specific address cannot be written to.
  *
- * @param settings An object containing the ANaConDA framework's settings.
+ * @param addr An address of the memory.
+ * @return @em True if the memory at the address cannot be written to, @em false
+ *   otherwise.
  */
-VOID setupAccessModule(Settings* settings)
+BOOL isReadOnlyMemory(ADDRINT addr)
 {
+  const MemoryRangeList* ranges = g_readOnlyMemory.load(
+    std::memory_order_acquire);
+
+  // Find the first range which starts after the address
+  MemoryRangeList::const_iterator it = std::upper_bound(ranges->begin(),
+    ranges->end(), MemoryRange(addr, addr));
+
+  if (it == ranges->begin()) return false; // No range starts before the address
+
+  return addr < (--it)->high; // Check the last range starting before it
 }
 
 namespace detail
@@ -730,7 +1365,10 @@ template < AccessType AT, CallbackType... Supported >
 inline
 VOID setupBeforeCallbacks(MemoryAccessSettings& mas)
 {
-  detail::setupBeforeCallbacks< AT, AI_NONE, Supported..., CT_INVALID >(mas);
+  if (g_batchConsumers.empty())
+    detail::setupBeforeCallbacks< AT, AI_NONE, Supported..., CT_INVALID >(mas);
+  else // The functions called before accesses store them for batch consumers
+    detail::setupBeforeCallbacks< AT, AI_BATCH, Supported..., CT_INVALID >(mas);
 }
 
 /**
@@ -750,6 +1388,71 @@ VOID setupAfterCallbacks(MemoryAccessSettings& mas)
   detail::setupAfterCallbacks< AT, AI_NONE, Supported..., CT_INVALID >(mas);
 }
 
+/**
+ * Checks if some callback function needs to be notified about accesses to local
+ *   variables.
+ *
+ * @note Callback functions which are told if the accessed memory lies on the
+ *   stack are expected to filter the local accesses on their own. All other
+ *   callback functions might need to be notified about them.
+ *
+ * @tparam AT A type of the access (read, write, atomic update, etc.).
+ *
+ * @return @em True if some callback function needs to be notified about local
+ *   accesses, @em false otherwise.
+ */
+template < AccessType AT >
+inline
+bool needsLocalAccesses()
+{
+  return !callback_traits< AT, CT_A >::before.empty()
+    || !callback_traits< AT, CT_A >::after.empty()
+    || !callback_traits< AT, CT_AV >::before.empty()
+    || !callback_traits< AT, CT_AV >::after.empty()
+    || !callback_traits< AT, CT_AVL >::before.empty()
+    || !callback_traits< AT, CT_AVL >::after.empty()
+    || !g_batchConsumers.empty();
+}
+
+/**
+ * Removes the functions called before and after memory accesses if no callback
+ *   function needs to be called before or after the accesses.
+ *
+ * @note If some batch consumer is registered, the accesses are stored for it
+ *   by a function called before the accesses. If the function called before
+ *   the accesses is removed, a function storing the accesses is used instead.
+ *
+ * @tparam AT A type of the access (read, write, atomic update, etc.).
+ *
+ * @param mas An object containing memory access instrumentation settings.
+ */
+template < AccessType AT >
+inline
+VOID removeUnusedCallbacks(MemoryAccessSettings& mas)
+{
+  // Helper variables
+  MemoryAccessInstrumentationSettings& access = detail::section< AT >(mas);
+
+  if ((access.beforeAccessInfo & ~AI_BATCH) != AI_NONE
+    || access.afterAccessInfo != AI_NONE)
+  { // The function called after the access clears what the one called before
+    // the access stored, so both of them are needed if any of them is needed
+    return;
+  }
+
+  access.beforeAccess = NULL;
+  access.beforeRepAccess = NULL;
+  access.afterAccess = NULL;
+  access.afterRepAccess = NULL;
+  access.beforeAccessInfo = AI_NONE;
+
+  if (!g_batchConsumers.empty())
+  { // Setup functions which will store the accesses for the batch consumers
+    access.recordAccess = (AFUNPTR)recordMemoryAccess< AT >;
+    access.recordRepAccess = (AFUNPTR)recordRepMemoryAccess< AT >;
+  }
+}
+
 /**
  * Setups memory access callback functions and their types.
  *
@@ -758,27 +1461,60 @@ VOID setupAfterCallbacks(MemoryAccessSettings& mas)
 VOID setupMemoryAccessSettings(MemoryAccessSettings& mas)
 {
   // Setup callback functions which will be called before reads
-  setupBeforeCallbacks< READ, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupBeforeCallbacks< READ, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
 
   // Setup callback functions which will be called before writes
-  setupBeforeCallbacks< WRITE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupBeforeCallbacks< WRITE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
 
   // Setup callback functions which will be called before updates
-  setupBeforeCallbacks< UPDATE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupBeforeCallbacks< UPDATE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
 
   // Setup callback functions which will be called after reads
-  setupAfterCallbacks< READ, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupAfterCallbacks< READ, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
 
   // Setup callback functions which will be called after writes
-  setupAfterCallbacks< WRITE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupAfterCallbacks< WRITE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
 
   // Setup callback functions which will be called after updates
-  setupAfterCallbacks< UPDATE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_A >(mas);
+  setupAfterCallbacks< UPDATE, CT_AVIO, CT_AVO, CT_AVL, CT_AV, CT_AIO, CT_AO, CT_A >(mas);
+
+  // Do not call any function before and after accesses if not necessary
+  removeUnusedCallbacks< READ >(mas);
+  removeUnusedCallbacks< WRITE >(mas);
+  removeUnusedCallbacks< UPDATE >(mas);
+
+  // Check if local accesses can be left out when skipping stack accesses
+  mas.reads.localAccesses = needsLocalAccesses< READ >();
+  mas.writes.localAccesses = needsLocalAccesses< WRITE >();
+  mas.updates.localAccesses = needsLocalAccesses< UPDATE >();
+
+  // Sample the accesses only if both the user and the analyser agree with it
+  mas.sampling = g_sampling.enabled && g_sampling.allowed;
 
   // If no information is needed, there is no need to instrument the accesses
   mas.instrument = mas.reads.beforeAccessInfo | mas.reads.afterAccessInfo
                  | mas.writes.beforeAccessInfo | mas.writes.afterAccessInfo
                  | mas.updates.beforeAccessInfo | mas.updates.afterAccessInfo;
+
+  // Accesses stored for the batch consumers need to be instrumented too
+  mas.instrument = mas.instrument || mas.reads.recordAccess != NULL
+    || mas.writes.recordAccess != NULL || mas.updates.recordAccess != NULL;
+}
+
+/**
+ * Registers a callback function which will be called before reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called before reading
+ *   from a memory.
+ */
+VOID ACCESS_BeforeMemoryRead(MEMREADAFUNPTR callback)
+{
+  callback_traits< READ, CT_A >::before.push_back(callback);
 }
 
 /**
@@ -805,6 +1541,38 @@ VOID ACCESS_BeforeMemoryRead(MEMREADAVLFUNPTR callback)
   callback_traits< READ, CT_AVL >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called before reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before reading
+ *   from a memory.
+ */
+VOID ACCESS_BeforeMemoryRead(MEMREADAOFUNPTR callback)
+{
+  callback_traits< READ, CT_AO >::before.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called before reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before reading
+ *   from a memory.
+ */
+VOID ACCESS_BeforeMemoryRead(MEMREADAIOFUNPTR callback)
+{
+  callback_traits< READ, CT_AIO >::before.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called before reading from a
  *   memory.
@@ -829,6 +1597,22 @@ VOID ACCESS_BeforeMemoryRead(MEMREADAVIOFUNPTR callback)
   callback_traits< READ, CT_AVIO >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called before writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called before writing to
+ *   a memory.
+ */
+VOID ACCESS_BeforeMemoryWrite(MEMWRITEAFUNPTR callback)
+{
+  callback_traits< WRITE, CT_A >::before.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called before writing to a
  *   memory.
@@ -853,6 +1637,38 @@ VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVLFUNPTR callback)
   callback_traits< WRITE, CT_AVL >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called before writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before writing to
+ *   a memory.
+ */
+VOID ACCESS_BeforeMemoryWrite(MEMWRITEAOFUNPTR callback)
+{
+  callback_traits< WRITE, CT_AO >::before.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called before writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before writing to
+ *   a memory.
+ */
+VOID ACCESS_BeforeMemoryWrite(MEMWRITEAIOFUNPTR callback)
+{
+  callback_traits< WRITE, CT_AIO >::before.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called before writing to a
  *   memory.
@@ -877,6 +1693,22 @@ VOID ACCESS_BeforeMemoryWrite(MEMWRITEAVIOFUNPTR callback)
   callback_traits< WRITE, CT_AVIO >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called before atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called before atomically
+ *   updating a memory.
+ */
+VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_A >::before.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called before atomically updating
  *   a memory.
@@ -901,6 +1733,38 @@ VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVLFUNPTR callback)
   callback_traits< UPDATE, CT_AVL >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called before atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before atomically
+ *   updating a memory.
+ */
+VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAOFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_AO >::before.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called before atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called before atomically
+ *   updating a memory.
+ */
+VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAIOFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_AIO >::before.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called before atomically updating
  *   a memory.
@@ -925,6 +1789,22 @@ VOID ACCESS_BeforeAtomicUpdate(MEMUPDATEAVIOFUNPTR callback)
   callback_traits< UPDATE, CT_AVIO >::before.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called after reading
+ *   from a memory.
+ */
+VOID ACCESS_AfterMemoryRead(MEMREADAFUNPTR callback)
+{
+  callback_traits< READ, CT_A >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after reading from a
  *   memory.
@@ -949,6 +1829,38 @@ VOID ACCESS_AfterMemoryRead(MEMREADAVLFUNPTR callback)
   callback_traits< READ, CT_AVL >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after reading
+ *   from a memory.
+ */
+VOID ACCESS_AfterMemoryRead(MEMREADAOFUNPTR callback)
+{
+  callback_traits< READ, CT_AO >::after.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called after reading from a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after reading
+ *   from a memory.
+ */
+VOID ACCESS_AfterMemoryRead(MEMREADAIOFUNPTR callback)
+{
+  callback_traits< READ, CT_AIO >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after reading from a
  *   memory.
@@ -973,6 +1885,22 @@ VOID ACCESS_AfterMemoryRead(MEMREADAVIOFUNPTR callback)
   callback_traits< READ, CT_AVIO >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called after writing to
+ *   a memory.
+ */
+VOID ACCESS_AfterMemoryWrite(MEMWRITEAFUNPTR callback)
+{
+  callback_traits< WRITE, CT_A >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after writing to a
  *   memory.
@@ -997,6 +1925,38 @@ VOID ACCESS_AfterMemoryWrite(MEMWRITEAVLFUNPTR callback)
   callback_traits< WRITE, CT_AVL >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after writing to
+ *   a memory.
+ */
+VOID ACCESS_AfterMemoryWrite(MEMWRITEAOFUNPTR callback)
+{
+  callback_traits< WRITE, CT_AO >::after.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called after writing to a
+ *   memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after writing to
+ *   a memory.
+ */
+VOID ACCESS_AfterMemoryWrite(MEMWRITEAIOFUNPTR callback)
+{
+  callback_traits< WRITE, CT_AIO >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after writing to a
  *   memory.
@@ -1021,6 +1981,22 @@ VOID ACCESS_AfterMemoryWrite(MEMWRITEAVIOFUNPTR callback)
   callback_traits< WRITE, CT_AVIO >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type get only the basic information about
+ *   the access, so no register values need to be captured and no debugging
+ *   information needs to be searched when the access is performed.
+ *
+ * @param callback A callback function which should be called after atomically
+ *   updating a memory.
+ */
+VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_A >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after atomically updating
  *   a memory.
@@ -1045,6 +2021,38 @@ VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVLFUNPTR callback)
   callback_traits< UPDATE, CT_AVL >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called after atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after atomically
+ *   updating a memory.
+ */
+VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAOFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_AO >::after.push_back(callback);
+}
+
+/**
+ * Registers a callback function which will be called after atomically updating
+ *   a memory.
+ *
+ * @note Callback functions of this type are told if the accessed memory lies
+ *   on the stack, but no debugging information needs to be searched when the
+ *   access is performed.
+ *
+ * @param callback A callback function which should be called after atomically
+ *   updating a memory.
+ */
+VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAIOFUNPTR callback)
+{
+  callback_traits< UPDATE, CT_AIO >::after.push_back(callback);
+}
+
 /**
  * Registers a callback function which will be called after atomically updating
  *   a memory.
@@ -1069,23 +2077,64 @@ VOID ACCESS_AfterAtomicUpdate(MEMUPDATEAVIOFUNPTR callback)
   callback_traits< UPDATE, CT_AVIO >::after.push_back(callback);
 }
 
+/**
+ * Registers a callback function which will be called with batches of memory
+ *   accesses performed by a thread.
+ *
+ * @note Unlike the other callback functions, this callback function is not
+ *   called synchronously with the memory accesses. The memory accesses are
+ *   stored to a per-thread buffer which is delivered to the callback function
+ *   when it is full and before a thread performs a synchronisation operation,
+ *   enters or exits a function or finishes its execution.
+ *
+ * @param callback A callback function which should be called with batches of
+ *   memory accesses.
+ */
+VOID ACCESS_RegisterBatchConsumer(MEMBATCHFUNPTR callback)
+{
+  g_batchConsumers.push_back(callback);
+}
+
+/**
+ * Allows the framework to monitor only a sample of memory accesses.
+ *
+ * @note Analysers which can tolerate missing some memory accesses (e.g., race
+ *   detectors) may call this function to opt in to the adaptive sampling of
+ *   memory accesses. The sampling is then used if enabled in the settings.
+ *   Synchronisation operations are never sampled.
+ */
+VOID ACCESS_AllowSampling()
+{
+  g_sampling.allowed = true;
+}
+
 /**
  * Gets a location in the source code corresponding to an instruction accessing
  *   a memory.
  *
+ * @note The location is stored in the location index, so the reference stays
+ *   valid until the end of the program.
+ *
  * @param ins An address of an instruction performing a memory access.
- * @param location A source code location corresponding to the instruction
- *   accessing a memory.
+ * @return A source code location corresponding to the instruction accessing a
+ *   memory.
  */
-VOID ACCESS_GetLocation(ADDRINT ins, LOCATION& location)
-{ // Analysis functions need to get the client lock before accessing locations
+const LOCATION& ACCESS_GetLocation(ADDRINT ins)
+{
+  // Helper variables
+  INT32 line = -1;
+  std::string file;
+
+  // Analysis functions need to get the client lock before accessing locations
   PIN_LockClient();
 
   // Get the source code location where the memory access originates from
-  PIN_GetSourceLocation(ins, NULL, &location.line, &location.file);
+  PIN_GetSourceLocation(ins, NULL, &line, &file);
 
   // Do not hold the client lock longer that is absolutely necessary
   PIN_UnlockClient();
+
+  return *retrieveLocation(indexLocation(file, line));
 }
 
 /** End of file access.cpp **/
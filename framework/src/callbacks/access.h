@@ -26,17 +26,22 @@
  * @file      access.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-19
- * @date      Last Update 2019-06-10
- * @version   0.11
+ * @date      Last Update 2026-10-16
+ * @version   0.15.7
  */
 
 #ifndef __PINTOOL_ANACONDA__CALLBACKS__ACCESS_H__
   #define __PINTOOL_ANACONDA__CALLBACKS__ACCESS_H__
 
+#include <vector>
+
 #include "pin.H"
 
 #include "../settings.h"
 
+// A maximum number of accesses in a basic block recorded by a single call
+#define BLOCK_MAX_ACCESSES 32
+
 /**
  * @brief An enumeration describing the information which might be requested by
  *   the callback functions registered to be called when a memory is accessed.
@@ -74,7 +79,12 @@ typedef enum AccessInfo_e
    *   the memory reserved for a stack. This flag can be used to distinguish
    *   between local and global memory accesses.
    */
-  AI_ON_STACK    = 0x0010
+  AI_ON_STACK    = 0x0010,
+  /**
+   * @brief Not an information, but a request to store the memory access for
+   *   the batch consumers. Used only internally by the framework.
+   */
+  AI_BATCH       = 0x0020
 } AccessInfo;
 
 /**
@@ -107,6 +117,17 @@ typedef enum CallbackType_e
    *   about the location of the access.
    */
   CT_AVO = AI_ACCESS | AI_VARIABLE | AI_ON_STACK,
+  /**
+   * @brief A callback function providing address of the memory accessed and
+   *   information about the location of the access.
+   */
+  CT_AO = AI_ACCESS | AI_ON_STACK,
+  /**
+   * @brief A callback function providing address of the memory accessed,
+   *   address of the instruction which accessed the memory and information
+   *   about the location of the access.
+   */
+  CT_AIO = AI_ACCESS | AI_INSTRUCTION | AI_ON_STACK,
   /**
    * @brief A callback function providing address of the memory accessed,
    *   information about the variable residing at this address, address of the
@@ -134,6 +155,17 @@ typedef struct MemoryAccessInstrumentationSettings_s
    *   by an instruction with a REP prefix).
    */
   AFUNPTR afterRepAccess;
+  /**
+   * @brief A function storing a memory access to a per-thread buffer which is
+   *   delivered to the batch consumers later.
+   */
+  AFUNPTR recordAccess;
+  /**
+   * @brief A function storing a repeatable memory access (usually caused by an
+   *   instruction with a REP prefix) to a per-thread buffer which is delivered
+   *   to the batch consumers later.
+   */
+  AFUNPTR recordRepAccess;
   /**
    * @brief Information needed by the functions called before a memory access.
    */
@@ -142,6 +174,13 @@ typedef struct MemoryAccessInstrumentationSettings_s
    * @brief Information needed by the functions called after a memory access.
    */
   AccessInfo afterAccessInfo;
+  /**
+   * @brief A flag determining if some callback function needs to be notified
+   *   about accesses to local variables, i.e., if some callback function is
+   *   not told if the accessed memory lies on the stack and thus cannot filter
+   *   these accesses on its own.
+   */
+  bool localAccesses;
   /**
    * @brief A structure containing detailed information about a noise which
    *   should be inserted before a memory access.
@@ -153,7 +192,8 @@ typedef struct MemoryAccessInstrumentationSettings_s
    */
   MemoryAccessInstrumentationSettings_s() : beforeAccess(NULL),
     beforeRepAccess(NULL), afterAccess(NULL), afterRepAccess(NULL),
-    beforeAccessInfo(AI_NONE), afterAccessInfo(AI_NONE), noise(NULL) {}
+    recordAccess(NULL), recordRepAccess(NULL), beforeAccessInfo(AI_NONE),
+    afterAccessInfo(AI_NONE), localAccesses(false), noise(NULL) {}
 
   /**
    * Constructs a MemoryAccessInstrumentationSettings_s object.
@@ -163,7 +203,8 @@ typedef struct MemoryAccessInstrumentationSettings_s
    */
   MemoryAccessInstrumentationSettings_s(NoiseSettings* ns) : beforeAccess(NULL),
     beforeRepAccess(NULL), afterAccess(NULL), afterRepAccess(NULL),
-    beforeAccessInfo(AI_NONE), afterAccessInfo(AI_NONE), noise(ns) {}
+    recordAccess(NULL), recordRepAccess(NULL), beforeAccessInfo(AI_NONE),
+    afterAccessInfo(AI_NONE), localAccesses(false), noise(ns) {}
 } MemoryAccessInstrumentationSettings;
 
 /**
@@ -200,12 +241,29 @@ typedef struct MemoryAccessSettings_s
    * @brief A flag determining if monitoring predecessors is requested.
    */
   bool predecessors;
+  /**
+   * @brief A flag determining if accesses to the stack (addressed through the
+   *   stack or base pointer) should not be instrumented if no callback function
+   *   needs to be notified about accesses to local variables.
+   */
+  bool skipStackAccesses;
+  /**
+   * @brief A flag determining if accesses to read-only memory (e.g., sections
+   *   like @c .text or @c .rodata) should not be monitored.
+   */
+  bool skipReadOnlyAccesses;
+  /**
+   * @brief A flag determining if only the memory accesses performed by the
+   *   sampled executions of functions should be monitored.
+   */
+  bool sampling;
 
   /**
    * Constructs a MemoryAccessSettings_s object.
    */
   MemoryAccessSettings_s() : reads(), writes(), updates(),
-    instrument(false), sharedVars(false), predecessors(false) {}
+    instrument(false), sharedVars(false), predecessors(false),
+    skipStackAccesses(false), skipReadOnlyAccesses(false), sampling(false) {}
 
   /**
    * Constructs a MemoryAccessSettings_s object.
@@ -215,7 +273,10 @@ typedef struct MemoryAccessSettings_s
   MemoryAccessSettings_s(Settings* s) : reads(s->getReadNoise()),
    writes(s->getWriteNoise()), updates(s->getUpdateNoise()), instrument(false),
    sharedVars(s->get< bool >("coverage.sharedvars")),
-   predecessors(s->get< bool >("coverage.predecessors")) {}
+   predecessors(s->get< bool >("coverage.predecessors")),
+   skipStackAccesses(s->get< bool >("instrumentation.skip-stack-accesses")),
+   skipReadOnlyAccesses(s->get< bool >(
+     "instrumentation.skip-readonly-accesses")), sampling(false) {}
 } MemoryAccessSettings;
 
 /**
@@ -237,7 +298,7 @@ typedef struct MemoryAccessInstructionInfo_s
    * @brief A location in the source code where the memory access instruction
    *   originates from.
    */
-  LOCATION* location;
+  const LOCATION* location;
 
   /**
    * Constructs a MemoryAccessInstructionInfo_s object.
@@ -286,12 +347,87 @@ typedef struct MemoryAccessInfo_s
     index(idx), size(sz), instruction(ins) {}
 } MemoryAccessInfo;
 
+/**
+ * @brief A structure containing information about memory accesses performed
+ *   in a basic block which are stored for the batch consumers together.
+ *
+ * @note This information does not change during the execution of a program.
+ */
+typedef struct BlockAccessInfo_s
+{
+  /**
+   * @brief A number of memory accesses stored together.
+   */
+  UINT32 count;
+  /**
+   * @brief Static information about the memory accesses, in the order in which
+   *   they are performed in the basic block.
+   */
+  MemoryAccessInfo* accesses[BLOCK_MAX_ACCESSES];
+  /**
+   * @brief Types of the memory accesses (items of AccessRecordType).
+   */
+  UINT8 types[BLOCK_MAX_ACCESSES];
+
+  /**
+   * Constructs a BlockAccessInfo_s object.
+   */
+  BlockAccessInfo_s() : count(0) {}
+} BlockAccessInfo;
+
+/**
+ * @brief A structure representing a continuous range of memory.
+ */
+typedef struct MemoryRange_s
+{
+  ADDRINT low; //!< The lowest address in the range.
+  ADDRINT high; //!< The first address after the range.
+
+  /**
+   * Constructs a MemoryRange_s object.
+   *
+   * @param l The lowest address in the range.
+   * @param h The first address after the range.
+   */
+  MemoryRange_s(ADDRINT l, ADDRINT h) : low(l), high(h) {}
+
+  /**
+   * Checks if a memory range starts before another memory range.
+   *
+   * @param mr A memory range.
+   * @return @em True if the memory range starts before the other memory range,
+   *   @em false otherwise.
+   */
+  bool operator<(const MemoryRange_s& mr) const { return low < mr.low; }
+} MemoryRange;
+
+// Type definitions
+typedef std::vector< MemoryRange > MemoryRangeList;
+
 // Definitions of analysis functions (callback functions called by PIN)
 VOID initMemoryAccessTls(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v);
+ADDRINT PIN_FAST_ANALYSIS_CALL isWritableMemory(ADDRINT addr);
+ADDRINT PIN_FAST_ANALYSIS_CALL isMemoryAccessMonitored(THREADID tid,
+  MemoryAccessInfo* memAccInfo);
+ADDRINT PIN_FAST_ANALYSIS_CALL isSampledMemoryAccess(THREADID tid);
+ADDRINT PIN_FAST_ANALYSIS_CALL isSampledWritableMemoryAccess(THREADID tid,
+  ADDRINT addr);
+VOID PIN_FAST_ANALYSIS_CALL storeBlockAccess(THREADID tid, ADDRINT addr,
+  UINT32 slot);
+VOID PIN_FAST_ANALYSIS_CALL recordBlockAccesses(THREADID tid,
+  BlockAccessInfo* block);
+VOID PIN_FAST_ANALYSIS_CALL beforeSampledFunctionExecuted(THREADID tid,
+  ADDRINT sp, ADDRINT idx);
+VOID PIN_FAST_ANALYSIS_CALL beforeSampledFunctionReturned(THREADID tid,
+  ADDRINT sp);
 
 // Definitions of helper functions
 VOID setupAccessModule(Settings* settings);
 VOID setupMemoryAccessSettings(MemoryAccessSettings& mas);
+VOID flushAccessBatch(THREADID tid);
+VOID registerReadOnlyMemory(ADDRINT low, ADDRINT high);
+VOID unregisterReadOnlyMemory(ADDRINT low, ADDRINT high);
+BOOL isReadOnlyMemory(ADDRINT addr);
 
 #endif /* __PINTOOL_ANACONDA__CALLBACKS__ACCESS_H__ */
 
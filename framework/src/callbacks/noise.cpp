@@ -26,21 +26,34 @@
  * @file      noise.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-11-23
- * @date      Last Update 2020-05-09
- * @version   0.4
+ * @date      Last Update 2026-10-16
+ * @version   0.6.3
  */
 
 #include "noise.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
 #include <boost/foreach.hpp>
 
+#ifdef TARGET_LINUX
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
 #include "libdie-wrapper/pin_die.h"
 
+#include "access.h"
+
 #include "../config.h"
 #include "../noise.h"
 
 #include "../monitors/svars.hpp"
 
+#include "../utils/clock.hpp"
 #include "../utils/random.hpp"
 #include "../utils/scopedlock.hpp"
 
@@ -75,15 +88,6 @@ typedef enum NoiseType_e
   NT_DEBUG = 0x10
 } NoiseType;
 
-/**
- * @brief An enumeration describing the types of shared variables filter.
- */
-typedef enum SharedVariablesType_e
-{
-  SVT_ALL, //!< Inject a noise before any shared variable.
-  SVT_ONE  //!< Inject a noise before one chosen shared variable.
-} SharedVariablesType;
-
 /**
  * @brief An enumeration describing the types of strength.
  */
@@ -139,60 +143,179 @@ DEFINE_NOISE_TRAITS(IT_UPDATE);
 
 namespace
 { // Static global variables (usable only within this module)
-  PIN_MUTEX g_timeLock; //!< A lock guarding access to local time.
-
   // Inverse noise configuration (and state) shared among all of the threads
-  INT32 g_tops; //!< A number of operations the running thread should perform.
-  THREADID g_rtid; //!< An ID of a thread allowed to run while blocking other.
-  UINT32 g_timeout; //!< A maximum time the thread might block other threads.
-  PIN_SEMAPHORE g_continue; //!< A flag determining if other threads may run.
-  PIN_RWMUTEX g_inSyncLock; //!< A lock syncing blocked and running threads.
+  /**
+   * @brief A state of the inverse noise. Bits 0-31 hold the number of
+   *   operations the running thread should still perform (@c 0 means that the
+   *   inverse noise is not active), bits 32-47 hold the ID of the thread which
+   *   is allowed to run and bits 48-63 hold the epoch of the inverse noise.
+   */
+  std::atomic< UINT64 > g_inState(0);
+  /**
+   * @brief A number incremented each time the inverse noise ends. Blocked
+   *   threads sleep (on a futex) until this number changes.
+   */
+  std::atomic< UINT32 > g_inGeneration(0);
+  /**
+   * @brief A maximum time (in milliseconds) the running thread might block the
+   *   other threads.
+   */
+  std::atomic< UINT32 > g_inTimeout(0);
 
   // Information used by the shared variables filter
-  SharedVariablesMonitor< FileWriter >* g_sVarsMon;
+  /**
+   * @brief A monitor holding shared variables detected in previous runs. Noise
+   *   might be injected before accesses to these variables.
+   */
+  SharedVariablesMonitor< BinaryFileWriter >* g_svarsMon;
   /**
    * @brief A name of the only shared variable before which might be a noise
    *   injected.
    */
   std::string g_sharedVariable;
+  /**
+   * @brief A flag determining if a noise might be injected before accesses to
+   *   shared variables.
+   */
+  bool g_svarsNoise = false;
+  /**
+   * @brief Sorted ranges of memory occupied by the shared variables before
+   *   which might be a noise injected (indexed by the type of the shared
+   *   variables), replaced as a whole when images are loaded or unloaded.
+   */
+  std::atomic< const MemoryRangeList* > g_svarsRanges[] = {
+    { new MemoryRangeList() }, // SVT_ALL
+    { new MemoryRangeList() }  // SVT_ONE
+  };
 }
 
 /**
  * Generates a random frequency, i.e., an integer number from 0 to 999.
  *
+ * @param tid A number identifying the thread which generates the frequency.
  * @return An integer number from 0 to 999.
  */
 inline
-UINT32 randomFrequency()
+UINT32 randomFrequency(THREADID tid)
+{
+  return randomInt< UINT32 >(tid, 0, 999);
+}
+
+/**
+ * Gets the number of operations the running thread should still perform before
+ *   the inverse noise ends.
+ *
+ * @param state A state of the inverse noise.
+ * @return The number of operations remaining, @c 0 if the inverse noise is not
+ *   active.
+ */
+inline
+UINT32 inverseNoiseOps(UINT64 state)
+{
+  return (UINT32)(state & 0xFFFFFFFFULL);
+}
+
+/**
+ * Gets an ID of the thread allowed to run while the inverse noise is active.
+ *
+ * @param state A state of the inverse noise.
+ * @return The ID of the running thread.
+ */
+inline
+THREADID inverseNoiseThread(UINT64 state)
+{
+  return (THREADID)((state >> 32) & 0xFFFFULL);
+}
+
+/**
+ * Gets an epoch of the inverse noise, i.e., a number incremented each time the
+ *   inverse noise is activated.
+ *
+ * @param state A state of the inverse noise.
+ * @return The epoch of the inverse noise.
+ */
+inline
+UINT64 inverseNoiseEpoch(UINT64 state)
+{
+  return state >> 48;
+}
+
+/**
+ * Constructs a state of the inverse noise.
+ *
+ * @param epoch An epoch of the inverse noise.
+ * @param tid An ID of the thread allowed to run.
+ * @param ops A number of operations the running thread should perform.
+ * @return The state of the inverse noise.
+ */
+inline
+UINT64 inverseNoiseState(UINT64 epoch, THREADID tid, UINT32 ops)
+{
+  return (epoch << 48) | ((UINT64)(tid & 0xFFFF) << 32) | ops;
+}
+
+/**
+ * Unblocks all threads blocked by the inverse noise. Must be called after the
+ *   state of the inverse noise was changed to inactive.
+ */
+inline
+VOID releaseBlockedThreads()
 {
-  return randomInt< UINT32 >(0, 999);
+  // Blocked threads sleep until the generation changes
+  g_inGeneration.fetch_add(1, std::memory_order_release);
+
+#ifdef TARGET_LINUX
+  syscall(SYS_futex, reinterpret_cast< UINT32* >(&g_inGeneration),
+    FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
 }
 
 /**
- * Gets the current time.
+ * Blocks a thread until the inverse noise ends or a timeout expires.
  *
- * @return The current time.
+ * @param generation A generation observed before the thread decided to block.
+ * @param deadline A value of the monotonic clock at which the timeout expires.
+ * @return @em True if the inverse noise ended, @em false if the timeout
+ *   expired.
  */
 inline
-pt::ptime getTime()
+BOOL waitForBlockedThreadsRelease(UINT32 generation, UINT64 deadline)
 {
-  // Boost implementation of local_time() might call functions from the C or C++
-  // libraries, but C and C++ libraries linked into pintools are not thread-safe
-  ScopedLock lock(g_timeLock);
+  while (g_inGeneration.load(std::memory_order_acquire) == generation)
+  { // Spurious wakeups are possible, check the generation again after each
+    UINT64 now = getMonotonicTime();
+
+    if (now >= deadline) return false; // Timeout expired
+
+#ifdef TARGET_LINUX
+    // Helper variables
+    struct timespec timeout;
+
+    timeout.tv_sec = (deadline - now) / NSECS_PER_SEC;
+    timeout.tv_nsec = (deadline - now) % NSECS_PER_SEC;
 
-  return pt::microsec_clock::local_time(); // Now we can safely access the time
+    // Sleeps only if the generation is still the same, no wakeup can be lost
+    syscall(SYS_futex, reinterpret_cast< UINT32* >(&g_inGeneration),
+      FUTEX_WAIT_PRIVATE, generation, &timeout, NULL, 0);
+#else
+    PIN_Yield();
+#endif
+  }
+
+  return true; // The inverse noise ended
 }
 
 /**
  * Generates a random strength, i.e., an integer number from 0 to @em max.
  *
+ * @param tid A number identifying the thread which generates the strength.
  * @param max A number indicating the maximum strength which might be generated.
  * @return An integer number from 0 to @em max.
  */
 inline
-UINT32 randomStrength(UINT32 max)
+UINT32 randomStrength(THREADID tid, UINT32 max)
 {
-  return randomInt< UINT32 >(0, max);
+  return randomInt< UINT32 >(tid, 0, max);
 }
 
 /**
@@ -213,11 +336,11 @@ inline
 VOID PIN_FAST_ANALYSIS_CALL injectNoise(THREADID tid, UINT32 frequency,
   UINT32 strength)
 {
-  if (randomFrequency() < frequency)
+  if (randomFrequency(tid) < frequency)
   { // We are under the frequency threshold, insert the noise
     if (ST & ST_RANDOM)
     { // Need to convert the maximum strength to a random one
-      strength = randomStrength(strength);
+      strength = randomStrength(tid, strength);
     }
 
     if (NT & NT_SLEEP)
@@ -245,19 +368,19 @@ VOID PIN_FAST_ANALYSIS_CALL injectNoise(THREADID tid, UINT32 frequency,
 
     if (NT & NT_BUSY_WAIT)
     { // Inject busy wait noise, i.e., cycle in a loop for some time
-      pt::ptime end = getTime() + pt::milliseconds(strength);
+      UINT64 end = getDeadline(strength * NSECS_PER_MSEC);
 
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
-      pt::ptime now; // Helper variables
+      UINT64 now; // Helper variables
 
-      while ((now = getTime()) < end)
+      while ((now = getMonotonicTime()) < end)
 #else
-      while (getTime() < end)
+      while (getMonotonicTime() < end)
 #endif
       { // Strength determines how many loop iterations we should perform
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
         CONSOLE("Thread " + decstr(tid) + ": looping ("
-          + decstr((end - now).total_milliseconds())
+          + decstr((end - now) / NSECS_PER_MSEC)
           + " miliseconds remaining).\n");
 #endif
 
@@ -267,24 +390,31 @@ VOID PIN_FAST_ANALYSIS_CALL injectNoise(THREADID tid, UINT32 frequency,
 
     if (NT & NT_INVERSE)
     { // Inject inverse noise, i.e., block all other threads for some time
-      ScopedWriteLock lock(g_inSyncLock);
+      UINT64 state = g_inState.load(std::memory_order_acquire);
 
-      if (!PIN_SemaphoreIsSet(&g_continue))
+      if (inverseNoiseOps(state) != 0)
       { // Some other thread already activated the inverse noise, do not inject
         // any noise and continue, we will be blocked by the inverse noise when
         // we reach the next location monitored (memory access, sync operation)
         return;
       }
 
+      // Maximum time the threads might be blocked, published by the CAS below
+      g_inTimeout.store(strength * 10, std::memory_order_relaxed);
+
+      // Only this thread is allowed to run, block all others for the next few
+      // operations (at least one, even if the strength is zero)
+      if (!g_inState.compare_exchange_strong(state, inverseNoiseState(
+        inverseNoiseEpoch(state) + 1, tid, (strength != 0) ? strength : 1),
+        std::memory_order_acq_rel))
+      { // Some other thread activated the inverse noise in the meantime
+        return;
+      }
+
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
       CONSOLE("Thread " + decstr(tid) + ": blocking all threads for the next "
         + decstr(strength) + " operations.\n");
 #endif
-
-      g_rtid = tid; // Only this thread is allowed to run, block all others
-      g_tops = strength; // Block the threads for the next g_tops operations
-      g_timeout = strength * 10; // Maximum time the threads might be blocked
-      PIN_SemaphoreClear(&g_continue); // Block all other threads except this
     }
   }
 
@@ -345,38 +475,171 @@ VOID injectAccessNoise(THREADID tid, ADDRINT addr, UINT32 size, ADDRINT rtnAddr,
 }
 
 /**
- * Allows to inject a noise only before accesses to shared variables.
+ * Checks if an address belongs to a shared variable before which a noise might
+ *   be injected.
+ *
+ * @note The address may point anywhere inside the variable, e.g., to a member
+ *   of a structure or to an element of an array. The ranges of memory occupied
+ *   by the shared variables are computed when the images are loaded, so only
+ *   a binary search is performed here (no debugging information is searched).
  *
  * @tparam SVT A type of shared variables before which a noise might be placed.
  *   The noise might be placed before @em any shared variable (@c SVT_ALL) or
  *   @em one specific shared variable (@c SVT_ONE).
  *
+ * @param addr An address of the data accessed.
+ * @return @em True if the address belongs to a shared variable before which a
+ *   noise might be injected, @em false otherwise.
+ */
+template< SharedVariablesType SVT >
+inline
+BOOL isNoisySharedVariable(ADDRINT addr)
+{
+  const MemoryRangeList* ranges = g_svarsRanges[SVT].load(
+    std::memory_order_acquire);
+
+  // Find the first variable which starts after the address
+  MemoryRangeList::const_iterator it = std::upper_bound(ranges->begin(),
+    ranges->end(), MemoryRange(addr, addr));
+
+  if (it == ranges->begin()) return false; // No variable starts before it
+
+  return addr < (--it)->high; // Check the last variable starting before it
+}
+
+/**
+ * Injects a noise before an instruction accessing a shared variable if the
+ *   noise filters allow it.
+ *
+ * @note This function is used for accesses whose address is not known at the
+ *   instrumentation time, e.g., accesses to array elements through an index
+ *   or accesses through the global offset table in position-independent code.
+ *
+ * @tparam IT A type of the instruction performing the memory access (might be
+ *   an instruction reading, writing or atomically updating a memory).
+ * @tparam SVT A type of shared variables before which a noise might be placed.
+ *
  * @param tid A number identifying the thread which performed the access.
  * @param addr An address of the data accessed.
  * @param size A size in bytes of the data accessed.
  * @param rtnAddr An address of the routine which accessed the memory.
  * @param insAddr An address of the instruction which accessed the memory.
- * @param registers A structure containing register values.
+ * @param registers A structure containing register values (@em NULL if no
+ *   runtime filters are active as they are not needed then).
+ * @param ns A structure containing the noise injection settings.
  */
-template< SharedVariablesType SVT >
-inline
-BOOL sharedVariablesFilter(THREADID tid, ADDRINT addr, UINT32 size,
-  ADDRINT rtnAddr, ADDRINT insAddr, CONTEXT* registers)
+template< InstructionType IT, SharedVariablesType SVT >
+VOID PIN_FAST_ANALYSIS_CALL injectSharedVariableAccessNoise(THREADID tid,
+  ADDRINT addr, UINT32 size, ADDRINT rtnAddr, ADDRINT insAddr,
+  CONTEXT* registers, NoiseSettings* ns)
 {
-  // Helper variables
-  VARIABLE var;
-
-  // Get information about the variable accessed
-  DIE_GetVariable(rtnAddr, insAddr, addr, size, registers, /* input */
-    var.name, var.type, &var.offset); /* output */
+  if (!isNoisySharedVariable< SVT >(addr)) return;
 
-  if (SVT == SVT_ALL)
-  { // Inject the noise before accesses to any shared variable
-    return g_sVarsMon->isSharedVariable(var);
+  if (ns->filter != NULL)
+  { // Some runtime filters active, let them determine if noise is injected
+    injectAccessNoise< IT >(tid, addr, size, rtnAddr, insAddr, registers, ns);
   }
   else
-  { // Inject the noise before accesses to one specific shared variable
-    return var.name == g_sharedVariable;
+  { // No runtime filters active, the noise may be injected right away
+    ns->generator(tid, ns->frequency, ns->strength);
+  }
+}
+
+/**
+ * Checks if a noise might be injected before an access to a specific address.
+ *
+ * @note This check is done at instrumentation time, so only addresses known
+ *   statically (absolute or relative to the instruction pointer) can be used.
+ *   Such addresses can only reference global variables.
+ *
+ * @param addr An address of the data accessed.
+ * @param ns A structure containing the noise injection settings.
+ * @return @em True if the address belongs to a shared variable before which a
+ *   noise might be injected, @em false otherwise.
+ */
+BOOL isSharedVariableNoisePoint(ADDRINT addr, NoiseSettings* ns)
+{
+  return (ns->svarsType == SVT_ALL) ? isNoisySharedVariable< SVT_ALL >(addr)
+    : isNoisySharedVariable< SVT_ONE >(addr);
+}
+
+/**
+ * Adds a range of memory occupied by a global variable to the ranges of shared
+ *   variables before which might be a noise injected if the global variable is
+ *   one of these shared variables.
+ *
+ * @param low The lowest address of the global variable.
+ * @param high The first address after the global variable.
+ * @param name A name of the global variable.
+ * @param type A type of the global variable.
+ * @param val A pointer to the lists of ranges indexed by the type of the shared
+ *   variables.
+ */
+VOID addNoisySharedVariable(ADDRINT low, ADDRINT high, const std::string& name,
+  const std::string& type, VOID* val)
+{
+  MemoryRangeList** ranges = static_cast< MemoryRangeList** >(val);
+
+  if (g_svarsMon->isSharedVariable(name))
+    ranges[SVT_ALL]->push_back(MemoryRange(low, high));
+
+  if (name == g_sharedVariable)
+    ranges[SVT_ONE]->push_back(MemoryRange(low, high));
+}
+
+/**
+ * Registers ranges of memory occupied by the shared variables of an image
+ *   before which might be a noise injected.
+ *
+ * @note The analysis functions may search the ranges at the same time, so new
+ *   lists of ranges are created and published instead of updating the current
+ *   lists. The old lists are never freed as some thread might still be using
+ *   them.
+ *
+ * @param image An object representing the image. Debugging information must
+ *   be already extracted from the image.
+ */
+VOID registerSharedVariables(IMG image)
+{
+  if (!g_svarsNoise) return; // No noise before accesses to shared variables
+
+  MemoryRangeList* ranges[] = {
+    new MemoryRangeList(*g_svarsRanges[SVT_ALL].load()),
+    new MemoryRangeList(*g_svarsRanges[SVT_ONE].load())
+  };
+
+  // Names of the variables are compared only once here, not on each access
+  DIE_GetGlobalVariables(image, addNoisySharedVariable, ranges);
+
+  for (int svt = SVT_ALL; svt <= SVT_ONE; svt++)
+  { // Keep the ranges sorted, the analysis functions use binary search on them
+    std::sort(ranges[svt]->begin(), ranges[svt]->end());
+
+    g_svarsRanges[svt].store(ranges[svt], std::memory_order_release);
+  }
+}
+
+/**
+ * Unregisters all ranges of memory occupied by the shared variables lying in
+ *   a range of memory which is being freed (e.g., when an image is unloaded).
+ *
+ * @param low The lowest address of the memory being freed.
+ * @param high The first address after the memory being freed.
+ */
+VOID unregisterSharedVariables(ADDRINT low, ADDRINT high)
+{
+  if (!g_svarsNoise) return; // No noise before accesses to shared variables
+
+  for (int svt = SVT_ALL; svt <= SVT_ONE; svt++)
+  { // Keep only ranges outside of the memory being freed
+    MemoryRangeList* ranges = new MemoryRangeList();
+
+    BOOST_FOREACH(const MemoryRange& range, *g_svarsRanges[svt].load())
+    { // The ranges stay sorted as their order is preserved
+      if (range.high <= low || range.low >= high) ranges->push_back(range);
+    }
+
+    g_svarsRanges[svt].store(ranges, std::memory_order_release);
   }
 }
 
@@ -393,76 +656,86 @@ BOOL sharedVariablesFilter(THREADID tid, ADDRINT addr, UINT32 size,
 BOOL inverseNoiseFilter(THREADID tid, ADDRINT addr, UINT32 size,
   ADDRINT rtnAddr, ADDRINT insAddr, CONTEXT* registers)
 {
-  while (true)
-  { // We need to jump here sometimes, but goto is evil so we use while :D
-    if (!PIN_SemaphoreIsSet(&g_continue))
-    { // Inverse noise active, i.e., some thread is blocking all other threads
-      PIN_RWMutexReadLock(&g_inSyncLock);
+  // Threads not blocked by the inverse noise only need a single load here
+  UINT64 state = g_inState.load(std::memory_order_acquire);
 
-      if (PIN_SemaphoreIsSet(&g_continue))
-      { // Inverse noise not active anymore, deactivated before we entered CS
-        PIN_RWMutexUnlock(&g_inSyncLock);
+  while (inverseNoiseOps(state) != 0)
+  { // Inverse noise active, i.e., some thread is blocking all other threads
+    if (tid == inverseNoiseThread(state))
+    { // This is the only thread that may run, other threads are blocked
+      UINT32 ops = inverseNoiseOps(state);
 
-        continue; // Jump to the beginning and check the continue flag again
-      }
-
-      if (tid == g_rtid)
-      { // This is the only thread that may run, other threads are blocked
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
-        CONSOLE("Thread " + decstr(tid) + ": performing a single operation ("
-          + decstr(g_tops - 1) + " operations remaining).\n");
+      CONSOLE("Thread " + decstr(tid) + ": performing a single operation ("
+        + decstr(ops - 1) + " operations remaining).\n");
 #endif
 
-        if (--g_tops < 1)
-        { // We performed all operations for which we blocked the other threads
+      // The state might be changed concurrently by a blocked thread (timeout)
+      if (!g_inState.compare_exchange_weak(state, state - 1,
+        std::memory_order_acq_rel)) continue; // Reloaded, check it again
+
+      if (ops == 1)
+      { // We performed all operations for which we blocked the other threads
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
-          CONSOLE("Thread " + decstr(tid) + ": resuming all threads.\n");
+        CONSOLE("Thread " + decstr(tid) + ": resuming all threads.\n");
 #endif
 
-          PIN_SemaphoreSet(&g_continue); // Unblock the other (blocked) threads
-        }
+        releaseBlockedThreads(); // Unblock the other (blocked) threads
+      }
 
-        PIN_RWMutexUnlock(&g_inSyncLock); // Allow inverse noise to be injected
+      return false; // Do not inject noise before this thread
+    }
 
-        return false; // Do not inject noise before this thread
-      }
-      else
-      { // This is one of the blocked threads
+    // This is one of the blocked threads
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
-        CONSOLE("Thread " + decstr(tid) + ": blocked by thread "
-          + decstr(g_rtid) + ", waiting.\n");
+    CONSOLE("Thread " + decstr(tid) + ": blocked by thread "
+      + decstr(inverseNoiseThread(state)) + ", waiting.\n");
 #endif
 
-        if (!PIN_SemaphoreTimedWait(&g_continue, g_timeout))
-        { // Time out reached, the running thread is likely waiting for some of
-          // the blocked threads to do something and cannot continue until them
-          // Recover from the deadlock as the injected noise probably caused it
-#if ANACONDA_PRINT_INJECTED_NOISE == 1
-          CONSOLE("Thread " + decstr(tid) + ": timeout, resuming all threads.\n");
-#endif
+    // Read the generation before checking the epoch, so that a release made
+    // after the check changes the generation and the wait returns immediately
+    UINT32 generation = g_inGeneration.load(std::memory_order_acquire);
+    UINT64 epoch = inverseNoiseEpoch(state);
 
-          PIN_SemaphoreSet(&g_continue); // Unblock all (blocked) threads
-        }
+    state = g_inState.load(std::memory_order_acquire);
+
+    if (inverseNoiseOps(state) == 0 || inverseNoiseEpoch(state) != epoch)
+      continue; // Inverse noise ended (or restarted) in the meantime
+
+    if (!waitForBlockedThreadsRelease(generation, getDeadline(
+      g_inTimeout.load(std::memory_order_relaxed) * NSECS_PER_MSEC)))
+    { // Time out reached, the running thread is likely waiting for some of
+      // the blocked threads to do something and cannot continue until them
+      // Recover from the deadlock as the injected noise probably caused it
+      state = g_inState.load(std::memory_order_acquire);
+
+      while (inverseNoiseOps(state) != 0 && inverseNoiseEpoch(state) == epoch)
+      { // Deactivate the inverse noise unless it already ended or restarted
+        if (g_inState.compare_exchange_weak(state, state
+          & ~0xFFFFFFFFULL, std::memory_order_acq_rel))
+        { // Keep the epoch, the next activation will increment it
 #if ANACONDA_PRINT_INJECTED_NOISE == 1
-        else
-        { // Thread unblocked, continue running
-          CONSOLE("Thread " + decstr(tid) + ": resumed.\n");
-        }
+          CONSOLE("Thread " + decstr(tid) + ": timeout, resuming all threads.\n");
 #endif
 
-        PIN_RWMutexUnlock(&g_inSyncLock); // Allow inverse noise to be injected
+          releaseBlockedThreads(); // Unblock all (blocked) threads
 
-        continue; // Jump to the beginning and check the continue flag again
+          break;
+        }
       }
     }
+#if ANACONDA_PRINT_INJECTED_NOISE == 1
     else
-    { // Inverse noise not active, i.e., threads may continue their execution
-      return true; // Do not block the thread and allow it to inject noise
+    { // Thread unblocked, continue running
+      CONSOLE("Thread " + decstr(tid) + ": resumed.\n");
     }
+#endif
+
+    // Check the state again, the inverse noise might be already active again
+    state = g_inState.load(std::memory_order_acquire);
   }
 
-  assert(false); // Something is very wrong if the control reaches this part
-  return true; // Just to eliminate some warnings from dumb static analysers
+  return true; // Do not block the thread and allow it to inject noise
 }
 
 /**
@@ -479,27 +752,28 @@ VOID setupNoiseFilters(NoiseSettings* ns)
 {
   typedef NoiseTraits< IT > Traits; // Here are the filters we need to setup
 
-  if (ns->filters.size() > 0)
-  { // Do not call the generator directly, call it through the filter function
-    ns->filter = (AFUNPTR)injectAccessNoise< IT >;
-  }
-
   BOOST_FOREACH(NoiseFilter filter, ns->filters)
   { // Configure all noise filters activated
     switch (filter)
     { // Each filter has to be configured separately
       case NF_SHARED_VARS: // Shared variables filter
+        // Evaluated at instrumentation time if the accessed address is known
+        // statically, the other accesses are checked at runtime
         if (ns->properties.get< std::string >("svars.type") == "all")
         { // Inject noise before accesses to shared variables
-          Traits::filters.push_back(sharedVariablesFilter< SVT_ALL >);
+          ns->svarsType = SVT_ALL;
+          ns->svarsFilter = (AFUNPTR)injectSharedVariableAccessNoise< IT,
+            SVT_ALL >;
         }
         else
         { // Inject noise before accesses to one shared variable only
-          Traits::filters.push_back(sharedVariablesFilter< SVT_ONE >);
+          ns->svarsType = SVT_ONE;
+          ns->svarsFilter = (AFUNPTR)injectSharedVariableAccessNoise< IT,
+            SVT_ONE >;
         }
         break;
       case NF_PREDECESSORS: // Predecessors filter
-        break;
+        break; // Evaluated at instrumentation time, no runtime filter needed
       case NF_INVERSE_NOISE: // Inverse noise filter
         Traits::filters.push_back(inverseNoiseFilter);
         break;
@@ -508,6 +782,11 @@ VOID setupNoiseFilters(NoiseSettings* ns)
         break;
     }
   }
+
+  if (!Traits::filters.empty())
+  { // Do not call the generator directly, call it through the filter function
+    ns->filter = (AFUNPTR)injectAccessNoise< IT >;
+  }
 }
 
 /**
@@ -519,14 +798,26 @@ VOID setupNoiseFilters(NoiseSettings* ns)
 VOID setupNoiseModule(Settings* settings)
 {
   // Shared variable noise needs information about shared variables
-  g_sVarsMon = &settings->getCoverageMonitors().svars;
+  g_svarsMon = &settings->getCoverageMonitors().svars;
+
+  // Helper variables
+  UINT32 svars = g_svarsMon->getLoadedSharedVariableCount();
 
   // TODO: choose the shared variable only when needed
-  std::vector< std::string > svars = g_sVarsMon->getSharedVariables();
 
-  if (!svars.empty())
+  if (svars != 0)
   { // Randomly choose one of the shared variables detected in previous runs
-    g_sharedVariable = svars.at(randomStrength(svars.size() - 1));
+    g_sharedVariable = g_svarsMon->getLoadedSharedVariable(
+      randomInt< UINT32 >(0, svars - 1));
+  }
+
+  NoiseSettings* noises[] = { settings->getReadNoise(),
+    settings->getWriteNoise(), settings->getUpdateNoise() };
+
+  BOOST_FOREACH(NoiseSettings* ns, noises)
+  { // Shared variables are searched for only if some noise is placed by them
+    g_svarsNoise |= std::count(ns->filters.begin(), ns->filters.end(),
+      NF_SHARED_VARS) != 0;
   }
 
   // Setup the noise placement filters for each type of memory accesses
@@ -534,16 +825,8 @@ VOID setupNoiseModule(Settings* settings)
   setupNoiseFilters< IT_WRITE >(settings->getWriteNoise());
   setupNoiseFilters< IT_UPDATE >(settings->getUpdateNoise());
 
-  // A flag determining if threads may continue their execution
-  PIN_SemaphoreInit(&g_continue);
   // At the beginning all threads may continue their execution
-  PIN_SemaphoreSet(&g_continue);
-
-  // A lock used to synchronise running and block threads
-  PIN_RWMutexInit(&g_inSyncLock);
-
-  // A lock guarding access to local time
-  PIN_MutexInit(&g_timeLock);
+  g_inState.store(0, std::memory_order_release);
 }
 
 /**
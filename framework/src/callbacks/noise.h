@@ -25,8 +25,8 @@
  * @file      noise.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-11-23
- * @date      Last Update 2013-03-20
- * @version   0.3
+ * @date      Last Update 2026-10-16
+ * @version   0.4.1
  */
 
 #ifndef __PINTOOL_ANACONDA__CALLBACKS__NOISE_H__
@@ -40,6 +40,11 @@
 VOID injectSharedVariableNoise(THREADID tid, VOID* noiseDesc, ADDRINT addr,
   UINT32 size, ADDRINT rtnAddr, ADDRINT insAddr, CONTEXT* registers);
 
+// Definitions of functions for placing noise at instrumentation time
+BOOL isSharedVariableNoisePoint(ADDRINT addr, NoiseSettings* ns);
+VOID registerSharedVariables(IMG image);
+VOID unregisterSharedVariables(ADDRINT low, ADDRINT high);
+
 // Definitions of helper functions
 VOID setupNoiseModule(Settings* settings);
 VOID registerBuiltinNoiseFunctions();
@@ -27,14 +27,15 @@
  * @file      sync.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-19
- * @date      Last Update 2016-03-18
- * @version   0.10.7
+ * @date      Last Update 2026-10-15
+ * @version   0.10.8
  */
 
 #include "sync.h"
 
 #include <vector>
 
+#include "access.h"
 #include "shared.hpp"
 
 #include "../anaconda.h"
@@ -200,6 +201,9 @@ VOID afterSyncOperation(THREADID tid, ADDRINT* retVal, VOID* data)
   // Valid sync primitive object means that there is an operation in progress
   assert(obj.is_valid());
 
+  // Deliver the accesses performed before the operation finished
+  flushAccessBatch(tid);
+
   BOOST_FOREACH(typename Traits::CallbackType callback, Traits::after)
   { // Execute all functions to be called after a synchronisation operation
     callback(tid, Traits::sparg(obj));
@@ -241,6 +245,9 @@ VOID beforeSyncOperation(CBSTACK_FUNC_PARAMS, ADDRINT* arg, HookInfo* hi)
 
   g_data.get(tid)->*Traits::sp = obj; // Store the sync primitive for later use
 
+  // Deliver the accesses performed before the operation started
+  flushAccessBatch(tid);
+
   BOOST_FOREACH(typename Traits::CallbackType callback, Traits::before)
   { // Execute all functions to be called before a synchronisation operation
     callback(tid, Traits::sparg(obj));
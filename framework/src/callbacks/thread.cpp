@@ -26,18 +26,21 @@
  * @file      thread.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-02-03
- * @date      Last Update 2017-05-18
- * @version   0.13.12.1
+ * @date      Last Update 2026-10-15
+ * @version   0.16.2
  */
 
 #include "thread.h"
 
 #include <assert.h>
 
+#include <atomic>
 #include <functional>
+#include <map>
 
 #include <boost/foreach.hpp>
 
+#include "access.h"
 #include "shared.hpp"
 
 #include "../anaconda.h"
@@ -78,12 +81,86 @@ namespace
   typedef std::vector< THREADFUNPTR > ThreadStartedCallbackContainerType;
   typedef std::vector< THREADFUNPTR > ThreadFinishedCallbackContainerType;
   typedef std::vector< FORKFUNPTR > ThreadForkedCallbackContainerType;
-  typedef std::vector< THREADFUNPTR > FunctionEnteredCallbackContainerType;
-  typedef std::vector< THREADFUNPTR > FunctionExitedCallbackContainerType;
+  typedef std::vector< std::pair< THREADFUNPTR, FUNCTIONFILTERFUNPTR > >
+    FunctionEnteredCallbackContainerType;
+  typedef std::vector< std::pair< THREADFUNPTR, FUNCTIONFILTERFUNPTR > >
+    FunctionExitedCallbackContainerType;
 
   // Types of functions for retrieving backtrace information
   typedef VOID (*BACKTRACEFUNPTR)(THREADID tid, Backtrace& bt);
   typedef VOID (*BACKTRACESYMFUNPTR)(Backtrace& bt, Symbols& symbols);
+  typedef BacktraceId (*BACKTRACEIDFUNPTR)(THREADID tid);
+
+  /**
+   * @brief A structure representing a node in a calling context tree, i.e., a
+   *   backtrace which is shared with all backtraces extending it.
+   *
+   * @note Nodes are never freed, so pointers to them may be used as identifiers
+   *   of backtraces even after the thread which created them finishes.
+   */
+  typedef struct CallingContext_s
+  {
+    typedef std::map< ADDRINT, CallingContext_s* > ChildrenMap;
+
+    ADDRINT entry; //!< The innermost entry (call index or return address).
+    CallingContext_s* parent; //!< A calling context of the caller.
+    size_t depth; //!< A number of entries in the backtrace.
+    ChildrenMap children; //!< Calling contexts of the callees.
+    CallingContext_s* last; //!< The most recently entered callee.
+
+    /**
+     * Constructs a CallingContext_s object representing an empty backtrace.
+     */
+    CallingContext_s() : entry(0), parent(NULL), depth(0), children(),
+      last(NULL) {}
+
+    /**
+     * Constructs a CallingContext_s object extending a backtrace.
+     *
+     * @param e An entry (call index or return address) to add.
+     * @param p A calling context representing the backtrace to extend.
+     */
+    CallingContext_s(ADDRINT e, CallingContext_s* p) : entry(e), parent(p),
+      depth(p->depth + 1), children(), last(NULL) {}
+
+    /**
+     * Gets a calling context extending this calling context with an entry.
+     *
+     * @warning Only the thread owning the calling context tree may call this
+     *   method.
+     *
+     * @param e An entry (call index or return address).
+     * @return The calling context extending this calling context with @em e.
+     */
+    CallingContext_s* enter(ADDRINT e)
+    {
+      // Loops usually call the same function repeatedly, try it first
+      if (last != NULL && last->entry == e) return last;
+
+      ChildrenMap::iterator it = children.find(e);
+
+      if (it == children.end())
+      { // First time in this calling context, create a new node for it
+        it = children.insert(ChildrenMap::value_type(e,
+          new CallingContext_s(e, this))).first;
+      }
+
+      return last = it->second;
+    }
+
+    /**
+     * Gets a backtrace represented by this calling context.
+     *
+     * @param bt A backtrace. The innermost entry is stored first.
+     */
+    VOID getBacktrace(Backtrace& bt) const
+    {
+      for (const CallingContext_s* c = this; c->parent != NULL; c = c->parent)
+      { // The root node represents an empty backtrace, it has no entry
+        bt.push_back(c->entry);
+      }
+    }
+  } CallingContext;
 
   /**
    * @brief A structure holding private data of a thread.
@@ -91,7 +168,11 @@ namespace
   typedef struct ThreadData_s
   {
     ADDRINT bp; //!< A value of the thread's base pointer register.
-    Backtrace backtrace; //!< The current backtrace of a thread.
+    /**
+     * @brief The current calling context (backtrace) of a thread. In case of
+     *   lightweight backtraces, this is the root of the calling context tree.
+     */
+    CallingContext* context;
     FunctionVector functions; //!< A list of currently executing functions.
     BtSpVector btsplist; //!< The values of stack pointer of calls in backtrace.
     std::string ltcloc; //!< A location where the last thread was created.
@@ -101,8 +182,8 @@ namespace
     /**
      * Constructs a ThreadData_s object.
      */
-    ThreadData_s() : bp(0), backtrace(), btsplist(), tcloc("<unknown>"), arg(0)
-      {}
+    ThreadData_s() : bp(0), context(new CallingContext()), btsplist(),
+      tcloc("<unknown>"), arg(0) {}
   } ThreadData;
 
   /**
@@ -168,6 +249,11 @@ namespace
    *   function (finishes execution of a function).
    */
   FunctionExitedCallbackContainerType g_functionExitedCallbacks;
+  /**
+   * @brief Contains callback functions called when a thread enters or exits a
+   *   function which are not restricted to specific functions.
+   */
+  FunctionCallbacks* g_unfilteredFunctionCallbacks = NULL;
 
   ThreadLocalData< ThreadData > g_data; //!< Private data of running threads.
 
@@ -184,91 +270,127 @@ namespace
    *   these entries (e.g. translating indexes or addresses to locations).
    */
   BACKTRACESYMFUNPTR g_getBacktraceSymbolsImpl = NULL;
+  /**
+   * @brief A function for accessing an identifier of a backtrace of a thread.
+   */
+  BACKTRACEIDFUNPTR g_getBacktraceIdImpl = NULL;
 
   ImmutableRWMap< UINT32, THREADID > g_threadIdMap(0);
-  ImmutableRWMap< UINT32, std::string > g_threadCreateLocMap("<unknown>");
-
-  PredecessorsMonitor< FileWriter >* g_predsMon;
+  PredecessorsMonitor< BinaryFileWriter >* g_predsMon;
 
   /**
-   * @brief A structure used to synchronise threads during thread creation.
+   * @brief A structure used to synchronise a thread creating a new thread with
+   *   the newly created thread.
+   *
+   * The slot is created by the thread which needs it first and picked up by
+   *   the other thread. Each of the threads then publishes its data into the
+   *   slot and wakes up the other thread, no polling is needed.
    */
-  typedef struct ThreadCreationBarrier_s
+  typedef struct ThreadCreationSlot_s
   {
+    THREADID tid; //!< A number identifying the newly created thread.
+    std::string location; //!< A location where the thread was created.
     /**
-     * @brief Used to synchronise the old thread with the newly created one.
+     * @brief A number of threads which did not finish using the slot yet.
      */
-    PIN_SEMAPHORE semOld;
+    std::atomic< int > refs;
     /**
-     * @brief Used to synchronise the newly created thread with the old one.
+     * @brief Set when the creating thread published the creation location.
      */
-    PIN_SEMAPHORE semNew;
-
+    PIN_SEMAPHORE locationReady;
     /**
-     * Constructs a new structure used to synchronise threads during their
-     *   creation.
+     * @brief Set when the new thread published its ID and initialised itself.
      */
-    ThreadCreationBarrier_s()
-    {
-      PIN_SemaphoreInit(&semOld);
-      PIN_SemaphoreInit(&semNew);
-    }
-
+    PIN_SEMAPHORE threadReady;
     /**
-     * Destroys a structure used to synchronise threads during their creation.
+     * @brief Set when the creating thread notified analysers about the new
+     *   thread.
      */
-    ~ThreadCreationBarrier_s()
-    {
-      PIN_SemaphoreFini(&semOld);
-      PIN_SemaphoreFini(&semNew);
-    }
-
-    /**
-     * Waits for the old thread to prepare data used by the new thread.
-     */
-    void waitForOld()
-    {
-      PIN_SemaphoreWait(&semOld);
-      PIN_SemaphoreClear(&semOld);
-    }
+    PIN_SEMAPHORE forkNotified;
 
     /**
-     * Waits for the new thread to prepare data used by the old thread.
+     * Constructs a new slot used to synchronise threads during their creation.
      */
-    void waitForNew()
+    ThreadCreationSlot_s() : tid(INVALID_THREADID), location("<unknown>"),
+      refs(2)
     {
-      PIN_SemaphoreWait(&semNew);
-      PIN_SemaphoreClear(&semNew);
+      PIN_SemaphoreInit(&locationReady);
+      PIN_SemaphoreInit(&threadReady);
+      PIN_SemaphoreInit(&forkNotified);
     }
 
     /**
-     * Signals that the old thread has finished preparing the data used by the
-     *   new thread.
+     * Destroys a slot used to synchronise threads during their creation.
      */
-    void oldReady()
+    ~ThreadCreationSlot_s()
     {
-      PIN_SemaphoreSet(&semOld);
+      PIN_SemaphoreFini(&locationReady);
+      PIN_SemaphoreFini(&threadReady);
+      PIN_SemaphoreFini(&forkNotified);
     }
+  } ThreadCreationSlot;
 
-    /**
-     * Signals that the new thread has finished preparing the data used by the
-     *   old thread.
-     */
-    void newReady()
-    {
-      PIN_SemaphoreSet(&semNew);
-    }
-  } ThreadCreationBarrier;
+  typedef std::map< UINT64, ThreadCreationSlot* > ThreadCreationSlotMap;
 
   /**
-   * @brief A list of all barriers currently used to synchronise old and newly
-   *   created threads.
-   *
-   * @note The implementation ensures that we are always refreshing references
-   *   to values after they are updated so we never work with invalid pointers
-   *   here.
+   * @brief Slots picked up by only one of the threads taking part in a thread
+   *   creation so far.
+   */
+  ThreadCreationSlotMap g_threadCreationSlots;
+  /**
+   * @brief A lock guarding access to the @em g_threadCreationSlots map.
    */
-  UnsafeRWMap< UINT32, ThreadCreationBarrier* > g_threadCreationBarrier(NULL);
+  PIN_MUTEX g_threadCreationSlotsLock;
+}
+
+/**
+ * Gets a slot used to synchronise a thread creating a new thread with the new
+ *   thread.
+ *
+ * @note Both threads taking part in the thread creation must call this function
+ *   and release the slot when they do not need it anymore.
+ *
+ * @param thread An object representing the new thread.
+ * @return The slot used to synchronise the threads.
+ */
+inline
+ThreadCreationSlot* acquireThreadCreationSlot(THREAD thread)
+{
+  // Helper variables
+  ThreadCreationSlot* slot;
+
+  PIN_MutexLock(&g_threadCreationSlotsLock);
+
+  ThreadCreationSlotMap::iterator it = g_threadCreationSlots.find(thread.q());
+
+  if (it == g_threadCreationSlots.end())
+  { // We are the first, the other thread will pick the slot up later
+    g_threadCreationSlots.insert(ThreadCreationSlotMap::value_type(thread.q(),
+      slot = new ThreadCreationSlot()));
+  }
+  else
+  { // We are the second, no other thread will need to find the slot anymore,
+    // which also allows the thread object to be reused by other threads
+    slot = it->second;
+    g_threadCreationSlots.erase(it);
+  }
+
+  PIN_MutexUnlock(&g_threadCreationSlotsLock);
+
+  return slot;
+}
+
+/**
+ * Releases a slot used to synchronise a thread creating a new thread with the
+ *   new thread.
+ *
+ * @param slot The slot used to synchronise the threads.
+ */
+inline
+VOID releaseThreadCreationSlot(ThreadCreationSlot* slot)
+{
+  // The last thread using the slot deletes it
+  if (--slot->refs == 0) delete slot;
 }
 
 /**
@@ -315,7 +437,50 @@ VOID getLightweightBacktrace(THREADID tid, Backtrace& bt)
  */
 VOID getPreciseBacktrace(THREADID tid, Backtrace& bt)
 {
-  bt = g_data.get(tid)->backtrace;
+  bt.clear();
+
+  g_data.get(tid)->context->getBacktrace(bt);
+}
+
+/**
+ * Gets an identifier of a lightweight backtrace of a thread.
+ *
+ * @note The stack must be walked to get the backtrace, but the backtrace does
+ *   not need to be stored, the same backtraces are represented by the same
+ *   node of the calling context tree.
+ *
+ * @param tid A number identifying the thread.
+ * @return An identifier of a backtrace containing return addresses present on
+ *   the stack of the thread.
+ */
+BacktraceId getLightweightBacktraceId(THREADID tid)
+{
+  // Helper variables
+  Backtrace bt;
+  CallingContext* context = g_data.get(tid)->context;
+
+  getLightweightBacktrace(tid, bt);
+
+  for (Backtrace::reverse_iterator it = bt.rbegin(); it != bt.rend(); it++)
+  { // Descend from the outermost return address to the innermost one
+    context = context->enter(*it);
+  }
+
+  return reinterpret_cast< BacktraceId >(context);
+}
+
+/**
+ * Gets an identifier of a precise backtrace of a thread.
+ *
+ * @note The calling context tree is updated on calls and returns, so getting
+ *   the identifier is just a pointer copy.
+ *
+ * @param tid A number identifying the thread.
+ * @return An identifier of a backtrace containing indexes of function calls.
+ */
+BacktraceId getPreciseBacktraceId(THREADID tid)
+{
+  return reinterpret_cast< BacktraceId >(g_data.get(tid)->context);
 }
 
 /**
@@ -333,7 +498,7 @@ VOID getLightweightBacktraceSymbols(Backtrace& bt, Symbols& symbols)
 {
   for (Backtrace::size_type i = 0; i < bt.size(); i++)
   { // Get the source code location for the return address in the backtrace
-    symbols.push_back(makeBacktraceLocation< BV, FI_LOCKED >(bt[i]));
+    symbols.push_back(makeCachedBacktraceLocation< BV >(bt[i]));
   }
 }
 
@@ -388,11 +553,17 @@ VOID threadStarted(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v)
  */
 VOID threadFinished(THREADID tid, const CONTEXT* ctxt, INT32 code, VOID* v)
 {
+  // Deliver the accesses performed by the thread before it finished
+  flushAccessBatch(tid);
+
   BOOST_FOREACH(ThreadFinishedCallbackContainerType::const_reference callback,
     g_threadFinishedCallbacks)
   { // Call all callback functions registered by the user (used analyser)
     callback(tid);
   }
+
+  // Nobody needs the data of the thread anymore, the ID might be reused
+  freeThreadData(tid);
 }
 
 /**
@@ -474,13 +645,16 @@ VOID PIN_FAST_ANALYSIS_CALL afterUnwind(THREADID tid, ADDRINT sp)
   // need to delete this call from the backtrace too
   while (Compare()(g_data.get(tid)->btsplist.back(), sp))
   { // Backtrack to the call which executed the function where we are jumping
-    g_data.get(tid)->backtrace.pop_front();
+    g_data.get(tid)->context = g_data.get(tid)->context->parent;
     g_data.get(tid)->btsplist.pop_back();
 
+    // Deliver the accesses performed by the function we are returning from
+    flushAccessBatch(tid);
+
     BOOST_FOREACH(FunctionExitedCallbackContainerType::const_reference callback,
       g_functionExitedCallbacks)
-    { // Call all callback functions registered by the user (used analyser)
-      callback(tid);
+    { // We do not know which function is this, notify only unfiltered callbacks
+      if (callback.second == NULL) callback.first(tid);
     }
   }
 }
@@ -503,7 +677,7 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionCalled(THREADID tid, ADDRINT sp,
   CONSOLE("Thread " + decstr(tid) + ": beforeFunctionCalled: sp="
     + hexstr(sp) + ", call=" + *retrieveCall(idx)
     + " [call stack size is "
-    + decstr(g_data.get(tid)->backtrace.size()) + "]\n");
+    + decstr(g_data.get(tid)->context->depth) + "]\n");
 #endif
   if (!g_data.get(tid)->btsplist.empty())
     if (g_data.get(tid)->btsplist.back() < sp)
@@ -512,7 +686,7 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionCalled(THREADID tid, ADDRINT sp,
         + "] is lower than the current value of SP [" + hexstr(sp) + "]\n");
 
   // Add the call to be executed to the backtrace
-  g_data.get(tid)->backtrace.push_front(idx);
+  g_data.get(tid)->context = g_data.get(tid)->context->enter(idx);
   g_data.get(tid)->btsplist.push_back(sp - sizeof(ADDRINT));
 }
 
@@ -527,9 +701,12 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionCalled(THREADID tid, ADDRINT sp,
  */
 VOID afterFunctionExecuted(THREADID tid, ADDRINT* retVal, VOID* data)
 {
-  BOOST_FOREACH(FunctionExitedCallbackContainerType::const_reference callback,
-    g_functionExitedCallbacks)
-  { // Call all callback functions registered by the user (used analyser)
+  // Deliver the accesses performed by the function which finished
+  flushAccessBatch(tid);
+
+  BOOST_FOREACH(THREADFUNPTR callback,
+    static_cast< const FunctionCallbacks* >(data)->exited)
+  { // Call all callback functions interested in the function which finished
     callback(tid);
   }
 
@@ -548,9 +725,10 @@ VOID afterFunctionExecuted(THREADID tid, ADDRINT* retVal, VOID* data)
  * @param tid A number identifying the thread executing the function.
  * @param sp A value of the stack pointer register of the thread.
  * @param idx A position of the function in the function index.
+ * @param callbacks Callback functions interested in the function.
  */
 VOID PIN_FAST_ANALYSIS_CALL beforeFunctionExecuted(THREADID tid, ADDRINT sp,
-  ADDRINT idx)
+  ADDRINT idx, const FunctionCallbacks* callbacks)
 {
 #if ANACONDA_DEBUG_FUNCTION_TRACKING == 1
   CONSOLE("Thread " + decstr(tid) + ": beforeFunctionExecuted: sp="
@@ -567,14 +745,16 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionExecuted(THREADID tid, ADDRINT sp,
 #endif
   // If we fail to register the callback function, it means we are re-executing
   // the function without calling it and thus we should ignore this situation
-  if (REGISTER_AFTER_CALLBACK(afterFunctionExecuted, NULL)) return;
+  if (REGISTER_AFTER_CALLBACK(afterFunctionExecuted, (VOID*)callbacks)) return;
+
+  // Deliver the accesses performed by the function which is executing this one
+  flushAccessBatch(tid);
 
   // Add the function to be executed to the list of functions
   g_data.get(tid)->functions.push_back(idx);
 
-  BOOST_FOREACH(FunctionEnteredCallbackContainerType::const_reference callback,
-    g_functionEnteredCallbacks)
-  { // Call all callback functions registered by the user (used analyser)
+  BOOST_FOREACH(THREADFUNPTR callback, callbacks->entered)
+  { // Call all callback functions interested in the function to be executed
     callback(tid);
   }
 }
@@ -596,10 +776,10 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionReturned(THREADID tid, ADDRINT sp,
   CONSOLE("Thread " + decstr(tid) + ": beforeFunctionReturned: sp="
     + hexstr(sp) + ", instruction=" + *retrieveInstruction(idx)
     + " [call stack size is "
-    + decstr(g_data.get(tid)->backtrace.size()) + "]\n");
+    + decstr(g_data.get(tid)->context->depth) + "]\n");
 #endif
   // We can't have more returns than calls
-  assert(!g_data.get(tid)->backtrace.empty());
+  assert(g_data.get(tid)->context->parent != NULL);
 
   if (g_data.get(tid)->btsplist.back() != sp)
   { // We are not returning from the last function we called
@@ -610,7 +790,7 @@ VOID PIN_FAST_ANALYSIS_CALL beforeFunctionReturned(THREADID tid, ADDRINT sp,
   }
 
   // Return to the call which executed the function where we are returning
-  g_data.get(tid)->backtrace.pop_front();
+  g_data.get(tid)->context = g_data.get(tid)->context->parent;
   g_data.get(tid)->btsplist.pop_back();
 }
 
@@ -668,52 +848,37 @@ VOID afterThreadCreate(THREADID tid, ADDRINT* retVal, VOID* data)
   THREAD thread = mapArgTo< THREAD >(&g_data.get(tid)->arg,
     static_cast< HookInfo* >(data));
 
-  // Helper variables
-  ThreadCreationBarrier* barrier;
-
-  while ((barrier = g_threadCreationBarrier.get(thread.q())) == NULL)
-  { // Wait until the newly created thread gives us a barrier to synchronise
-    // with it, usually the barrier would be already there when we get here
-    // so the sleeping here will be very short (or does not occur at all)
-    PIN_Sleep(1);
-  }
-
-  // Wait for the newly created thread to determine the ID PIN assigned to it
-  barrier->waitForNew();
+  // Synchronise with the newly created thread (it might not run yet)
+  ThreadCreationSlot* slot = acquireThreadCreationSlot(thread);
 
   if (BT & BT_PRECISE)
   { // Top location in the backtrace is location where the thread was created
-    g_threadCreateLocMap.insert(
-      mapArgTo< THREAD >(&g_data.get(tid)->arg,
-        static_cast< HookInfo* >(data)).q(),
-      std::string() + *retrieveCall(g_data.get(tid)->backtrace.front())
-    );
+    slot->location = std::string()
+      + *retrieveCall(g_data.get(tid)->context->entry);
   }
 #if defined(TARGET_IA32) || defined(TARGET_LINUX)
   else if (BT & BT_LIGHTWEIGHT)
   {  // We already have the location where the thread was created from before
-    g_threadCreateLocMap.insert(
-      mapArgTo< THREAD >(&g_data.get(tid)->arg,
-        static_cast< HookInfo* >(data)).q(),
-      g_data.get(tid)->ltcloc
-    );
+    slot->location = g_data.get(tid)->ltcloc;
   }
 #endif
 
-  // We registered the location where the thread was started (created)
-  barrier->oldReady();
+  // We published the location where the thread was started (created)
+  PIN_SemaphoreSet(&slot->locationReady);
 
   // Wait for the newly created thread to finish its initialisation
-  barrier->waitForNew();
+  PIN_SemaphoreWait(&slot->threadReady);
 
   BOOST_FOREACH(ThreadForkedCallbackContainerType::const_reference callback,
     g_threadForkedCallbacks)
   { // Call all callback functions registered by the user (used analyser)
-    callback(tid, getThreadId(thread));
+    callback(tid, slot->tid);
   }
 
   // We notified all analysers that a new thread was created (forked)
-  barrier->oldReady();
+  PIN_SemaphoreSet(&slot->forkNotified);
+
+  releaseThreadCreationSlot(slot);
 
   // Signal the before callback that the thread creation finished
   g_data.get(tid)->arg = 0;
@@ -744,7 +909,7 @@ VOID beforeThreadCreate(CBSTACK_FUNC_PARAMS, ADDRINT* arg, HookInfo* hi)
   if (BT & BT_LIGHTWEIGHT)
   { // Return address of the thread creation function is now on top of the call
     // stack, but in the after callback we cannot get this info, we get it here
-    g_data.get(tid)->ltcloc = makeBacktraceLocation< BV_DETAILED, FI_LOCKED >(
+    g_data.get(tid)->ltcloc = makeCachedBacktraceLocation< BV_DETAILED >(
       STACK_VALUE(sp));
   }
 #endif
@@ -777,28 +942,24 @@ VOID beforeThreadInit(CBSTACK_FUNC_PARAMS, ADDRINT* arg, HookInfo* hi)
   // Create a mapping between the thread abstraction and ID given by PIN
   g_threadIdMap.insert(thread.q(), tid);
 
-  // We will use this object to synchronise with the thread that created us
-  ThreadCreationBarrier* barrier = new ThreadCreationBarrier();
+  // Synchronise with the thread which created us (it might still be creating)
+  ThreadCreationSlot* slot = acquireThreadCreationSlot(thread);
 
-  // Publish this object to all threads, only the one which created us will
-  // access it as only this thread knows thread abstraction representing us
-  g_threadCreationBarrier.update(thread.q(), barrier);
+  slot->tid = tid; // Publish our thread ID
 
-  barrier->newReady(); // We published our thread ID
-  barrier->waitForOld(); // We need to wait for our thread creation location
+  // We need to wait for our thread creation location
+  PIN_SemaphoreWait(&slot->locationReady);
 
   // Now we can associate the thread with the location where it was created
-  g_data.get(tid)->tcloc = g_threadCreateLocMap.get(thread.q());
+  g_data.get(tid)->tcloc = slot->location;
 
-  // The other thread already has a pointer to the barrier object so it is
-  // safe to reset it to NULL, if the thread object is reused, it will not
-  // find the pointer to the old (deleted) barrier object in the map now
-  g_threadCreationBarrier.update(thread.q(), NULL);
+  // We finished our initialisation
+  PIN_SemaphoreSet(&slot->threadReady);
 
-  barrier->newReady(); // We finished our initialisation
-  barrier->waitForOld(); // Wait until the other thread notifies analysers
+  // Wait until the other thread notifies analysers
+  PIN_SemaphoreWait(&slot->forkNotified);
 
-  delete barrier; // We do not need the barrier anymore
+  releaseThreadCreationSlot(slot);
 }
 
 /**
@@ -818,6 +979,7 @@ VOID setupThreadModule(Settings* settings)
 
     g_getBacktraceImpl = getPreciseBacktrace;
     g_getBacktraceSymbolsImpl = getPreciseBacktraceSymbols;
+    g_getBacktraceIdImpl = getPreciseBacktraceId;
   }
   else if (OPTION("backtrace.type") == "full")
   { // Full: create backtraces on the fly by monitoring execution of functions
@@ -830,6 +992,7 @@ VOID setupThreadModule(Settings* settings)
     g_beforeThreadCreateCallback = (AFUNPTR)beforeThreadCreate< BT_LIGHTWEIGHT >;
 
     g_getBacktraceImpl = getLightweightBacktrace;
+    g_getBacktraceIdImpl = getLightweightBacktraceId;
 
     if (settings->get< std::string >("backtrace.verbosity") == "minimal")
     { // Minimal: locations only
@@ -846,6 +1009,7 @@ VOID setupThreadModule(Settings* settings)
 
     g_getBacktraceImpl = [] (THREADID tid, Backtrace& bt) {};
     g_getBacktraceSymbolsImpl = [] (Backtrace& bt, Symbols& symbols) {};
+    g_getBacktraceIdImpl = [] (THREADID tid) -> BacktraceId { return 0; };
   }
 
   BOOST_FOREACH(HookInfo* hi, settings->getHooks())
@@ -896,6 +1060,8 @@ VOID setupThreadModule(Settings* settings)
   }
 
   g_predsMon = &settings->getCoverageMonitors().preds;
+
+  PIN_MutexInit(&g_threadCreationSlotsLock);
 }
 
 /**
@@ -922,6 +1088,59 @@ THREADID getThreadId(THREAD thread)
   return g_threadIdMap.get(thread.q());
 }
 
+/**
+ * Gets callback functions which should be called when a thread enters or exits
+ *   a function.
+ *
+ * @note This function is called when a function is instrumented, so the
+ *   filters of the callback functions are evaluated only once per function.
+ *
+ * @param idx An index of the function.
+ * @return A structure containing the callback functions or @em NULL if the
+ *   execution of the function does not need to be monitored.
+ */
+const FunctionCallbacks* getFunctionCallbacks(index_t idx)
+{
+  // Helper variables
+  FunctionCallbacks* callbacks = new FunctionCallbacks();
+  bool filtered = false;
+
+  BOOST_FOREACH(FunctionEnteredCallbackContainerType::const_reference callback,
+    g_functionEnteredCallbacks)
+  { // Include only callback functions interested in the function
+    if (callback.second != NULL) filtered = true;
+    if (callback.second == NULL || callback.second(idx))
+      callbacks->entered.push_back(callback.first);
+  }
+
+  BOOST_FOREACH(FunctionExitedCallbackContainerType::const_reference callback,
+    g_functionExitedCallbacks)
+  { // Include only callback functions interested in the function
+    if (callback.second != NULL) filtered = true;
+    if (callback.second == NULL || callback.second(idx))
+      callbacks->exited.push_back(callback.first);
+  }
+
+  if (!filtered)
+  { // All functions are monitored the same way, share the callback functions
+    if (g_unfilteredFunctionCallbacks == NULL)
+      g_unfilteredFunctionCallbacks = callbacks;
+    else
+      delete callbacks;
+
+    return g_unfilteredFunctionCallbacks;
+  }
+
+  if (callbacks->entered.empty() && callbacks->exited.empty())
+  { // Nobody is interested in this function, no need to monitor it
+    delete callbacks;
+
+    return NULL;
+  }
+
+  return callbacks;
+}
+
 /**
  * Gets a position of the last location (call) in a backtrace of a thread stored
  *   in the (call) index.
@@ -935,8 +1154,8 @@ THREADID getThreadId(THREAD thread)
  */
 index_t getLastBacktraceLocationIndex(THREADID tid)
 {
-  return (g_data.get(tid)->backtrace.empty()) ? -1
-    : g_data.get(tid)->backtrace.front();
+  return (g_data.get(tid)->context->parent == NULL) ? -1
+    : g_data.get(tid)->context->entry;
 }
 
 /**
@@ -950,8 +1169,8 @@ index_t getLastBacktraceLocationIndex(THREADID tid)
  */
 std::string getLastBacktraceLocation(THREADID tid)
 {
-  return (g_data.get(tid)->backtrace.empty()) ? "<unknown>"
-    : retrieveLocation(retrieveCall(g_data.get(tid)->backtrace.front())->location)->file;
+  return (g_data.get(tid)->context->parent == NULL) ? "<unknown>"
+    : retrieveLocation(retrieveCall(g_data.get(tid)->context->entry)->location)->file;
 }
 
 /**
@@ -962,7 +1181,7 @@ std::string getLastBacktraceLocation(THREADID tid)
  */
 size_t getBacktraceSize(THREADID tid)
 {
-  return g_data.get(tid)->backtrace.size();
+  return g_data.get(tid)->context->depth;
 }
 
 /**
@@ -1014,7 +1233,8 @@ VOID THREAD_ThreadForked(FORKFUNPTR callback)
  */
 VOID THREAD_FunctionEntered(THREADFUNPTR callback)
 {
-  g_functionEnteredCallbacks.push_back(callback);
+  g_functionEnteredCallbacks.push_back(std::make_pair(callback,
+    (FUNCTIONFILTERFUNPTR)NULL));
 }
 
 /**
@@ -1026,7 +1246,44 @@ VOID THREAD_FunctionEntered(THREADFUNPTR callback)
  */
 VOID THREAD_FunctionExited(THREADFUNPTR callback)
 {
-  g_functionExitedCallbacks.push_back(callback);
+  g_functionExitedCallbacks.push_back(std::make_pair(callback,
+    (FUNCTIONFILTERFUNPTR)NULL));
+}
+
+/**
+ * Registers a callback function which will be called when a thread enters a
+ *   function (starts execution of a function) accepted by a filter.
+ *
+ * @note The filter is evaluated once for each function when the function is
+ *   instrumented. Functions not accepted by the filters of any callbacks are
+ *   not monitored at all (if no unfiltered callbacks are registered).
+ *
+ * @param callback A callback function which should be called when a thread
+ *   enters a function accepted by the filter.
+ * @param filter A function returning @em true for indexes of the functions
+ *   the callback function should be called for.
+ */
+VOID THREAD_FunctionEntered(THREADFUNPTR callback, FUNCTIONFILTERFUNPTR filter)
+{
+  g_functionEnteredCallbacks.push_back(std::make_pair(callback, filter));
+}
+
+/**
+ * Registers a callback function which will be called when a thread exits a
+ *   function (finishes execution of a function) accepted by a filter.
+ *
+ * @note The filter is evaluated once for each function when the function is
+ *   instrumented. Functions not accepted by the filters of any callbacks are
+ *   not monitored at all (if no unfiltered callbacks are registered).
+ *
+ * @param callback A callback function which should be called when a thread
+ *   exits a function accepted by the filter.
+ * @param filter A function returning @em true for indexes of the functions
+ *   the callback function should be called for.
+ */
+VOID THREAD_FunctionExited(THREADFUNPTR callback, FUNCTIONFILTERFUNPTR filter)
+{
+  g_functionExitedCallbacks.push_back(std::make_pair(callback, filter));
 }
 
 /**
@@ -1123,6 +1380,41 @@ VOID THREAD_GetBacktraceSymbols(Backtrace& bt, Symbols& symbols)
   g_getBacktraceSymbolsImpl(bt, symbols);
 }
 
+/**
+ * Gets an identifier of a backtrace of a thread.
+ *
+ * @note The same backtraces of a thread have the same identifier. Identifiers
+ *   remain valid even after the thread finishes, so they may be stored instead
+ *   of the backtraces and translated to strings later.
+ *
+ * @param tid A number identifying the thread.
+ * @return An identifier of the backtrace or @c 0 if no backtraces are created.
+ */
+BacktraceId THREAD_GetBacktraceId(THREADID tid)
+{
+  return g_getBacktraceIdImpl(tid);
+}
+
+/**
+ * Translates entries in a backtrace identified by an identifier to strings
+ *   describing them.
+ *
+ * @param id An identifier of a backtrace.
+ * @param symbols A vector containing strings describing the entries in the
+ *   backtrace.
+ */
+VOID THREAD_GetBacktraceSymbols(BacktraceId id, Symbols& symbols)
+{
+  if (id == 0) return; // No backtraces are created
+
+  // Helper variables
+  Backtrace bt;
+
+  reinterpret_cast< CallingContext* >(id)->getBacktrace(bt);
+
+  g_getBacktraceSymbolsImpl(bt, symbols);
+}
+
 /**
  * Gets a location where a thread was created.
  *
@@ -1137,6 +1429,10 @@ VOID THREAD_GetThreadCreationLocation(THREADID tid, std::string& location)
 /**
  * Gets a function whose code is currently being executed in a specific thread.
  *
+ * @note If analysers are interested only in specific functions (registered the
+ *   function entered or exited callback functions with a filter), only these
+ *   functions are monitored and the innermost of them is returned.
+ *
  * @param tid A number identifying the thread executing the function.
  * @param function A backtrace location describing the function.
  */
@@ -1146,6 +1442,54 @@ VOID THREAD_GetCurrentFunction(THREADID tid, std::string& function)
     ? "" : retrieveFunction(g_data.get(tid)->functions.back())->name;
 }
 
+/**
+ * Gets an index of a function whose code is currently being executed in a
+ *   specific thread.
+ *
+ * @note Unlike @c THREAD_GetCurrentFunction, this function does not need to
+ *   construct any strings, so it can be used on hot paths (e.g., in callback
+ *   functions called each time a function is entered).
+ *
+ * @param tid A number identifying the thread executing the function.
+ * @return An index of the function or @c 0 (an index of an unknown function)
+ *   if the thread is not executing any known function.
+ */
+index_t THREAD_GetCurrentFunctionIndex(THREADID tid)
+{
+  return (g_data.get(tid)->functions.empty())
+    ? 0 : g_data.get(tid)->functions.back();
+}
+
+/**
+ * Gets a name of a function.
+ *
+ * @note Indexed functions are never removed, so the returned reference is
+ *   always valid.
+ *
+ * @param idx An index of the function.
+ * @return The name of the function or an empty string if the function is not
+ *   known.
+ */
+const std::string& THREAD_GetFunctionName(index_t idx)
+{
+  return retrieveFunction(idx)->name;
+}
+
+/**
+ * Gets a path to an image containing a function.
+ *
+ * @note Indexed images are never removed, so the returned reference is always
+ *   valid.
+ *
+ * @param idx An index of the function.
+ * @return The path to the image containing the function or an empty string if
+ *   the image is not known.
+ */
+const std::string& THREAD_GetFunctionImage(index_t idx)
+{
+  return retrieveImage(retrieveFunction(idx)->image)->path;
+}
+
 /**
  * Gets a number identifying the currently executed thread.
  *
@@ -26,8 +26,8 @@
  * @file      thread.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-02-03
- * @date      Last Update 2016-06-08
- * @version   0.13.1
+ * @date      Last Update 2026-10-15
+ * @version   0.13.2
  */
 
 #ifndef __PINTOOL_ANACONDA__CALLBACKS__THREAD_H__
@@ -35,9 +35,28 @@
 
 #include "pin.H"
 
+#include <vector>
+
+#include "../anaconda.h"
 #include "../config.h"
 #include "../settings.h"
 
+/**
+ * @brief A structure containing callback functions which should be called when
+ *   a thread enters or exits a specific function.
+ */
+typedef struct FunctionCallbacks_s
+{
+  /**
+   * @brief Functions called when a thread enters the function.
+   */
+  std::vector< THREADFUNPTR > entered;
+  /**
+   * @brief Functions called when a thread exits the function.
+   */
+  std::vector< THREADFUNPTR > exited;
+} FunctionCallbacks;
+
 // Definitions of analysis functions (callback functions called by PIN)
 VOID threadStarted(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v);
 VOID threadFinished(THREADID tid, const CONTEXT* ctxt, INT32 code, VOID* v);
@@ -48,13 +67,16 @@ VOID PIN_FAST_ANALYSIS_CALL beforeBasePtrPoped(THREADID tid, ADDRINT sp);
 VOID PIN_FAST_ANALYSIS_CALL beforeFunctionCalled(THREADID tid, ADDRINT sp,
   ADDRINT idx);
 VOID PIN_FAST_ANALYSIS_CALL beforeFunctionExecuted(THREADID tid, ADDRINT sp,
-  ADDRINT idx);
+  ADDRINT idx, const FunctionCallbacks* callbacks);
 VOID PIN_FAST_ANALYSIS_CALL beforeFunctionReturned(THREADID tid, ADDRINT sp,
   ADDRINT idx);
 
 // Definitions of functions for configuring thread monitoring
 VOID setupThreadModule(Settings* settings);
 
+// Definitions of helper functions
+const FunctionCallbacks* getFunctionCallbacks(index_t idx);
+
 #endif /* __PINTOOL_ANACONDA__CALLBACKS__THREAD_H__ */
 
 /** End of file thread.h **/
@@ -26,8 +26,8 @@
  * @file      cbstack.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-02-07
- * @date      Last Update 2019-02-17
- * @version   0.4.5
+ * @date      Last Update 2026-10-15
+ * @version   0.4.6
  */
 
 #include "cbstack.h"
@@ -36,6 +36,8 @@
 
 #include "defs.h"
 
+#include "utils/pin/tls.h"
+
 /**
  * @brief A structure containing information about an instrumented call.
  */
@@ -80,7 +82,7 @@ typedef std::deque< Call > CallbackStack;
 
 namespace
 { // Static global variables (usable only within this module)
-  TLS_KEY g_callbackStackTlsKey = PIN_CreateThreadDataKey(
+  TLS_KEY g_callbackStackTlsKey = TLS_CreateThreadDataKey(
     [] (VOID* stack) { delete static_cast< CallbackStack* >(stack); }
   );
 }
@@ -94,7 +96,7 @@ namespace
 inline
 CallbackStack* getCallbackStack(THREADID tid)
 {
-  return static_cast< CallbackStack* >(PIN_GetThreadData(g_callbackStackTlsKey,
+  return static_cast< CallbackStack* >(TLS_GetThreadData(g_callbackStackTlsKey,
     tid));
 }
 
@@ -109,7 +111,7 @@ CallbackStack* getCallbackStack(THREADID tid)
 VOID createCallbackStack(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v)
 {
   // Create a callback stack and store it in the TLS of the created thread
-  PIN_SetThreadData(g_callbackStackTlsKey, new CallbackStack(), tid);
+  TLS_SetThreadData(g_callbackStackTlsKey, new CallbackStack(), tid);
 }
 
 namespace cbstack
@@ -25,8 +25,8 @@
  * @file      defs.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-05-28
- * @date      Last Update 2016-06-10
- * @version   0.1.5
+ * @date      Last Update 2026-10-16
+ * @version   0.1.7
  */
 
 #ifndef __PINTOOL_ANACONDA__DEFS_H__
@@ -60,6 +60,9 @@
 #define PLUGIN_INIT_FUNCTION PLUGIN_FUNCTION(init)
 #define PLUGIN_FINISH_FUNCTION PLUGIN_FUNCTION(finish)
 
+// Size of a cache line, used to keep per-thread data on separate cache lines
+#define CACHE_LINE_SIZE 64
+
 // Definitions of error codes
 #define EREGISTERED 200
 
@@ -71,6 +74,40 @@
   #define PATH_SEP_CHAR_ALT '\\'
 #endif
 
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+/**
+ * Gets a position of the most significant bit set in a number.
+ *
+ * @warning The number must not be zero.
+ *
+ * @param value A number.
+ * @return The position of the most significant bit set in the number.
+ */
+inline
+unsigned int getMostSignificantBit(unsigned long long value)
+{
+#if defined(_MSC_VER)
+  // Helper variables
+  unsigned long pos;
+
+  #if defined(_M_X64)
+  _BitScanReverse64(&pos, value);
+  #else
+  // 32-bit compiler has no 64-bit bit scan, scan each half separately
+  if (_BitScanReverse(&pos, (unsigned long)(value >> 32))) return pos + 32;
+
+  _BitScanReverse(&pos, (unsigned long)value);
+  #endif
+
+  return pos;
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
 #if NDEBUG
   #define ASSERT_VARIABLE(x) (void)(x)
 #else
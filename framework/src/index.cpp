@@ -25,16 +25,20 @@
  * @file      index.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-07-27
- * @date      Last Update 2016-07-18
- * @version   0.5.2.1
+ * @date      Last Update 2026-10-16
+ * @version   0.7.2
  */
 
 #include "index.h"
 
 #include <assert.h>
+#include <stdlib.h>
 
+#include <atomic>
 #include <string>
-#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include "defs.h"
 
@@ -44,23 +48,156 @@
 /**
  * @brief An index which does not check for duplicate values.
  *
- * Stores the indexed values in a vector. Does not check if newly indexed values
- *   are already present in the index to speed up the index process.
+ * Stores the indexed values in a sequence of chunks which are never relocated
+ *   once allocated. Each chunk is twice as large as the previous one, so only
+ *   a small, fixed number of chunks is needed to cover the whole index space.
+ *   Does not check if newly indexed values are already present in the index to
+ *   speed up the index process.
+ *
+ * @note Writers are serialised by a lock, readers do not need any lock at all.
+ *   A value is published by incrementing the (atomic) size of the index after
+ *   the value is stored, so any index obtained from the indexObject method (or
+ *   lower than the size of the index) refers to a fully constructed value.
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-09-07
- * @date      Last Update 2016-04-28
- * @version   0.2.2
+ * @date      Last Update 2026-10-15
+ * @version   0.3
  */
 template < class ValueType >
-class FastIndexImpl : public RWLockableObject
+class FastIndexImpl : public LockableObject
 {
   protected: // Type definitions
-    typedef std::vector< ValueType > Index;
-    typedef typename Index::value_type value_type;
-    typedef typename Index::const_reference const_reference;
+    typedef ValueType value_type;
+    typedef const ValueType& const_reference;
+  protected: // Constants
+    /**
+     * @brief A binary logarithm of the number of values in the first chunk.
+     */
+    static const unsigned int FIRST_CHUNK_BITS = 10;
+    /**
+     * @brief A maximum number of chunks. Each chunk is twice as large as the
+     *   previous one, so this covers all indexes representable by @c index_t.
+     */
+    static const unsigned int MAX_CHUNKS = 8 * sizeof(index_t)
+      - FIRST_CHUNK_BITS;
   protected: // Internal variables
-    Index m_index; //!< A container holding the indexed values.
+    /**
+     * @brief Chunks holding the indexed values. Chunks are allocated on demand
+     *   and never relocated or freed while the index is in use.
+     */
+    std::atomic< value_type* > m_chunks[MAX_CHUNKS];
+    /**
+     * @brief A number of values published in the index.
+     */
+    std::atomic< index_t > m_size;
+  public: // Constructors
+    /**
+     * Constructs an empty index.
+     */
+    FastIndexImpl() : m_size(0)
+    {
+      for (unsigned int i = 0; i < MAX_CHUNKS; i++)
+      { // No chunks allocated yet, they are allocated when first needed
+        m_chunks[i].store(NULL, std::memory_order_relaxed);
+      }
+    }
+  public: // Destructors
+    /**
+     * Destroys the index and all chunks holding the indexed values.
+     */
+    ~FastIndexImpl()
+    {
+      for (unsigned int i = 0; i < MAX_CHUNKS; i++)
+      { // Each chunk was allocated as an array of values
+        delete [] m_chunks[i].load(std::memory_order_relaxed);
+      }
+    }
+  protected: // Internal inline generated methods
+    /**
+     * Gets a chunk holding a value stored at a specific position in the index
+     *   and the position of the value in the chunk.
+     *
+     * @param idx The position of the value in the index.
+     * @param offset A position of the value in the chunk.
+     * @return The number of the chunk holding the value.
+     */
+    inline
+    unsigned int locate(index_t idx, index_t& offset)
+    {
+      // Chunk k holds the values with indexes [2^(B+k) - 2^B, 2^(B+k+1) - 2^B)
+      UINT64 pos = (UINT64)idx + ((UINT64)1 << FIRST_CHUNK_BITS);
+      unsigned int msb = getMostSignificantBit(pos);
+
+      // Strip the most significant bit to get the position inside the chunk
+      offset = (index_t)(pos - ((UINT64)1 << msb));
+
+      return msb - FIRST_CHUNK_BITS;
+    }
+
+    /**
+     * Gets a reference to a value stored at a specific position in the index.
+     *
+     * @param idx The position of the value in the index.
+     * @return A reference to the value stored at the specified position.
+     */
+    inline
+    const_reference at(index_t idx)
+    {
+      // Only indexes returned by the indexObject method should be passed here
+      assert(idx < m_size.load(std::memory_order_acquire));
+
+      // Helper variables
+      index_t offset;
+
+      // The chunk was published before the size, no lock is needed here
+      unsigned int chunk = this->locate(idx, offset);
+
+      return m_chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+    /**
+     * Appends an object to the end of the index.
+     *
+     * @warning The caller must hold the lock guarding the index.
+     *
+     * @param obj A reference to the object to be stored in the index.
+     * @return The position of the object in the index.
+     */
+    inline
+    index_t append(const_reference obj)
+    {
+      // Do not check for duplicates, just index the value
+      index_t idx = m_size.load(std::memory_order_relaxed);
+
+      // Helper variables
+      index_t offset;
+
+      unsigned int chunk = this->locate(idx, offset);
+
+      if (chunk >= MAX_CHUNKS)
+      { // All indexes representable by index_t are used, cannot continue
+        CONSOLE_NOPREFIX("error: too many objects indexed, cannot index more "
+          "than " + decstr((UINT64)idx) + " objects of the same type.\n");
+        PIN_ExitProcess(EXIT_FAILURE);
+      }
+
+      value_type* values = m_chunks[chunk].load(std::memory_order_relaxed);
+
+      if (values == NULL)
+      { // First value in this chunk, allocate the chunk (it is never moved)
+        values = new value_type[(index_t)1 << (FIRST_CHUNK_BITS + chunk)];
+
+        m_chunks[chunk].store(values, std::memory_order_release);
+      }
+
+      values[offset] = obj;
+
+      // Publish the value, readers may access it from now on
+      m_size.store(idx + 1, std::memory_order_release);
+
+      return idx;
+    }
   public: // Inline generated methods
     /**
      * Stores an object in the index.
@@ -71,14 +208,10 @@ class FastIndexImpl : public RWLockableObject
     inline
     index_t indexObject(const_reference obj)
     {
-      // For now, assume we can index objects concurrently
-      ScopedWriteLock writelock(this->m_lock);
-
-      // Do not check for duplicates, just index the value
-      m_index.push_back(obj);
+      // Writers only contend with other writers, never with readers
+      ScopedLock writelock(this->m_lock);
 
-      // Index of the value is the position of the value in the vector
-      return m_index.size() - 1;
+      return this->append(obj);
     }
 
     /**
@@ -91,14 +224,7 @@ class FastIndexImpl : public RWLockableObject
     inline
     const_reference retrieveObject(index_t idx)
     {
-      // PIN uses non-thread-safe version of stdlib, ensure thread-safety here
-      ScopedReadLock readlock(this->m_lock);
-
-      // Only indexes returned by the indexObject method should be passed here
-      assert(idx < m_index.size());
-
-      // Return a reference to the object stored at the specified index
-      return m_index[idx];
+      return this->at(idx);
     }
 };
 
@@ -142,24 +268,142 @@ class FastIndex< std::string > : public FastIndexImpl< std::string >
     inline
     FastIndexImpl< std::string >::value_type retrieveObject(index_t idx)
     {
-      // PIN uses non-thread-safe version of stdlib, ensure thread-safety here
-      ScopedReadLock readlock(this->m_lock);
+      // Returning a C string forces compiler not to use CoW optimisations
+      return this->at(idx).c_str();
+    }
+};
 
-      // Only indexes returned by the indexObject method should be passed here
-      assert(idx < m_index.size());
+/**
+ * @brief A hash function for keys of the interning indexes.
+ *
+ * Keys are plain values (addresses, indexes, line numbers, pointers to interned
+ *   strings) or pairs of keys, which are hashed recursively.
+ */
+struct KeyHash
+{
+  /**
+   * Computes a hash of a plain key.
+   *
+   * @param key A key.
+   * @return The hash of the key.
+   */
+  template< typename KeyType >
+  size_t operator()(const KeyType& key) const
+  {
+    return std::hash< KeyType >()(key);
+  }
 
-      // Returning a C string forces compiler not to use CoW optimisations
-      return m_index[idx].c_str();
+  /**
+   * Computes a hash of a pair of keys.
+   *
+   * @param key A pair of keys.
+   * @return The hash of the pair of keys.
+   */
+  template< typename FirstType, typename SecondType >
+  size_t operator()(const std::pair< FirstType, SecondType >& key) const
+  {
+    size_t seed = (*this)(key.first);
+
+    // Same mixing as boost::hash_combine
+    return seed ^ ((*this)(key.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+  }
+};
+
+/**
+ * @brief An index which stores each distinct value only once.
+ *
+ * Values are identified by keys. When indexing a value whose key is already in
+ *   the index, the index of the previously stored value is returned and no new
+ *   value is created. Retrieving values is lock-free, the same way as for the
+ *   fast index.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+template < class KeyType, class ValueType >
+class InterningIndex : public FastIndex< ValueType >
+{
+  private: // Type definitions
+    typedef std::unordered_map< KeyType, index_t, KeyHash > KeyMap;
+  private: // Internal variables
+    KeyMap m_keys; //!< A map containing indexes of already indexed values.
+  public: // Inline generated methods
+    /**
+     * Stores an object identified by a key in the index, unless an object with
+     *   the same key is already present in the index.
+     *
+     * @tparam FactoryType A type of a function creating the object.
+     *
+     * @param key A key identifying the object.
+     * @param create A function creating the object. Called only if there is no
+     *   object with the same key in the index.
+     * @return The position of the object in the index.
+     */
+    template < typename FactoryType >
+    inline
+    index_t internObject(const KeyType& key, FactoryType create)
+    {
+      // Writers only contend with other writers, never with readers
+      ScopedLock writelock(this->m_lock);
+
+      typename KeyMap::iterator it = m_keys.find(key);
+
+      // The object was already indexed, share the existing entry
+      if (it != m_keys.end()) return it->second;
+
+      return m_keys[key] = this->append(create());
+    }
+};
+
+/**
+ * @brief A pool of interned strings.
+ *
+ * Each distinct string is stored only once. The stored strings are never freed
+ *   or moved, so references to them remain valid for the whole execution and
+ *   equal strings can be compared by comparing their addresses.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+class StringPool : public LockableObject
+{
+  private: // Internal variables
+    std::unordered_set< std::string > m_strings; //!< The interned strings.
+  public: // Inline generated methods
+    /**
+     * Gets an interned copy of a string.
+     *
+     * @param str A string.
+     * @return A reference to the interned copy of the string.
+     */
+    inline
+    const std::string& intern(const std::string& str)
+    {
+      ScopedLock writelock(this->m_lock);
+
+      // Nodes of unordered containers are never moved by rehashing
+      return *m_strings.insert(str).first;
     }
 };
 
 namespace
 { // Static global variables (usable only within this module)
-  FastIndex< const IMAGE* > g_imageIndex;
-  FastIndex< const FUNCTION* > g_functionIndex;
-  FastIndex< const CALL* > g_callIndex;
-  FastIndex< const INSTRUCTION* > g_instructionIndex;
-  FastIndex< const LOCATION* > g_locationIndex;
+  typedef const std::string* ImageKey; // Path
+  typedef std::pair< const std::string*, index_t > FunctionKey; // Sig, image
+  typedef std::pair< ADDRINT, std::pair< index_t, index_t > > InstructionKey;
+  typedef std::pair< const std::string*, INT32 > LocationKey; // File, line
+
+  InterningIndex< ImageKey, const IMAGE* > g_imageIndex;
+  InterningIndex< FunctionKey, const FUNCTION* > g_functionIndex;
+  InterningIndex< InstructionKey, const CALL* > g_callIndex;
+  InterningIndex< InstructionKey, const INSTRUCTION* > g_instructionIndex;
+  InterningIndex< LocationKey, const LOCATION* > g_locationIndex;
+
+  StringPool g_stringPool; // Stores file paths and names of functions
 
   std::string g_emptyString = ""; // Used for referencing unknown values
 }
@@ -192,6 +436,18 @@ ADDRINT getOffset(const INS ins)
   return INS_Address(ins) - IMG_LowAddress(image);
 }
 
+/**
+ * Gets an interned copy of a string. Equal strings are stored only once and
+ *   the returned reference remains valid for the whole execution.
+ *
+ * @param str A string.
+ * @return A reference to the interned copy of the string.
+ */
+const std::string& internString(const std::string& str)
+{
+  return g_stringPool.intern(str);
+}
+
 /**
  * Stores information about an image in the image index.
  *
@@ -253,6 +509,24 @@ index_t indexLocation(const LOCATION* location)
   return g_locationIndex.indexObject(location);
 }
 
+/**
+ * Stores information about a source code location in the location index.
+ *
+ * @param file A name of the file in which is the source code location situated.
+ * @param line A line number in the file in which is the source code location
+ *   situated.
+ * @return A position in the location index where the information about the
+ *   source code location were stored.
+ */
+index_t indexLocation(const std::string& file, INT32 line)
+{
+  // Locations with the same file and line share a single entry
+  const std::string& path = internString(file);
+
+  return g_locationIndex.internObject(LocationKey(&path, line), [&path, line]
+    () { return new LOCATION(path, line); });
+}
+
 /**
  * Stores information about an image in the image index.
  *
@@ -265,9 +539,12 @@ index_t indexImage(const IMG img)
   // At index 0 should be an entry representing an unknown image
   if (!IMG_Valid(img)) return 0;
 
-  return indexImage(new IMAGE(
-    IMG_Name(img)
-    ));
+  // Images with the same path share a single entry
+  const std::string& path = internString(IMG_Name(img));
+
+  return g_imageIndex.internObject(&path, [&path] () {
+    return new IMAGE(path);
+  });
 }
 
 /**
@@ -282,11 +559,16 @@ index_t indexFunction(const RTN rtn)
   // At index 0 should be an entry representing an unknown function
   if (!RTN_Valid(rtn)) return 0;
 
-  return indexFunction(new FUNCTION(
-    PIN_UndecorateSymbolName(RTN_Name(rtn), UNDECORATION_NAME_ONLY),
-    RTN_Name(rtn),
-    indexImage(SEC_Img(RTN_Sec(rtn)))
-    ));
+  // Functions with the same signature in the same image share a single entry
+  const std::string& signature = internString(RTN_Name(rtn));
+  index_t image = indexImage(SEC_Img(RTN_Sec(rtn)));
+
+  return g_functionIndex.internObject(FunctionKey(&signature, image),
+    [&signature, image] () {
+      // Undecorate the name only when the function is indexed for first time
+      return new FUNCTION(internString(PIN_UndecorateSymbolName(signature,
+        UNDECORATION_NAME_ONLY)), signature, image);
+    });
 }
 
 /**
@@ -298,11 +580,13 @@ index_t indexFunction(const RTN rtn)
  */
 index_t indexCall(const INS ins)
 {
-  return indexCall(new CALL(
-    getOffset(ins),
-    indexFunction(INS_Rtn(ins)),
-    indexLocation(ins)
-    ));
+  // Calls with the same offset, function and location share a single entry
+  InstructionKey key(getOffset(ins), std::make_pair(
+    indexFunction(INS_Rtn(ins)), indexLocation(ins)));
+
+  return g_callIndex.internObject(key, [&key] () {
+    return new CALL(key.first, key.second.first, key.second.second);
+  });
 }
 
 /**
@@ -314,11 +598,13 @@ index_t indexCall(const INS ins)
  */
 index_t indexInstruction(const INS ins)
 {
-  return indexInstruction(new INSTRUCTION(
-    getOffset(ins),
-    indexFunction(INS_Rtn(ins)),
-    indexLocation(ins)
-    ));
+  // Instructions with the same offset, function and location share an entry
+  InstructionKey key(getOffset(ins), std::make_pair(
+    indexFunction(INS_Rtn(ins)), indexLocation(ins)));
+
+  return g_instructionIndex.internObject(key, [&key] () {
+    return new INSTRUCTION(key.first, key.second.first, key.second.second);
+  });
 }
 
 /**
@@ -331,12 +617,13 @@ index_t indexInstruction(const INS ins)
  */
 index_t indexLocation(const INS ins)
 {
-  LOCATION* location = new LOCATION();
+  // Helper variables
+  INT32 line = -1;
+  std::string file;
 
-  PIN_GetSourceLocation(INS_Address(ins),
-    NULL, &location->line, &location->file);
+  PIN_GetSourceLocation(INS_Address(ins), NULL, &line, &file);
 
-  return indexLocation(location);
+  return indexLocation(file, line);
 }
 
 /**
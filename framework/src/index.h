@@ -25,8 +25,8 @@
  * @file      index.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-07-27
- * @date      Last Update 2016-05-16
- * @version   0.5.1
+ * @date      Last Update 2026-10-16
+ * @version   0.6.1
  */
 
 #ifndef __PINTOOL_ANACONDA__INDEX_H__
@@ -42,6 +42,7 @@ index_t indexFunction(const FUNCTION* function);
 index_t indexCall(const CALL* call);
 index_t indexInstruction(const INSTRUCTION* instruction);
 index_t indexLocation(const LOCATION* location);
+index_t indexLocation(const std::string& file, INT32 line);
 
 // Definitions of functions for indexing various (Intel PIN) data
 index_t indexImage(const IMG img);
@@ -50,6 +51,9 @@ index_t indexCall(const INS ins);
 index_t indexInstruction(const INS ins);
 index_t indexLocation(const INS ins);
 
+// Definitions of functions for interning strings
+const std::string& internString(const std::string& str);
+
 // Definitions of functions for accessing indexed data
 const IMAGE* retrieveImage(index_t idx);
 const FUNCTION* retrieveFunction(index_t idx);
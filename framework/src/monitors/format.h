@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Contains definitions of binary formats of coverage files.
+ *
+ * A file containing definitions of binary formats of coverage files. The files
+ *   are written in the native byte order of the machine which produced them.
+ *
+ * @note This file does not depend on PIN, so tools processing the coverage
+ *   files may include it too.
+ *
+ * @file      format.h
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.2
+ */
+
+#ifndef __PINTOOL_ANACONDA__MONITORS__FORMAT_H__
+  #define __PINTOOL_ANACONDA__MONITORS__FORMAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Magic numbers identifying binary coverage files (including the trailing NUL)
+#define SYNC_COVERAGE_MAGIC "ANCSYNC"
+#define SVARS_COVERAGE_MAGIC "ANCSVAR"
+#define PREDS_COVERAGE_MAGIC "ANCPRED"
+
+// Versions of the binary coverage formats
+#define SYNC_COVERAGE_VERSION 1
+#define SVARS_COVERAGE_VERSION 1
+#define PREDS_COVERAGE_VERSION 1
+
+/**
+ * @brief An enumeration of types of events which might occur when monitoring
+ *   synchronisation coverage.
+ */
+typedef enum SyncCoverageEvent_e
+{
+  /**
+   * @brief Thread reached a synchronisation function.
+   */
+  SCE_VISITED,
+  /**
+   * @brief Thread T_1 was blocked by thread T_2 while attempting to acquire
+   *   a lock which is currently acquired by thread T_2.
+   */
+  SCE_BLOCKED,
+  /**
+   * @brief Thread T_1 is blocking thread T_2 because thread T_2 attempted to
+   *   acquire the same lock which is currently acquired by thread T_1.
+   */
+  SCE_BLOCKING,
+  /**
+   * @brief A number of types of events.
+   */
+  SCE_COUNT
+} SyncCoverageEvent;
+
+/**
+ * @brief A structure representing a header of a synchronisation coverage file.
+ *
+ * The header is followed by @c records records (see SyncCoverageRecord) and
+ *   then by @c functions NUL-terminated names of functions. The n-th name is
+ *   the name of the function with index n.
+ */
+typedef struct SyncCoverageHeader_s
+{
+  char magic[8]; //!< A magic number (@c SYNC_COVERAGE_MAGIC).
+  uint32_t version; //!< A version of the format.
+  uint32_t functions; //!< A number of names of functions.
+  uint64_t records; //!< A number of records.
+} SyncCoverageHeader;
+
+/**
+ * @brief A structure representing a number of events of a specific type which
+ *   occurred in a specific function.
+ */
+typedef struct SyncCoverageRecord_s
+{
+  uint32_t function; //!< An index of the function.
+  uint32_t event; //!< A type of the event (an item of SyncCoverageEvent).
+  uint64_t count; //!< A number of times the event occurred.
+} SyncCoverageRecord;
+
+/**
+ * @brief A structure representing a header of a shared variables file.
+ *
+ * The header is followed by @c addresses addresses (see SvarsCoverageAddress)
+ *   sorted by the address, @c variables offsets of the names of the variables
+ *   sorted by the name and @c strings bytes containing the NUL-terminated names
+ *   of the variables. The n-th name is the name of the variable with ID n.
+ *
+ * @note The file is designed to be memory-mapped and queried in place.
+ */
+typedef struct SvarsCoverageHeader_s
+{
+  char magic[8]; //!< A magic number (@c SVARS_COVERAGE_MAGIC).
+  uint32_t version; //!< A version of the format.
+  uint32_t variables; //!< A number of shared variables.
+  uint64_t addresses; //!< A number of addresses of shared variables.
+  uint64_t strings; //!< A size of the names of shared variables in bytes.
+} SvarsCoverageHeader;
+
+/**
+ * @brief A structure representing an address of a shared variable.
+ */
+typedef struct SvarsCoverageAddress_s
+{
+  uint64_t addr; //!< An address of the shared variable.
+  uint32_t variable; //!< An ID of the shared variable.
+  uint32_t reserved; //!< Reserved (keeps the addresses aligned).
+} SvarsCoverageAddress;
+
+/**
+ * @brief A structure representing a header of a predecessors file.
+ *
+ * The header is followed by @c instructions addresses (64-bit integers) of
+ *   instructions with predecessors sorted in ascending order.
+ *
+ * @note The file is designed to be memory-mapped and queried in place.
+ */
+typedef struct PredsCoverageHeader_s
+{
+  char magic[8]; //!< A magic number (@c PREDS_COVERAGE_MAGIC).
+  uint32_t version; //!< A version of the format.
+  uint32_t reserved; //!< Reserved (keeps the instructions aligned).
+  uint64_t instructions; //!< A number of instructions with predecessors.
+} PredsCoverageHeader;
+
+/**
+ * Checks if a block of memory starts with a specific magic number.
+ *
+ * @param data A block of memory.
+ * @param size A size of the block of memory in bytes.
+ * @param magic A magic number (including the trailing NUL character).
+ * @return @em True if the block of memory starts with the magic number, @em
+ *   false otherwise.
+ */
+inline
+bool hasCoverageMagic(const void* data, size_t size, const char* magic)
+{
+  return size >= 8 && memcmp(data, magic, 8) == 0;
+}
+
+/**
+ * Gets addresses of shared variables stored in a shared variables file.
+ *
+ * @param header A header of a shared variables file.
+ * @return The addresses of the shared variables.
+ */
+inline
+const SvarsCoverageAddress* getSvarsCoverageAddresses(
+  const SvarsCoverageHeader* header)
+{
+  return reinterpret_cast< const SvarsCoverageAddress* >(header + 1);
+}
+
+/**
+ * Gets offsets of names of shared variables stored in a shared variables file.
+ *
+ * @param header A header of a shared variables file.
+ * @return The offsets of the names of the shared variables.
+ */
+inline
+const uint32_t* getSvarsCoverageVariables(const SvarsCoverageHeader* header)
+{
+  return reinterpret_cast< const uint32_t* >(
+    getSvarsCoverageAddresses(header) + header->addresses);
+}
+
+/**
+ * Gets names of shared variables stored in a shared variables file.
+ *
+ * @param header A header of a shared variables file.
+ * @return The names of the shared variables.
+ */
+inline
+const char* getSvarsCoverageStrings(const SvarsCoverageHeader* header)
+{
+  return reinterpret_cast< const char* >(
+    getSvarsCoverageVariables(header) + header->variables);
+}
+
+/**
+ * Checks if a block of memory contains a valid shared variables file.
+ *
+ * @param data A block of memory.
+ * @param size A size of the block of memory in bytes.
+ * @return The header of the shared variables file or @em NULL if the block of
+ *   memory does not contain a valid shared variables file.
+ */
+inline
+const SvarsCoverageHeader* getSvarsCoverage(const void* data, size_t size)
+{
+  // Helper variables
+  const SvarsCoverageHeader* header
+    = static_cast< const SvarsCoverageHeader* >(data);
+
+  if (size < sizeof(SvarsCoverageHeader)) return NULL;
+  if (!hasCoverageMagic(data, size, SVARS_COVERAGE_MAGIC)) return NULL;
+  if (header->version != SVARS_COVERAGE_VERSION) return NULL;
+
+  // Check the sizes first, so the computations below cannot overflow
+  if (header->addresses > size || header->strings > size) return NULL;
+
+  if (sizeof(SvarsCoverageHeader)
+    + header->addresses * sizeof(SvarsCoverageAddress)
+    + header->variables * sizeof(uint32_t) + header->strings != size)
+    return NULL;
+
+  // Helper variables
+  const SvarsCoverageAddress* addresses = getSvarsCoverageAddresses(header);
+  const uint32_t* variables = getSvarsCoverageVariables(header);
+
+  for (uint64_t i = 0; i < header->addresses; i++)
+  { // Each address must reference an existing variable
+    if (addresses[i].variable >= header->variables) return NULL;
+  }
+
+  for (uint32_t i = 0; i < header->variables; i++)
+  { // Each name must lie within the strings
+    if (variables[i] >= header->strings) return NULL;
+  }
+
+  // The last name must be terminated, so all of them are terminated
+  if (header->strings != 0
+    && getSvarsCoverageStrings(header)[header->strings - 1] != '\0')
+    return NULL;
+
+  return header;
+}
+
+/**
+ * Gets instructions with predecessors stored in a predecessors file.
+ *
+ * @param header A header of a predecessors file.
+ * @return The addresses of the instructions with predecessors.
+ */
+inline
+const uint64_t* getPredsCoverageInstructions(const PredsCoverageHeader* header)
+{
+  return reinterpret_cast< const uint64_t* >(header + 1);
+}
+
+/**
+ * Checks if a block of memory contains a valid predecessors file.
+ *
+ * @param data A block of memory.
+ * @param size A size of the block of memory in bytes.
+ * @return The header of the predecessors file or @em NULL if the block of
+ *   memory does not contain a valid predecessors file.
+ */
+inline
+const PredsCoverageHeader* getPredsCoverage(const void* data, size_t size)
+{
+  // Helper variables
+  const PredsCoverageHeader* header
+    = static_cast< const PredsCoverageHeader* >(data);
+
+  if (size < sizeof(PredsCoverageHeader)) return NULL;
+  if (!hasCoverageMagic(data, size, PREDS_COVERAGE_MAGIC)) return NULL;
+  if (header->version != PREDS_COVERAGE_VERSION) return NULL;
+
+  // Check the size first, so the computation below cannot overflow
+  if (header->instructions > size) return NULL;
+
+  if (sizeof(PredsCoverageHeader) + header->instructions * sizeof(uint64_t)
+    != size) return NULL;
+
+  return header;
+}
+
+#endif /* __PINTOOL_ANACONDA__MONITORS__FORMAT_H__ */
+
+/** End of file format.h **/
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2013-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2013-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -25,70 +25,152 @@
  * @file      preds.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-04-05
- * @date      Last Update 2013-09-24
- * @version   0.3
+ * @date      Last Update 2026-10-15
+ * @version   0.5
  */
 
 #ifndef __PINTOOL_ANACONDA__MONITORS__PREDS_HPP__
   #define __PINTOOL_ANACONDA__MONITORS__PREDS_HPP__
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
-#include <list>
-#include <set>
+#include <vector>
 
 #include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include "pin.H"
 
+#include "format.h"
+
 #include "../types.h"
 
-#include "../utils/scopedlock.hpp"
 #include "../utils/tldata.hpp"
 
+// Initial number of slots of a table of variables accessed by a thread
+#define PREDS_INITIAL_TABLE_SIZE 1024
+// Number of instructions a thread buffers before publishing them
+#define PREDS_BUFFER_SIZE 64
+// Number of buckets of the set of instructions with predecessors
+#define PREDS_SET_BUCKETS 16384
+
 /**
  * @brief A class monitoring predecessors.
  *
- * Monitors predecessors.
+ * Monitors predecessors. Each thread keeps the addresses of variables it
+ *   accessed in an open-addressing hash table. Each entry is tagged with the
+ *   generation of the function execution which accessed the variable, so
+ *   leaving a function only discards its generation and all of its entries
+ *   become free slots at once. Instructions found to have a predecessor are
+ *   buffered by each thread and published in batches to a lock-free set.
+ *
+ * The instructions are written in a binary format (see format.h). Instructions
+ *   loaded from a binary file are queried directly in the memory to which the
+ *   file is mapped.
  *
  * @tparam Writer A class used for writing the output.
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-04-05
- * @date      Last Update 2013-09-24
- * @version   0.3
+ * @date      Last Update 2026-10-15
+ * @version   0.5
  */
 template< typename Writer >
 class PredecessorsMonitor : public Writer
 {
   private: // Type definitions
-    typedef std::set< ADDRINT > PredecessorSet;
+    /**
+     * @brief A structure representing a variable accessed by a thread.
+     */
+    typedef struct Slot_s
+    {
+      ADDRINT addr; //!< An address on which is the variable stored.
+      UINT32 gen; //!< A generation of the function (0 if the slot is empty).
+      UINT32 depth; //!< A depth of the function in the call stack.
+    } Slot;
+
+    /**
+     * @brief A structure representing an instruction with a predecessor.
+     */
+    typedef struct Node_s
+    {
+      ADDRINT ins; //!< An address of the instruction.
+      Node_s* next; //!< The next instruction in the same bucket.
+
+      /**
+       * Constructs a Node_s object.
+       *
+       * @param i An address of the instruction.
+       */
+      Node_s(ADDRINT i) : ins(i), next(NULL) {}
+    } Node;
+
     /**
      * @brief A structure holding private data of a thread.
      */
     typedef struct ThreadData_s
     {
+      Slot* slots; //!< A table of variables accessed by the thread.
+      UINT32 size; //!< A number of slots in the table (a power of 2).
+      UINT32 used; //!< A number of non-empty slots in the table.
+      UINT32 gen; //!< The last generation given to a function.
       /**
-       * @brief A set of variables accessed by a thread in a single function.
+       * @brief Generations of the functions currently executed by the thread.
        */
-      std::list< std::set< std::string > > vars;
+      std::vector< UINT32 > frames;
+      /**
+       * @brief Instructions with predecessors not published yet.
+       */
+      std::vector< ADDRINT > found;
+      /**
+       * @brief A monitor to which the buffered instructions are published.
+       */
+      PredecessorsMonitor* monitor;
 
       /**
        * Constructs a ThreadData_s object.
        */
-      ThreadData_s() : vars()
+      ThreadData_s() : slots(new Slot[PREDS_INITIAL_TABLE_SIZE]()),
+        size(PREDS_INITIAL_TABLE_SIZE), used(0), gen(1), frames(1, 1),
+        found(), monitor(NULL) {}
+
+      /**
+       * Destroys a ThreadData_s object and publishes all instructions with
+       *   predecessors found by the thread.
+       */
+      ~ThreadData_s()
       {
-        vars.push_back(std::set< std::string >());
+        if (monitor != NULL) monitor->publish(this);
+
+        delete[] slots;
       }
     } ThreadData;
   private: // Internal variables
-    PredecessorSet m_pSet; //!< A set containing instructions with predecessors.
-    PIN_RWMUTEX m_pSetLock; //!< A lock guarding access to the predecessor set.
+    /**
+     * @brief Chains of instructions with predecessors (the most recently
+     *   inserted first).
+     */
+    std::atomic< Node* > m_buckets[PREDS_SET_BUCKETS];
     ThreadLocalData< ThreadData > m_data; //!< Private data of running threads.
+    /**
+     * @brief A memory region to which a binary file is mapped.
+     */
+    boost::interprocess::mapped_region m_region;
+    /**
+     * @brief A header of instructions loaded from a binary file.
+     */
+    const PredsCoverageHeader* m_mapped;
   public: // Constructors
     /**
      * Constructs a PredecessorsMonitor object.
      */
-    PredecessorsMonitor() { PIN_RWMutexInit(&m_pSetLock); }
+    PredecessorsMonitor() : m_mapped(NULL)
+    {
+      for (int i = 0; i < PREDS_SET_BUCKETS; i++)
+        m_buckets[i].store(NULL, std::memory_order_relaxed);
+    }
   public: // Destructors
     /**
      * Destroys a PredecessorsMonitor object and writes addresses of all
@@ -96,11 +178,60 @@ class PredecessorsMonitor : public Writer
      */
     ~PredecessorsMonitor()
     {
-      PIN_RWMutexFini(&m_pSetLock);
+      for (THREADID tid = 0; tid < PIN_MAX_THREADS; tid++)
+      { // Publish the instructions buffered by threads which are still running
+        ThreadData* data = m_data.get(tid);
+
+        if (data == NULL || data->monitor == NULL) continue;
+
+        this->publish(data);
+
+        data->monitor = NULL; // Do not publish anything when the thread ends
+      }
+
+      // Helper variables
+      std::vector< ADDRINT > instructions;
+
+      for (int i = 0; i < PREDS_SET_BUCKETS; i++)
+      { // No thread is publishing instructions now, free all of the nodes
+        Node* node = m_buckets[i].load(std::memory_order_relaxed);
 
-      BOOST_FOREACH(PredecessorSet::const_reference addr, m_pSet)
+        while (node != NULL)
+        { // Nodes are allocated one by one, free them one by one
+          Node* next = node->next;
+          instructions.push_back(node->ins);
+          delete node;
+          node = next;
+        }
+      }
+
+      if (m_mapped != NULL)
+      { // Instructions from previous runs have predecessors in this run too
+        instructions.insert(instructions.end(),
+          getPredsCoverageInstructions(m_mapped),
+          getPredsCoverageInstructions(m_mapped) + m_mapped->instructions);
+      }
+
+      // The instructions must be sorted, so they can be searched in place
+      std::sort(instructions.begin(), instructions.end());
+      instructions.erase(std::unique(instructions.begin(), instructions.end()),
+        instructions.end());
+
+      // Helper variables
+      PredsCoverageHeader header;
+
+      memcpy(header.magic, PREDS_COVERAGE_MAGIC, sizeof(header.magic));
+      header.version = PREDS_COVERAGE_VERSION;
+      header.reserved = 0;
+      header.instructions = instructions.size();
+
+      this->write(&header, sizeof(header));
+
+      BOOST_FOREACH(ADDRINT addr, instructions)
       { // Write addresses of instructions which have a predecessor to output
-        this->writeln(hexstr(addr));
+        uint64_t ins = addr;
+
+        this->write(&ins, sizeof(ins));
       }
     }
 
@@ -108,15 +239,39 @@ class PredecessorsMonitor : public Writer
     /**
      * Loads instructions with predecessors from a file.
      *
+     * @note The format of the file is detected automatically. Binary files are
+     *   mapped to the memory, text files contain one address per line.
+     *
      * @note This method does not check the existence of the file, if required,
      *   it should be done before calling this method.
      *
      * @param path A path to a file containing instructions with predecessors.
+     * @return @em True if the instructions were loaded, @em false if the file
+     *   is a corrupted binary file.
      */
-    void load(const std::string& path)
+    bool load(const std::string& path)
     {
       // Extract info about instructions with predecessors from a previous run
-      std::fstream f(path, std::fstream::in);
+      std::fstream f(path, std::fstream::in | std::fstream::binary);
+
+      // Helper variables
+      char magic[8];
+
+      if (f.read(magic, sizeof(magic))
+        && hasCoverageMagic(magic, sizeof(magic), PREDS_COVERAGE_MAGIC))
+      { // Binary file, map it to the memory and query it there
+        boost::interprocess::file_mapping file(path.c_str(),
+          boost::interprocess::read_only);
+        boost::interprocess::mapped_region(file,
+          boost::interprocess::read_only).swap(m_region);
+
+        return (m_mapped = getPredsCoverage(m_region.get_address(),
+          m_region.get_size())) != NULL;
+      }
+
+      // Text file, read it again in the text mode
+      f.close();
+      f.open(path, std::fstream::in);
 
       // Helper variables
       std::string line;
@@ -125,13 +280,15 @@ class PredecessorsMonitor : public Writer
       { // Each line contains an address of one instruction with a predecessor
         if (line.empty()) continue;
 
-        m_pSet.insert(AddrintFromString(line));
+        this->insert(AddrintFromString(line));
       }
+
+      return true;
     }
 
   public: // Methods monitoring the predecessors
     /**
-     * Creates an empty set of variables accessed in a function.
+     * Starts a new generation of variables accessed in a function.
      *
      * @note This method is called before a thread enters a function.
      *
@@ -139,11 +296,22 @@ class PredecessorsMonitor : public Writer
      */
     void beforeFunctionEntered(THREADID tid)
     {
-      m_data.get(tid)->vars.push_back(std::set< std::string >());
+      ThreadData* data = m_data.get(tid);
+
+      if (++data->gen == 0)
+      { // Generations wrapped around, old entries might look valid again
+        std::fill(data->slots, data->slots + data->size, Slot());
+        std::fill(data->frames.begin(), data->frames.end(), 1);
+
+        data->used = 0;
+        data->gen = 2;
+      }
+
+      data->frames.push_back(data->gen);
     }
 
     /**
-     * Deletes a set of variables accessed in a function.
+     * Discards a generation of variables accessed in a function.
      *
      * @note This method is called before a thread leaves a function.
      *
@@ -151,7 +319,10 @@ class PredecessorsMonitor : public Writer
      */
     void beforeFunctionExited(THREADID tid)
     {
-      m_data.get(tid)->vars.pop_back();
+      ThreadData* data = m_data.get(tid);
+
+      // The outermost generation holds accesses made outside of any function
+      if (data->frames.size() > 1) data->frames.pop_back();
     }
 
     /**
@@ -161,45 +332,231 @@ class PredecessorsMonitor : public Writer
      *
      * @param tid A thread accessing a variable.
      * @param addr An address at which is the variable stored.
-     * @param var A variable accessed by the thread.
      * @param ins An address of the instruction accessing the variable.
      * @param isLocal @em True if the variable is a local variable, @em false
      *   otherwise.
      */
-    void beforeVariableAccessed(THREADID tid, ADDRINT addr, VARIABLE var,
-      ADDRINT ins, BOOL isLocal)
+    void beforeVariableAccessed(THREADID tid, ADDRINT addr, ADDRINT ins,
+      BOOL isLocal)
     {
       if (isLocal) return; // Local variable cannot be shared between threads
 
-      std::set< std::string >& vSet = m_data.get(tid)->vars.back();
+      ThreadData* data = m_data.get(tid);
 
-      if (vSet.find(var.name.empty() ? hexstr(addr) : var.name) != vSet.end())
-      { // This variable was accessed before
-        ScopedWriteLock wrtlock(m_pSetLock);
+      if (!this->accessed(data, addr)) return; // Not accessed before
 
-        m_pSet.insert(ins); // The instruction has a predecessor
-      }
-      else
-      { // This variable was not accessed before, remember it
-        vSet.insert(var.name.empty() ? hexstr(addr) : var.name);
-      }
+      // The instruction has a predecessor, publish it if not published yet
+      if (this->hasPredecessor(ins)) return;
+
+      data->found.push_back(ins);
+      data->monitor = this;
+
+      if (data->found.size() >= PREDS_BUFFER_SIZE) this->publish(data);
     }
 
   public: // Methods for checking instructions
     /**
      * Checks if an instruction has a predecessor.
      *
+     * @note Instructions buffered by the threads are not visible until they are
+     *   published.
+     *
      * @param ins An address of an instruction.
      * @return @em True if the instruction has a predecessor, @em false
      *   otherwise.
      */
     bool hasPredecessor(ADDRINT ins)
     {
-      // Other threads might be reading from the map with us, no problem
-      ScopedReadLock rdlock(m_pSetLock);
+      if (m_mapped != NULL && std::binary_search(
+        getPredsCoverageInstructions(m_mapped),
+        getPredsCoverageInstructions(m_mapped) + m_mapped->instructions,
+        (uint64_t)ins)) return true; // Loaded from a binary file
+
+      return this->find(ins, this->bucket(ins).load(std::memory_order_acquire),
+        NULL);
+    }
+
+  private: // Internal helper methods for tracking accessed variables
+    /**
+     * Checks if a slot belongs to a function which is still being executed.
+     *
+     * @param data Private data of a thread owning the slot.
+     * @param slot A non-empty slot.
+     * @return @em True if the slot holds a variable accessed by a function
+     *   which is still being executed, @em false otherwise.
+     */
+    static bool isLive(const ThreadData* data, const Slot& slot)
+    {
+      return slot.depth < data->frames.size()
+        && data->frames[slot.depth] == slot.gen;
+    }
+
+    /**
+     * Checks if a thread accessed a variable in the function it is currently
+     *   executing and marks the variable as accessed if it did not.
+     *
+     * @note Entries of a function cannot be placed behind the entries of the
+     *   functions it called, so the search may stop at the first empty slot or
+     *   a slot of a function which is no longer executed.
+     *
+     * @param data Private data of the thread.
+     * @param addr An address at which is the variable stored.
+     * @return @em True if the thread accessed the variable before, @em false
+     *   otherwise.
+     */
+    bool accessed(ThreadData* data, ADDRINT addr)
+    {
+      // Helper variables
+      UINT32 gen = data->frames.back();
+      UINT32 depth = data->frames.size() - 1;
+      UINT32 mask = data->size - 1;
+
+      for (UINT32 i = hash(addr) & mask; ; i = (i + 1) & mask)
+      { // Linear probing, the table is never more than half full
+        Slot& slot = data->slots[i];
+
+        if (slot.gen == 0 || !isLive(data, slot))
+        { // First access to the variable in the function, reuse the slot
+          if (slot.gen == 0) ++data->used;
+
+          slot.addr = addr;
+          slot.gen = gen;
+          slot.depth = depth;
+
+          if (2 * data->used > data->size) this->rehash(data);
+
+          return false;
+        }
+
+        if (slot.addr == addr && slot.gen == gen && slot.depth == depth)
+          return true;
+      }
+    }
+
+    /**
+     * Moves entries of functions still being executed to a new table, which
+     *   is twice as large if these entries fill more than a quarter of it.
+     *
+     * @param data Private data of a thread owning the table.
+     */
+    void rehash(ThreadData* data)
+    {
+      // Helper variables
+      std::vector< Slot > live;
+
+      for (UINT32 i = 0; i < data->size; i++)
+      { // Entries of functions which are not executed anymore are dropped
+        if (data->slots[i].gen != 0 && isLive(data, data->slots[i]))
+          live.push_back(data->slots[i]);
+      }
+
+      // Entries of outer functions must precede those of the called ones
+      std::stable_sort(live.begin(), live.end(),
+        [] (const Slot& a, const Slot& b) { return a.depth < b.depth; });
+
+      if (4 * live.size() > data->size)
+      { // Too many valid entries, the table needs to grow
+        data->size *= 2;
+      }
+
+      delete[] data->slots;
+      data->slots = new Slot[data->size]();
+      data->used = live.size();
+
+      // Helper variables
+      UINT32 mask = data->size - 1;
+
+      BOOST_FOREACH(const Slot& slot, live)
+      { // The new table contains only valid entries, use the first empty slot
+        UINT32 i = hash(slot.addr) & mask;
+
+        while (data->slots[i].gen != 0) i = (i + 1) & mask;
+
+        data->slots[i] = slot;
+      }
+    }
+
+    /**
+     * Computes a hash of an address.
+     *
+     * @param addr An address.
+     * @return The hash of the address.
+     */
+    static UINT32 hash(ADDRINT addr)
+    {
+      return (UINT32)((addr >> 3) ^ (addr >> 17));
+    }
+
+  private: // Internal helper methods for publishing instructions
+    /**
+     * Publishes all instructions with predecessors buffered by a thread.
+     *
+     * @param data Private data of the thread.
+     */
+    void publish(ThreadData* data)
+    {
+      BOOST_FOREACH(ADDRINT ins, data->found)
+      { // Other threads might have published some of them in the meantime
+        this->insert(ins);
+      }
+
+      data->found.clear();
+    }
+
+    /**
+     * Gets a bucket in which an instruction is stored.
+     *
+     * @param ins An address of the instruction.
+     * @return The bucket in which the instruction is stored.
+     */
+    std::atomic< Node* >& bucket(ADDRINT ins)
+    {
+      return m_buckets[(ins ^ (ins >> 14)) % PREDS_SET_BUCKETS];
+    }
+
+    /**
+     * Searches a part of a chain of instructions for an instruction.
+     *
+     * @param ins An address of the instruction.
+     * @param first The first node to check.
+     * @param last The node at which the search stops (not checked).
+     * @return @em True if the instruction was found, @em false otherwise.
+     */
+    bool find(ADDRINT ins, const Node* first, const Node* last)
+    {
+      for (const Node* n = first; n != last; n = n->next)
+      { // The nodes are immutable after they are inserted, no locks needed
+        if (n->ins == ins) return true;
+      }
+
+      return false;
+    }
+
+    /**
+     * Inserts an instruction into the set of instructions with predecessors.
+     *
+     * @param ins An address of the instruction.
+     */
+    void insert(ADDRINT ins)
+    {
+      // Helper variables
+      std::atomic< Node* >& bucket = this->bucket(ins);
+      Node* node = new Node(ins);
+      Node* head = bucket.load(std::memory_order_acquire);
+
+      do
+      { // Nodes are only prepended, check only the ones added since the
+        // last attempt, older nodes were checked before
+        if (this->find(ins, head, node->next))
+        { // Some other thread was faster, nothing to do
+          delete node;
+
+          return;
+        }
 
-      // If the instruction is in the predecessor set, it has a predecessor
-      return m_pSet.find(ins) != m_pSet.end();
+        node->next = head;
+      } while (!bucket.compare_exchange_weak(head, node,
+        std::memory_order_release, std::memory_order_acquire));
     }
 };
 
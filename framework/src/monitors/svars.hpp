@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2013-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2013-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -25,62 +25,128 @@
  * @file      svars.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-02-26
- * @date      Last Update 2013-09-23
- * @version   0.6
+ * @date      Last Update 2026-10-16
+ * @version   0.8.2
  */
 
 #ifndef __PINTOOL_ANACONDA__MONITORS__SVARS_HPP__
   #define __PINTOOL_ANACONDA__MONITORS__SVARS_HPP__
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <map>
-#include <set>
+#include <vector>
 
 #include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include "pin.H"
 
+#include "libdie-wrapper/pin_die.h"
+
+#include "format.h"
+
 #include "../types.h"
 
-#include "../utils/scopedlock.hpp"
+// Number of buckets of the table holding the accessed variables
+#define SVARS_TABLE_BUCKETS 65536
+// Marks variables accessed by more than one thread (no thread has this number)
+#define SVARS_MANY_THREADS INVALID_THREADID
 
 /**
  * @brief A class monitoring shared variables.
  *
- * Monitors shared variables.
+ * Monitors shared variables. The variables are tracked by their addresses in
+ *   a lock-free hash table. Each entry of the table holds the thread which
+ *   accessed the variable first or @c SVARS_MANY_THREADS if some other thread
+ *   accessed it too. The entry is written only when it changes, so accessing
+ *   a variable repeatedly does not write to any shared memory. Names of the
+ *   variables are resolved only when the shared variables are written to the
+ *   output.
+ *
+ * The shared variables are written in a binary format (see format.h). Shared
+ *   variables loaded from a binary file are queried directly in the memory to
+ *   which the file is mapped.
  *
  * @tparam Writer A class used for writing the output.
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-02-26
- * @date      Last Update 2013-09-23
- * @version   0.6
+ * @date      Last Update 2026-10-16
+ * @version   0.8.2
  */
 template< typename Writer >
 class SharedVariablesMonitor : public Writer
 {
   private: // Type definitions
-    typedef std::map< std::string, std::set< THREADID > > VarMap;
+    /**
+     * @brief A structure representing an accessed variable.
+     */
+    typedef struct Entry_s
+    {
+      ADDRINT addr; //!< An address on which is the variable stored.
+      /**
+       * @brief A thread which accessed the variable first or @c
+       *   SVARS_MANY_THREADS if more threads accessed the variable.
+       */
+      std::atomic< THREADID > accessor;
+      Entry_s* next; //!< The next variable in the same bucket.
+
+      /**
+       * Constructs an Entry_s object.
+       *
+       * @param a An address on which is the variable stored.
+       * @param t A thread accessing the variable.
+       */
+      Entry_s(ADDRINT a, THREADID t) : addr(a), accessor(t), next(NULL) {}
+    } Entry;
   private: // Internal variables
-    VarMap m_varMap; //!< A map containing information about variables.
-    PIN_RWMUTEX m_varMapLock; //!< A lock guarding access to the variable map.
+    /**
+     * @brief Chains of accessed variables (the most recently inserted first).
+     */
+    std::atomic< Entry* > m_buckets[SVARS_TABLE_BUCKETS];
+    /**
+     * @brief Names of shared variables loaded from a text file (sorted).
+     */
+    std::vector< std::string > m_loaded;
+    /**
+     * @brief A memory region to which a binary file is mapped.
+     */
+    boost::interprocess::mapped_region m_region;
+    /**
+     * @brief A header of shared variables loaded from a binary file.
+     */
+    const SvarsCoverageHeader* m_mapped;
   public: // Constructors
     /**
      * Constructs a SharedVariablesMonitor object.
      */
-    SharedVariablesMonitor() { PIN_RWMutexInit(&m_varMapLock); }
+    SharedVariablesMonitor() : m_mapped(NULL)
+    {
+      for (int i = 0; i < SVARS_TABLE_BUCKETS; i++)
+        m_buckets[i].store(NULL, std::memory_order_relaxed);
+    }
   public: // Destructors
     /**
-     * Destroys a SharedVariablesMonitor object and writes the names of all
-     *   shared variables detected to the output.
+     * Destroys a SharedVariablesMonitor object and writes all shared variables
+     *   detected to the output.
      */
     ~SharedVariablesMonitor()
     {
-      PIN_RWMutexFini(&m_varMapLock);
+      this->writeCoverage();
+
+      for (int i = 0; i < SVARS_TABLE_BUCKETS; i++)
+      { // No thread is accessing the variables now, free all of the entries
+        Entry* entry = m_buckets[i].load(std::memory_order_relaxed);
 
-      BOOST_FOREACH(const VarMap::value_type& item, m_varMap)
-      { // Write names of variables accessed by more than one thread to output
-        if (item.second.size() > 1) this->writeln(item.first);
+        while (entry != NULL)
+        { // Entries are allocated one by one, free them one by one
+          Entry* next = entry->next;
+          delete entry;
+          entry = next;
+        }
       }
     }
 
@@ -88,15 +154,39 @@ class SharedVariablesMonitor : public Writer
     /**
      * Loads shared variables from a file.
      *
+     * @note The format of the file is detected automatically. Binary files are
+     *   mapped to the memory, text files contain one name per line.
+     *
      * @note This method does not check the existence of the file, if required,
      *   it should be done before calling this method.
      *
      * @param path A path to a file containing the shared variables.
+     * @return @em True if the shared variables were loaded, @em false if the
+     *   file is a corrupted binary file.
      */
-    void load(const std::string& path)
+    bool load(const std::string& path)
     {
       // Extract information about all shared variables from some previous run
-      std::fstream f(path, std::fstream::in);
+      std::fstream f(path, std::fstream::in | std::fstream::binary);
+
+      // Helper variables
+      char magic[8];
+
+      if (f.read(magic, sizeof(magic))
+        && hasCoverageMagic(magic, sizeof(magic), SVARS_COVERAGE_MAGIC))
+      { // Binary file, map it to the memory and query it there
+        boost::interprocess::file_mapping file(path.c_str(),
+          boost::interprocess::read_only);
+        boost::interprocess::mapped_region(file,
+          boost::interprocess::read_only).swap(m_region);
+
+        return (m_mapped = getSvarsCoverage(m_region.get_address(),
+          m_region.get_size())) != NULL;
+      }
+
+      // Text file, read it again in the text mode
+      f.close();
+      f.open(path, std::fstream::in);
 
       // Helper variables
       std::string line;
@@ -105,9 +195,17 @@ class SharedVariablesMonitor : public Writer
       { // Each line contains the name of one shared variable
         if (line.empty()) continue;
 
-        // Shared variable must be accessed by more than one thread
-        m_varMap.insert(VarMap::value_type(line, {0, 1}));
+        // Shared variables from previous runs are shared in this run too
+        m_loaded.push_back(line);
       }
+
+      // Keep the names sorted, so they can be searched in the same way as the
+      // names stored in binary files
+      std::sort(m_loaded.begin(), m_loaded.end());
+      m_loaded.erase(std::unique(m_loaded.begin(), m_loaded.end()),
+        m_loaded.end());
+
+      return true;
     }
 
   public: // Methods monitoring the shared variables
@@ -118,62 +216,239 @@ class SharedVariablesMonitor : public Writer
      *
      * @param tid A thread accessing a variable.
      * @param addr An address on which is the variable stored.
-     * @param var A variable accessed by a thread.
      * @param isLocal @em True if the variable is a local variable, @em false
      *   otherwise.
      */
-    void beforeVariableAccessed(THREADID tid, ADDRINT addr, const VARIABLE& var,
-      BOOL isLocal)
+    void beforeVariableAccessed(THREADID tid, ADDRINT addr, BOOL isLocal)
     {
       if (isLocal) return; // Local variable cannot be shared between threads
 
-      // Other threads might be writing to the map, we need exclusive access
-      ScopedWriteLock wrtlock(m_varMapLock);
+      // Helper variables
+      Entry* entry = this->find(addr);
+
+      if (entry == NULL)
+      { // First access to the variable, insert it together with the thread
+        if ((entry = this->insert(addr, tid)) == NULL) return;
+      }
+
+      // Helper variables
+      THREADID accessor = entry->accessor.load(std::memory_order_relaxed);
 
-      // For each variable, save the set of threads accessing this variable
-      m_varMap[var.name.empty() ? hexstr(addr) : var.name].insert(tid);
+      if (accessor != tid && accessor != SVARS_MANY_THREADS)
+      { // Accessed by another thread before, the state never changes back, so
+        // a plain store is enough even if more threads get here at once
+        entry->accessor.store(SVARS_MANY_THREADS, std::memory_order_relaxed);
+      }
     }
 
-  public: // Methods for checking variables
+  public: // Methods for accessing loaded shared variables
     /**
-     * Checks if a variable is a shared variable, i.e., is accessed by more than
-     *   one thread.
+     * Gets a number of shared variables loaded from a file.
      *
-     * @param var A variable.
+     * @return The number of shared variables loaded from a file.
+     */
+    UINT32 getLoadedSharedVariableCount()
+    {
+      return (m_mapped != NULL) ? m_mapped->variables : m_loaded.size();
+    }
+
+    /**
+     * Gets a name of a shared variable loaded from a file.
+     *
+     * @param idx An index of the shared variable (the names are sorted).
+     * @return The name of the shared variable.
+     */
+    const char* getLoadedSharedVariable(UINT32 idx)
+    {
+      return (m_mapped != NULL) ? getSvarsCoverageStrings(m_mapped)
+        + getSvarsCoverageVariables(m_mapped)[idx] : m_loaded[idx].c_str();
+    }
+
+    /**
+     * Checks if a variable was loaded from a file as a shared variable.
+     *
+     * @param name A name of the variable.
      * @return @em True if the variable is a shared variable, @em false
      *   otherwise.
      */
-    bool isSharedVariable(const VARIABLE& var)
+    bool isSharedVariable(const std::string& name)
     {
-      // Other threads might be reading from the map with us, no problem
-      ScopedReadLock rdlock(m_varMapLock);
+      // Helper variables
+      UINT32 low = 0;
+      UINT32 high = this->getLoadedSharedVariableCount();
+
+      while (low < high)
+      { // The names are sorted, use binary search
+        UINT32 mid = low + (high - low) / 2;
+        int result = strcmp(this->getLoadedSharedVariable(mid), name.c_str());
 
-      VarMap::iterator it = m_varMap.find(var.name);
+        if (result == 0) return true;
 
-      // If more than one thread accessed the variable, it is a shared variable
-      return (it != m_varMap.end() && it->second.size() > 1) ? true : false;
+        if (result < 0) low = mid + 1;
+        else high = mid;
+      }
+
+      return false;
     }
 
-  public: // Methods for accessing shared variables
+  private: // Internal helper methods
     /**
-     * Gets a list of shared variables detected so far.
+     * Gets a bucket in which a variable is stored.
      *
-     * @return A list of shared variables detected so far.
+     * @param addr An address on which is the variable stored.
+     * @return The bucket in which the variable is stored.
      */
-    std::vector< std::string > getSharedVariables()
+    std::atomic< Entry* >& bucket(ADDRINT addr)
+    {
+      return m_buckets[(addr ^ (addr >> 16)) % SVARS_TABLE_BUCKETS];
+    }
+
+    /**
+     * Searches a part of a chain of accessed variables for a variable.
+     *
+     * @param addr An address on which is the variable stored.
+     * @param first The first entry to check.
+     * @param last The entry at which the search stops (not checked).
+     * @return The entry of the variable or @em NULL if not found.
+     */
+    Entry* find(ADDRINT addr, Entry* first, Entry* last)
+    {
+      for (Entry* e = first; e != last; e = e->next)
+      { // The addresses are immutable after they are inserted, no locks needed
+        if (e->addr == addr) return e;
+      }
+
+      return NULL;
+    }
+
+    /**
+     * Gets an entry of a variable.
+     *
+     * @param addr An address on which is the variable stored.
+     * @return The entry of the variable or @em NULL if the variable was not
+     *   accessed yet.
+     */
+    Entry* find(ADDRINT addr)
+    {
+      return this->find(addr, this->bucket(addr).load(
+        std::memory_order_acquire), NULL);
+    }
+
+    /**
+     * Inserts a variable accessed by a thread.
+     *
+     * @note If some other thread inserted the variable in the meantime, the
+     *   entry inserted by the other thread is returned and left unchanged.
+     *
+     * @param addr An address on which is the variable stored.
+     * @param tid A thread accessing the variable.
+     * @return The entry of the variable if some other thread inserted it in the
+     *   meantime, @em NULL if the entry was inserted by this method.
+     */
+    Entry* insert(ADDRINT addr, THREADID tid)
     {
       // Helper variables
-      std::vector< std::string > svars;
+      std::atomic< Entry* >& bucket = this->bucket(addr);
+      Entry* entry = new Entry(addr, tid);
+      Entry* head = bucket.load(std::memory_order_acquire);
+      Entry* inserted;
+
+      do
+      { // Entries are only prepended, check only the ones added since the
+        // last attempt, older entries were checked before
+        if ((inserted = this->find(addr, head, entry->next)) != NULL)
+        { // Some other thread was faster, use its entry
+          delete entry;
 
-      // Other threads might be reading from the map with us, no problem
-      ScopedReadLock rdlock(m_varMapLock);
+          return inserted;
+        }
 
-      BOOST_FOREACH(const VarMap::value_type& item, m_varMap)
-      { // Add all variables accessed by more than one thread to the list
-        if (item.second.size() > 1) svars.push_back(item.first);
+        entry->next = head;
+      } while (!bucket.compare_exchange_weak(head, entry,
+        std::memory_order_release, std::memory_order_acquire));
+
+      return NULL; // The entry already contains the thread
+    }
+
+    /**
+     * Writes all shared variables to the output.
+     *
+     * @note The names of the shared variables detected are resolved when this
+     *   method is called, variables without a name are represented by their
+     *   addresses. Names of shared variables loaded from a file are written
+     *   too, but their addresses are not, as the addresses are valid only in
+     *   the run in which they were obtained.
+     */
+    void writeCoverage()
+    {
+      // Helper variables
+      std::map< std::string, uint32_t > variables;
+      std::map< ADDRINT, std::string > addresses;
+      std::string name;
+      std::string type;
+
+      for (UINT32 i = 0; i < this->getLoadedSharedVariableCount(); i++)
+      { // Shared variables from previous runs are shared in this run too
+        variables[this->getLoadedSharedVariable(i)];
+      }
+
+      for (int i = 0; i < SVARS_TABLE_BUCKETS; i++)
+      { // Entries are only prepended, we may safely walk the chains
+        for (const Entry* e = m_buckets[i].load(std::memory_order_acquire);
+          e != NULL; e = e->next)
+        { // Variables accessed by more than one thread are shared variables
+          if (e->accessor.load(std::memory_order_relaxed)
+            != SVARS_MANY_THREADS) continue;
+
+          // Only global variables can be located by their address alone
+          if (!DIE_GetGlobalVariable(e->addr, name, type))
+            name = hexstr(e->addr);
+
+          variables[name];
+          addresses[e->addr] = name;
+        }
+      }
+
+      // Helper variables
+      SvarsCoverageHeader header;
+      std::vector< SvarsCoverageAddress > table;
+      std::vector< uint32_t > offsets;
+      uint32_t id = 0;
+      uint64_t strings = 0;
+
+      for (std::map< std::string, uint32_t >::iterator it = variables.begin();
+        it != variables.end(); it++)
+      { // IDs are given in the order of names, names are stored in this order
+        it->second = id++;
+        offsets.push_back(strings);
+        strings += it->first.size() + 1;
+      }
+
+      for (std::map< ADDRINT, std::string >::iterator it = addresses.begin();
+        it != addresses.end(); it++)
+      { // The addresses are already sorted
+        table.push_back({ it->first, variables[it->second], 0 });
       }
 
-      return svars; // Return all shared variables detected so far
+      memcpy(header.magic, SVARS_COVERAGE_MAGIC, sizeof(header.magic));
+      header.version = SVARS_COVERAGE_VERSION;
+      header.variables = offsets.size();
+      header.addresses = table.size();
+      header.strings = strings;
+
+      this->write(&header, sizeof(header));
+
+      if (!table.empty())
+        this->write(table.data(), table.size() * sizeof(table[0]));
+
+      if (!offsets.empty())
+        this->write(offsets.data(), offsets.size() * sizeof(offsets[0]));
+
+      for (std::map< std::string, uint32_t >::iterator it = variables.begin();
+        it != variables.end(); it++)
+      { // Write the names including the terminating NUL character
+        this->write(it->first.c_str(), it->first.size() + 1);
+      }
     }
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2013-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2013-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -25,95 +25,59 @@
  * @file      sync.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-01-29
- * @date      Last Update 2016-05-06
- * @version   0.4.2
+ * @date      Last Update 2026-10-16
+ * @version   0.5.2
  */
 
 #ifndef __PINTOOL_ANACONDA__MONITORS__SYNC_HPP__
   #define __PINTOOL_ANACONDA__MONITORS__SYNC_HPP__
 
 #include <assert.h>
+#include <string.h>
 
+#include <atomic>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/foreach.hpp>
 
 #include "pin.H"
 
+#include "format.h"
+
 #include "../defs.h"
 #include "../index.h"
 #include "../types.h"
 
 #include "../utils/lockobj.hpp"
+#include "../utils/scopedlock.hpp"
 #include "../utils/thread.h"
+#include "../utils/tldata.hpp"
+
+// Number of buckets of the table holding information about locks
+#define SYNC_TABLE_BUCKETS 4096
 
 // Type definitions
 typedef std::unordered_map< index_t, int > IndexBag;
 
-/**
- * Acquires an object holding information about a synchronisation primitive.
- *
- * @tparam SP A type of the synchronisation primitive.
- * @tparam SI A type of the object holding information about the synchronisation
- *   primitive.
- *
- * @param sp A synchronisation primitive.
- * @param map A map containing objects holding information about each discovered
- *   synchronisation primitive.
- * @param lock A lock guarding the access to the map.
- * @return A reference to the object holding information about the specified
- *   synchronisation primitive.
- */
-template < typename SP, typename SI >
-inline
-SI& acquire(SP& sp, std::map< SP, SI >& map, PIN_MUTEX& lock)
-{
-  // Other threads might be writing to the map, we need exclusive access
-  PIN_MutexLock(&lock);
-
-  // We need to get SI for the SP or create a new SI with default values
-  SI& si = map[sp];
-
-  // It is safe to allow the other threads to access the map as we already have
-  // a reference to SI and it cannot be invalid as delete is never performed
-  PIN_MutexUnlock(&lock);
-
-  // We need exclusive access to SI, but other SIs may be accessed concurrently
-  si.lock();
-
-  // We successfully acquired the SI we wanted, other threads might access the
-  // map and all other SIs as they wish, we only care about the SI we have now
-  return si;
-}
-
-/**
- * Releases an object holding information about a synchronisation primitive so
- *   that other threads might access it.
- *
- * @tparam SI A type of the object holding information about the synchronisation
- *   primitive.
- *
- * @param si An object holding information about a synchronisation primitive.
- */
-template < typename SI >
-inline
-void release(SI& si)
-{
-  si.unlock();
-}
-
 /**
  * @brief A class monitoring synchronisation coverage.
  *
- * Monitors synchronisation coverage.
+ * Monitors synchronisation coverage. Each thread counts the events it observed
+ *   at each location, the counters of all threads are aggregated when the
+ *   coverage is written to the output in a binary format (see format.h).
+ *   Information about locks is kept in a lock-free hash table, so only the
+ *   information about the lock being processed needs to be locked. Counters
+ *   of a thread are guarded by a lock owned by the thread, so they may be
+ *   merged safely even while the thread is still running.
  *
  * @tparam Writer A class used for writing the output.
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-01-31
- * @date      Last Update 2013-07-12
- * @version   0.4
+ * @date      Last Update 2026-10-16
+ * @version   0.5.2
  */
 template< typename Writer >
 class SyncCoverageMonitor : public Writer
@@ -134,42 +98,138 @@ class SyncCoverageMonitor : public Writer
   } SyncInfo;
 
   /**
-   * @brief An enumeration of types of events which might occur when monitoring
-   *   synchronisation coverage.
+   * @brief A structure representing a lock in the table of locks.
    */
-  typedef enum EventType_e
+  typedef struct Entry_s
   {
+    LOCK lock; //!< A lock.
+    SyncInfo info; //!< Information about the lock.
+    Entry_s* next; //!< The next lock in the same bucket.
+
     /**
-     * @brief Thread reached a synchronisation function.
-     */
-    ET_VISITED,
-    /**
-     * @brief Thread T_1 was blocked by thread T_2 while attempting to acquire
-     *   a lock which is currently acquired by thread T_2.
+     * Constructs an Entry_s object.
+     *
+     * @param l A lock.
      */
-    ET_BLOCKED,
+    Entry_s(LOCK l) : lock(l), info(), next(NULL) {}
+  } Entry;
+
+  /**
+   * @brief A structure holding numbers of events which occurred at a location.
+   */
+  typedef struct Counters_s
+  {
+    UINT64 count[SCE_COUNT]; //!< A number of events of each type.
+
     /**
-     * @brief Thread T_1 is blocking thread T_2 because thread T_2 attempted to
-     *   acquire the same lock which is currently acquired by thread T_2.
+     * Constructs a Counters_s object.
      */
-    ET_BLOCKING
-  } EventType;
+    Counters_s() { memset(count, 0, sizeof(count)); }
+  } Counters;
 
   private: // Type definitions
-    typedef std::map< LOCK, SyncInfo > LockInfoMap;
+    typedef std::unordered_map< index_t, Counters > CounterMap;
+    typedef std::map< std::string, Counters > FunctionCounterMap;
+
+    /**
+     * @brief A structure holding private data of a thread.
+     */
+    typedef struct ThreadData_s : public LockableObject
+    {
+      CounterMap counters; //!< Events observed by the thread at each location.
+      /**
+       * @brief A monitor to which the counters are merged or @em NULL if the
+       *   counters were merged already.
+       */
+      std::atomic< SyncCoverageMonitor* > monitor;
+      THREADID tid; //!< A number identifying the thread.
+
+      /**
+       * Constructs a ThreadData_s object.
+       */
+      ThreadData_s() : LockableObject(), counters(), monitor(NULL), tid(0) {}
+
+      /**
+       * Destroys a ThreadData_s object and merges the counters of the thread
+       *   with the counters of the other threads.
+       */
+      ~ThreadData_s()
+      {
+        SyncCoverageMonitor* m = monitor.load(std::memory_order_acquire);
+
+        if (m != NULL) m->merge(this);
+      }
+    } ThreadData;
   private: // Internal variables
-    LockInfoMap m_lockMap; //!< A map containing information about locks.
-    PIN_MUTEX m_lockMapLock; //!< A lock guarding access to the lock map.
+    /**
+     * @brief Chains of locks (the most recently inserted first).
+     */
+    std::atomic< Entry* > m_buckets[SYNC_TABLE_BUCKETS];
+    ThreadLocalData< ThreadData > m_data; //!< Private data of running threads.
+    CounterMap m_counters; //!< Events observed by threads which finished.
+    /**
+     * @brief Private data of threads whose counters were not merged yet.
+     */
+    ThreadData* m_threads[PIN_MAX_THREADS];
+    bool m_closed; //!< A flag indicating if the coverage was written.
+    PIN_MUTEX m_countersLock; //!< A lock guarding the counters and threads.
   public: // Constructors
     /**
      * Constructs a SynchronisationCoverage object.
      */
-    SyncCoverageMonitor() { PIN_MutexInit(&m_lockMapLock); }
+    SyncCoverageMonitor() : m_closed(false)
+    {
+      for (int i = 0; i < SYNC_TABLE_BUCKETS; i++)
+        m_buckets[i].store(NULL, std::memory_order_relaxed);
+
+      for (THREADID tid = 0; tid < PIN_MAX_THREADS; tid++)
+        m_threads[tid] = NULL;
+
+      PIN_MutexInit(&m_countersLock);
+    }
   public: // Destructors
     /**
      * Destroys a SynchronisationCoverage object.
      */
-    ~SyncCoverageMonitor() { PIN_MutexFini(&m_lockMapLock); }
+    ~SyncCoverageMonitor()
+    {
+      for (int i = 0; i < SYNC_TABLE_BUCKETS; i++)
+      { // No thread is accessing the locks now, free all of the entries
+        Entry* entry = m_buckets[i].load(std::memory_order_relaxed);
+
+        while (entry != NULL)
+        { // Entries are allocated one by one, free them one by one
+          Entry* next = entry->next;
+          delete entry;
+          entry = next;
+        }
+      }
+
+      PIN_MutexFini(&m_countersLock);
+    }
+  public: // Control methods
+    /**
+     * Writes the synchronisation coverage to the output and closes it.
+     *
+     * @note This method is called when the program is about to exit.
+     */
+    void close()
+    {
+      { // Threads cannot free their data while we hold the lock, see merge()
+        ScopedLock lock(m_countersLock);
+
+        m_closed = true; // Threads must not register their data anymore
+
+        for (THREADID tid = 0; tid < PIN_MAX_THREADS; tid++)
+        { // Merge the counters of threads which are still running
+          if (m_threads[tid] != NULL) this->mergeLocked(m_threads[tid]);
+        }
+      }
+
+      this->writeCoverage();
+
+      Writer::close();
+    }
   public: // Methods monitoring the synchronisation coverage
     /**
      * Updates synchronisation coverage.
@@ -184,23 +244,29 @@ class SyncCoverageMonitor : public Writer
       // Get the location at which is the thread trying to acquire the lock
       index_t ll = getLastBacktraceLocationIndex(tid);
 
+      // Get the counters of the thread
+      ThreadData* data = this->getThreadData(tid);
+
       // Get exclusive access to synchronisation information about the lock
-      SyncInfo& si = acquire(lock, m_lockMap, m_lockMapLock);
+      SyncInfo& si = this->acquire(lock);
 
       // A thread is waiting for a lock (do not care which, it is irrelevant)
       si.waiting[ll]++;
 
       // Lock at the specified location was visited
-      this->writeEvent(ll, ET_VISITED);
+      data->counters[ll].count[SCE_VISITED]++;
 
       if (si.holds)
       { // Some thread is holding the lock and is blocking other thread
-        this->writeEvent(ll, ET_BLOCKED);
-        this->writeEvent(si.holder, ET_BLOCKING);
+        data->counters[ll].count[SCE_BLOCKED]++;
+        data->counters[si.holder].count[SCE_BLOCKING]++;
       }
 
       // We are done, let the other threads access the sync info about the lock
-      release(si);
+      si.unlock();
+
+      // The counters may be merged now
+      data->unlock();
     }
 
     /**
@@ -216,8 +282,11 @@ class SyncCoverageMonitor : public Writer
       // Get the location at which is the thread trying to acquire the lock
       index_t ll = getLastBacktraceLocationIndex(tid);
 
+      // Get the counters of the thread
+      ThreadData* data = this->getThreadData(tid);
+
       // Get exclusive access to synchronisation information about the lock
-      SyncInfo& si = acquire(lock, m_lockMap, m_lockMapLock);
+      SyncInfo& si = this->acquire(lock);
 
       // A thread acquired a lock (and stopped waiting for it)
       si.holds = true;
@@ -230,13 +299,16 @@ class SyncCoverageMonitor : public Writer
 
         if (item.second > 0)
         { // At least one thread started waiting for the lock at this location
-          this->writeEvent(item.first, ET_BLOCKED);
-          this->writeEvent(ll, ET_BLOCKING);
+          data->counters[item.first].count[SCE_BLOCKED]++;
+          data->counters[ll].count[SCE_BLOCKING]++;
         }
       }
 
       // We are done, let the other threads access the sync info about the lock
-      release(si);
+      si.unlock();
+
+      // The counters may be merged now
+      data->unlock();
     }
 
     /**
@@ -250,36 +322,220 @@ class SyncCoverageMonitor : public Writer
     void beforeLockReleased(THREADID tid, LOCK lock)
     {
       // Get exclusive access to synchronisation information about the lock
-      SyncInfo& si = acquire(lock, m_lockMap, m_lockMapLock);
+      SyncInfo& si = this->acquire(lock);
 
       // A thread released a lock
       si.holds = false;
 
       // We are done, let the other threads access the sync info about the lock
-      release(si);
+      si.unlock();
     }
 
   private: // Helper methods
     /**
-     * Writes a synchronisation coverage event to the output.
+     * Gets private data of a thread and locks them.
+     *
+     * @note The data must be unlocked when the thread finishes updating them.
+     *
+     * @param tid A number identifying the thread.
+     * @return The locked private data of the thread.
+     */
+    ThreadData* getThreadData(THREADID tid)
+    {
+      ThreadData* data = m_data.get(tid);
+
+      if (data->monitor.load(std::memory_order_relaxed) == NULL)
+      { // The counters need to be merged when the thread finishes or when the
+        // coverage is written, whichever comes first
+        ScopedLock lock(m_countersLock);
+
+        if (!m_closed)
+        { // Events which occur after the coverage is written are not counted
+          data->tid = tid;
+          data->monitor.store(this, std::memory_order_release);
+          m_threads[tid] = data;
+        }
+      }
+
+      data->lock();
+
+      return data;
+    }
+
+    /**
+     * Acquires an object holding information about a lock.
+     *
+     * @note The information about locks is never deleted, so the object stays
+     *   valid even after it is released.
+     *
+     * @param lock A lock.
+     * @return A reference to the locked object holding information about the
+     *   lock.
+     */
+    SyncInfo& acquire(LOCK lock)
+    {
+      // Helper variables
+      std::atomic< Entry* >& bucket = m_buckets[lock.q() % SYNC_TABLE_BUCKETS];
+      Entry* head = bucket.load(std::memory_order_acquire);
+      Entry* entry;
+
+      if ((entry = this->find(lock, head, NULL)) == NULL)
+      { // First time the lock is used, try to insert a new entry for it
+        entry = new Entry(lock);
+
+        do
+        { // Entries are only prepended, check only the ones added since the
+          // last attempt, older entries were checked before
+          Entry* inserted = this->find(lock, head, entry->next);
+
+          if (inserted != NULL)
+          { // Some other thread was faster, use its entry
+            delete entry;
+            entry = inserted;
+            break;
+          }
+
+          entry->next = head;
+        } while (!bucket.compare_exchange_weak(head, entry,
+          std::memory_order_release, std::memory_order_acquire));
+      }
+
+      // We need exclusive access to the information about the lock
+      entry->info.lock();
+
+      return entry->info;
+    }
+
+    /**
+     * Searches a part of a chain of locks for a lock.
+     *
+     * @param lock A lock.
+     * @param first The first entry to check.
+     * @param last The entry at which the search stops (not checked).
+     * @return The entry of the lock or @em NULL if not found.
+     */
+    Entry* find(LOCK lock, Entry* first, Entry* last)
+    {
+      for (Entry* e = first; e != last; e = e->next)
+      { // The locks are immutable after they are inserted, no locks needed
+        if (e->lock.q() == lock.q()) return e;
+      }
+
+      return NULL;
+    }
+
+    /**
+     * Merges the counters of a thread with the counters of the other threads.
+     *
+     * @param data Private data of the thread.
+     */
+    void merge(ThreadData* data)
+    {
+      // Other threads might be merging their counters too
+      ScopedLock lock(m_countersLock);
+
+      // The counters might have been merged when the coverage was written
+      if (data->monitor.load(std::memory_order_relaxed) == NULL) return;
+
+      this->mergeLocked(data);
+    }
+
+    /**
+     * Merges the counters of a thread with the counters of the other threads.
+     *
+     * @warning The lock guarding the counters must be held when calling this
+     *   method. As a thread merges its counters before freeing its data, the
+     *   data of the threads registered stay valid while the lock is held.
+     *
+     * @param data Private data of the thread.
+     */
+    void mergeLocked(ThreadData* data)
+    {
+      // The thread might be updating its counters right now
+      data->lock();
+
+      BOOST_FOREACH(typename CounterMap::const_reference item, data->counters)
+      { // Add the events observed by the thread to the events of other threads
+        Counters& counters = m_counters[item.first];
+
+        for (int i = 0; i < SCE_COUNT; i++)
+          counters.count[i] += item.second.count[i];
+      }
+
+      data->counters.clear();
+
+      data->unlock();
+
+      // Do not merge anything when the thread ends
+      data->monitor.store(NULL, std::memory_order_relaxed);
+      m_threads[data->tid] = NULL;
+    }
+
+    /**
+     * Gets a name of a function containing a location.
+     *
+     * @param l An index of a call performed at the location or @c -1 if the
+     *   location is not known.
+     * @return The name of the function containing the location or @c <unknown>
+     *   if the location is not known.
+     */
+    static std::string getFunctionName(index_t l)
+    {
+      if (l == (index_t)-1) return "<unknown>";
+
+      return retrieveFunction(retrieveCall(l)->function)->name;
+    }
+
+    /**
+     * Writes the synchronisation coverage to the output.
      *
-     * @param l A location where the event occurred.
-     * @param et A type of the event that occurred.
+     * @note The counters of locations in the same function are summed up, the
+     *   coverage contains one record for each function and type of event.
      */
-    void writeEvent(index_t l, EventType et)
+    void writeCoverage()
     {
-      // Text representation of the events, using static constexpr should force
-      // the compiler to use only a single table for the whole class and put the
-      // table into a read-only memory (where the code is) as the content never
-      // changes (the values are constant and known in compile-time)
-      static CONSTEXPR const char* eventTypeString[] = {
-        "VISITED",
-        "BLOCKED",
-        "BLOCKING"
-      };
-
-      // Format (each line): <location> <event-type>
-      this->writeln(retrieveFunction(l)->name + " " + eventTypeString[et]);
+      // Helper variables
+      FunctionCounterMap functions;
+      std::vector< SyncCoverageRecord > records;
+      SyncCoverageHeader header;
+      uint32_t index = 0;
+
+      BOOST_FOREACH(typename CounterMap::const_reference item, m_counters)
+      { // Names of the functions are resolved only now, once per location
+        Counters& counters = functions[getFunctionName(item.first)];
+
+        for (int i = 0; i < SCE_COUNT; i++)
+          counters.count[i] += item.second.count[i];
+      }
+
+      BOOST_FOREACH(typename FunctionCounterMap::const_reference item,
+        functions)
+      { // Functions are written in the same order as their names below
+        for (uint32_t i = 0; i < SCE_COUNT; i++)
+        { // Only events which occurred at least once are written
+          if (item.second.count[i] == 0) continue;
+
+          records.push_back({ index, i, item.second.count[i] });
+        }
+
+        index++;
+      }
+
+      memcpy(header.magic, SYNC_COVERAGE_MAGIC, sizeof(header.magic));
+      header.version = SYNC_COVERAGE_VERSION;
+      header.functions = functions.size();
+      header.records = records.size();
+
+      this->write(&header, sizeof(header));
+
+      if (!records.empty())
+        this->write(records.data(), records.size() * sizeof(records[0]));
+
+      BOOST_FOREACH(typename FunctionCounterMap::const_reference item,
+        functions)
+      { // Write the names of functions including the terminating NUL character
+        this->write(item.first.c_str(), item.first.size() + 1);
+      }
     }
 };
 
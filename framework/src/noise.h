@@ -27,8 +27,8 @@
  * @file      noise.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-03-03
- * @date      Last Update 2015-07-21
- * @version   0.2.1
+ * @date      Last Update 2026-10-16
+ * @version   0.2.2
  */
 
 #ifndef __PINTOOL_ANACONDA__NOISE_H__
@@ -73,6 +73,15 @@ typedef enum NoiseFilter_e
   NF_INVERSE_NOISE
 } NoiseFilter;
 
+/**
+ * @brief An enumeration describing the types of shared variables filter.
+ */
+typedef enum SharedVariablesType_e
+{
+  SVT_ALL, //!< Inject a noise before any shared variable.
+  SVT_ONE  //!< Inject a noise before one chosen shared variable.
+} SharedVariablesType;
+
 // Type definitions
 typedef std::list< NoiseFilter > NoiseFilterList;
 
@@ -103,6 +112,16 @@ typedef struct NoiseSettings_s
    *       variable.
    */
   Properties properties;
+  /**
+   * @brief A type of the shared variables filter (resolved from the @c
+   *   svars.type property when the filters are set up).
+   */
+  SharedVariablesType svarsType;
+  /**
+   * @brief A function used to determine if a noise might be injected before
+   *   an access to a shared variable whose address is not known statically.
+   */
+  AFUNPTR svarsFilter;
   NOISEGENFUNPTR generator; //!< A function generating noise.
   std::string gentype; //!< A type of a function generating noise.
   UINT32 frequency; //!< A probability that a noise will be inserted.
@@ -111,8 +130,8 @@ typedef struct NoiseSettings_s
   /**
    * Constructs a NoiseSettings_s object.
    */
-  NoiseSettings_s() : filter(NULL), generator(NULL), gentype(), frequency(0),
-    strength(0) {}
+  NoiseSettings_s() : filter(NULL), svarsType(SVT_ALL), svarsFilter(NULL),
+    generator(NULL), gentype(), frequency(0), strength(0) {}
 
   /**
    * Constructs a NoiseSettings_s object.
@@ -122,7 +141,8 @@ typedef struct NoiseSettings_s
    * @param s A strength of the noise.
    */
   NoiseSettings_s(std::string t, unsigned int f, unsigned int s) : filter(NULL),
-      generator(NULL), gentype(t), frequency(f), strength(s) {}
+      svarsType(SVT_ALL), svarsFilter(NULL), generator(NULL), gentype(t),
+      frequency(f), strength(s) {}
 } NoiseSettings;
 
 // Definitions of functions for printing various data to a stream
@@ -0,0 +1,696 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Contains implementation of functions for printing output
+ *   asynchronously.
+ *
+ * A file containing implementation of functions for printing messages to the
+ *   console or the log file from a dedicated output thread. Each thread stores
+ *   its messages in its own buffer and the output thread prints them, so the
+ *   threads do not need to wait for each other when printing.
+ *
+ * @file      output.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-16
+ * @version   0.1.1
+ */
+
+#include "output.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "anaconda.h"
+#include "defs.h"
+
+// Records in the output buffers are aligned to 8 bytes
+#define OUTPUT_RECORD_ALIGNMENT 8
+// A minimum size of an output buffer in bytes
+#define OUTPUT_MIN_BUFFER_SIZE 4096
+// A maximum time (in milliseconds) a message waits before being printed
+#define OUTPUT_DRAIN_INTERVAL 10
+// A number of bytes of messages the output thread prints at once
+#define OUTPUT_BATCH_SIZE 65536
+
+// Flags describing a state of an output buffer
+#define OBS_USED 0x1 // The thread owning the buffer is writing to it
+#define OBS_CLOSED 0x2 // The buffer does not accept any more messages
+
+/**
+ * @brief An enumeration of policies applied when a thread prints a message and
+ *   its output buffer is full.
+ */
+typedef enum OverflowPolicy_e
+{
+  OP_BLOCK, //!< Wait until the output thread makes space in the buffer.
+  OP_DROP   //!< Drop the message (and report the number of dropped messages).
+} OverflowPolicy;
+
+/**
+ * @brief A structure representing a header of a record in an output buffer.
+ *
+ * The header is followed by @c length bytes of the message and the record is
+ *   padded to @c OUTPUT_RECORD_ALIGNMENT bytes.
+ */
+typedef struct RecordHeader_s
+{
+  UINT32 length; //!< A length of the message in bytes.
+  UINT32 channel; //!< A channel (an item of OutputChannel) or @c OC_PADDING.
+} RecordHeader;
+
+// A channel of a record which only fills the space at the end of a buffer
+#define OC_PADDING 0xFFFFFFFF
+
+/**
+ * @brief A class representing a buffer holding messages printed by a thread.
+ *
+ * The buffer is a ring buffer with a single producer (the thread printing the
+ *   messages) and a single consumer (the output thread). The producer appends
+ *   records at the tail and the consumer removes them from the head, so they
+ *   do not need any locks. Both positions grow monotonically, their values
+ *   modulo the capacity of the buffer are the offsets in the buffer.
+ *
+ * When the output thread is about to finish, the buffer is closed. The closing
+ *   waits until the producer stops writing to the buffer and from then on, the
+ *   producer cannot write to it anymore.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-16
+ * @version   0.1.1
+ */
+class OutputBuffer
+{
+  private: // Internal data
+    UINT64 m_capacity; //!< A size of the buffer in bytes.
+    char* m_data; //!< A memory holding the records.
+    /**
+     * @brief A position of the first record not printed yet (written by the
+     *   consumer only).
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic< UINT64 > m_head;
+    /**
+     * @brief A position after the last record (written by the producer only).
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic< UINT64 > m_tail;
+    UINT64 m_dropped; //!< A number of dropped messages.
+    /**
+     * @brief A state of the buffer (a combination of @c OBS_* flags).
+     */
+    std::atomic< UINT32 > m_state;
+  public: // Constructors
+    /**
+     * Constructs an empty buffer.
+     *
+     * @param capacity A size of the buffer in bytes. Must be a multiple of @c
+     *   OUTPUT_RECORD_ALIGNMENT.
+     */
+    OutputBuffer(UINT64 capacity) : m_capacity(capacity),
+      m_data(new char[capacity]), m_head(0), m_tail(0), m_dropped(0),
+      m_state(0) {}
+  public: // Destructors
+    /**
+     * Destroys the buffer.
+     */
+    ~OutputBuffer() { delete[] m_data; }
+  public: // Static methods
+    /**
+     * Gets a size of a record holding a message.
+     *
+     * @param length A length of the message in bytes.
+     * @return The size of the record in bytes.
+     */
+    static UINT64 getRecordSize(UINT64 length)
+    {
+      return (sizeof(RecordHeader) + length + OUTPUT_RECORD_ALIGNMENT - 1)
+        & ~(UINT64)(OUTPUT_RECORD_ALIGNMENT - 1);
+    }
+  public: // Producer methods
+    /**
+     * Starts writing to the buffer.
+     *
+     * @return @em True if the producer may write to the buffer, @em false if
+     *   the buffer is closed.
+     */
+    bool acquire()
+    {
+      // Helper variables
+      UINT32 state = m_state.load();
+
+      do
+      { // The consumer might be closing the buffer right now
+        if (state & OBS_CLOSED) return false;
+      } while (!m_state.compare_exchange_weak(state, state | OBS_USED));
+
+      return true;
+    }
+
+    /**
+     * Stops writing to the buffer.
+     */
+    void release() { m_state.fetch_and(~(UINT32)OBS_USED); }
+
+    /**
+     * Appends a message to the buffer.
+     *
+     * @note The message must fit into a half of the buffer, so it can be
+     *   stored even if some space at the end of the buffer must be skipped.
+     *
+     * @param channel A channel to which the message should be printed.
+     * @param message A message.
+     * @param length A length of the message in bytes.
+     * @return @em True if the message was appended, @em false if there is not
+     *   enough free space in the buffer.
+     */
+    bool write(UINT32 channel, const char* message, UINT32 length)
+    {
+      // Helper variables
+      UINT64 size = getRecordSize(length);
+      UINT64 tail = m_tail.load(std::memory_order_relaxed);
+      UINT64 offset = tail % m_capacity;
+      UINT64 padding = (m_capacity - offset < size) ? m_capacity - offset : 0;
+
+      if (tail + padding + size - m_head.load(std::memory_order_acquire)
+        > m_capacity) return false; // The consumer must free some space first
+
+      if (padding != 0)
+      { // The record does not fit at the end, skip the rest of the buffer
+        RecordHeader* header = reinterpret_cast< RecordHeader* >(m_data
+          + offset);
+
+        header->length = padding - sizeof(RecordHeader);
+        header->channel = OC_PADDING;
+
+        offset = 0;
+      }
+
+      // Helper variables
+      RecordHeader* header = reinterpret_cast< RecordHeader* >(m_data + offset);
+
+      header->length = length;
+      header->channel = channel;
+
+      memcpy(header + 1, message, length);
+
+      // Publish the record, the consumer may print it from now on
+      m_tail.store(tail + padding + size, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * Records that a message was dropped because the buffer was full.
+     */
+    void drop() { m_dropped++; }
+
+    /**
+     * Gets a number of dropped messages.
+     *
+     * @return The number of messages dropped because the buffer was full.
+     */
+    UINT64 getDropped() { return m_dropped; }
+  public: // Consumer methods
+    /**
+     * Removes all records from the buffer and passes the messages stored in
+     *   them to a function printing the messages.
+     *
+     * @note The records are removed after the function printing the messages
+     *   finishes, so the messages of a thread are printed when the buffer of
+     *   the thread becomes empty.
+     *
+     * @tparam PrintFunction A type of the function printing the messages.
+     * @tparam FlushFunction A type of the function printing the messages which
+     *   the function printing the messages did not print yet.
+     *
+     * @param print A function printing a message.
+     * @param flush A function printing the messages which the function printing
+     *   the messages did not print yet.
+     * @return A number of bytes removed from the buffer.
+     */
+    template< typename PrintFunction, typename FlushFunction >
+    UINT64 read(PrintFunction print, FlushFunction flush)
+    {
+      // Helper variables
+      UINT64 head = m_head.load(std::memory_order_relaxed);
+      UINT64 tail = m_tail.load(std::memory_order_acquire);
+      UINT64 start = head;
+
+      while (head != tail)
+      { // Print all records the producer published so far
+        const RecordHeader* header = reinterpret_cast< const RecordHeader* >(
+          m_data + head % m_capacity);
+
+        if (header->channel != OC_PADDING)
+          print(header->channel, reinterpret_cast< const char* >(header + 1),
+            header->length);
+
+        head += getRecordSize(header->length);
+      }
+
+      if (head == start) return 0; // Nothing to print
+
+      flush(); // All messages must be printed before they are removed
+
+      // Free the space, the producer may reuse it from now on
+      m_head.store(head, std::memory_order_release);
+
+      return head - start;
+    }
+
+    /**
+     * Checks if the buffer is empty.
+     *
+     * @return @em True if all messages in the buffer were printed, @em false
+     *   otherwise.
+     */
+    bool empty()
+    {
+      return m_head.load(std::memory_order_acquire)
+        == m_tail.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Gets a number of bytes occupied by the records in the buffer.
+     *
+     * @return The number of bytes occupied by the records in the buffer.
+     */
+    UINT64 used()
+    {
+      return m_tail.load(std::memory_order_relaxed)
+        - m_head.load(std::memory_order_acquire);
+    }
+
+  public: // Control methods
+    /**
+     * Closes the buffer, i.e., stops the producer from writing to the buffer.
+     *
+     * @note The output thread must be still running when this method is called
+     *   as the producer might be waiting for it to make space in the buffer.
+     */
+    void close()
+    {
+      m_state.fetch_or(OBS_CLOSED);
+
+      while (m_state.load() & OBS_USED)
+      { // The producer is writing a message, let it finish
+        PIN_Yield();
+      }
+    }
+};
+
+namespace
+{ // Static global variables (usable only within this module)
+  /**
+   * @brief Buffers of threads (indexed by thread IDs). A buffer is created
+   *   when a thread prints its first message and reused by all threads which
+   *   get the same thread ID later.
+   */
+  std::atomic< OutputBuffer* > g_buffers[PIN_MAX_THREADS];
+  /**
+   * @brief A number of thread IDs the output thread must check for buffers.
+   */
+  std::atomic< THREADID > g_threads(0);
+  /**
+   * @brief A flag determining if the messages are printed by the output thread
+   *   (@em true) or directly by the threads printing them (@em false).
+   *
+   * @note The flag is set to @em false before the buffers are closed and the
+   *   threads check it again after they start writing to their buffers, so a
+   *   thread either writes to a buffer which will be closed (and drained) or
+   *   prints its message directly.
+   */
+  std::atomic< bool > g_async(false);
+  std::atomic< bool > g_stop(false); //!< Tells the output thread to finish.
+  PIN_SEMAPHORE g_wakeup; //!< Wakes up the output thread.
+  PIN_THREAD_UID g_outputThreadUid; //!< A unique ID of the output thread.
+  UINT64 g_bufferSize; //!< A size of the output buffers in bytes.
+  OverflowPolicy g_overflowPolicy; //!< A policy used when a buffer is full.
+
+  // Data used only by the output thread (or by the thread finishing it)
+  std::string g_pending; //!< Messages waiting to be printed together.
+}
+
+/**
+ * Prints a message to a channel directly.
+ *
+ * @param channel A channel to which the message should be printed.
+ * @param message A message.
+ */
+inline
+VOID printMessage(UINT32 channel, const std::string& message)
+{
+  switch (channel)
+  { // Use the same functions the analysers would use to print the message
+    case OC_CONSOLE:
+      CONSOLE(message);
+      break;
+    case OC_CONSOLE_NOPREFIX:
+      CONSOLE_NOPREFIX(message);
+      break;
+    case OC_LOG:
+      LOG(message);
+      break;
+    default: // Unknown channel, ignore the message
+      break;
+  }
+}
+
+/**
+ * Prints the messages without prefix waiting to be printed together.
+ */
+inline
+VOID flushPendingMessages()
+{
+  if (g_pending.empty()) return;
+
+  CONSOLE_NOPREFIX(g_pending);
+
+  g_pending.clear();
+}
+
+/**
+ * Prints a message taken from an output buffer.
+ *
+ * @note Consecutive messages printed to the console without prefix are joined
+ *   and printed at once. Other messages are printed immediately as each of
+ *   them needs to have its own prefix.
+ *
+ * @param channel A channel to which the message should be printed.
+ * @param message A message.
+ * @param length A length of the message in bytes.
+ */
+inline
+VOID printBufferedMessage(UINT32 channel, const char* message, UINT32 length)
+{
+  if (channel == OC_CONSOLE_NOPREFIX)
+  { // Messages without prefix may be joined together
+    g_pending.append(message, length);
+
+    if (g_pending.size() >= OUTPUT_BATCH_SIZE) flushPendingMessages();
+  }
+  else
+  { // Keep the order of the messages, print the joined messages first
+    flushPendingMessages();
+
+    printMessage(channel, std::string(message, length));
+  }
+}
+
+/**
+ * Prints all messages stored in the output buffers.
+ *
+ * @return A number of bytes removed from the output buffers.
+ */
+UINT64 drainOutputBuffers()
+{
+  // Helper variables
+  THREADID threads = g_threads.load(std::memory_order_acquire);
+  UINT64 drained = 0;
+
+  for (THREADID tid = 0; tid < threads; tid++)
+  { // Print the messages of all threads which printed something
+    OutputBuffer* buffer = g_buffers[tid].load(std::memory_order_acquire);
+
+    if (buffer == NULL) continue;
+
+    drained += buffer->read(printBufferedMessage, flushPendingMessages);
+  }
+
+  return drained;
+}
+
+/**
+ * Prints messages stored in the output buffers until the program finishes.
+ *
+ * @note This function is executed by the output thread, which is an internal
+ *   thread of the framework.
+ *
+ * @param arg Not used.
+ */
+VOID outputThread(VOID* arg)
+{
+  while (!g_stop.load(std::memory_order_acquire))
+  { // The threads wake us up when their buffers are getting full
+    PIN_SemaphoreTimedWait(&g_wakeup, OUTPUT_DRAIN_INTERVAL);
+    PIN_SemaphoreClear(&g_wakeup);
+
+    drainOutputBuffers();
+  }
+}
+
+/**
+ * Gets an output buffer of a thread.
+ *
+ * @note If the thread does not have any output buffer yet, the function will
+ *   create one.
+ *
+ * @param tid A thread.
+ * @return The output buffer of the thread.
+ */
+inline
+OutputBuffer* getOutputBuffer(THREADID tid)
+{
+  // Only the thread itself may create its buffer, so no CAS is needed here
+  OutputBuffer* buffer = g_buffers[tid].load(std::memory_order_relaxed);
+
+  if (buffer != NULL) return buffer;
+
+  buffer = new OutputBuffer(g_bufferSize);
+
+  // The thread finishing the output thread must see the buffer before it
+  // closes the buffers if the thread sees the output still asynchronous
+  g_buffers[tid].store(buffer);
+
+  // Helper variables
+  THREADID threads = g_threads.load(std::memory_order_relaxed);
+
+  while (threads <= tid && !g_threads.compare_exchange_weak(threads, tid + 1))
+  { // Make sure the output thread checks the new buffer
+  }
+
+  return buffer;
+}
+
+/**
+ * Waits until the output thread prints some messages stored in an output
+ *   buffer.
+ */
+inline
+VOID waitForOutputThread()
+{
+  PIN_SemaphoreSet(&g_wakeup);
+  PIN_Yield();
+}
+
+/**
+ * Setups the printing of output.
+ *
+ * @param settings An object containing the ANaConDA framework's settings.
+ */
+VOID setupOutputModule(Settings* settings)
+{
+  // The size must be a multiple of the alignment of records in the buffers
+  g_bufferSize = std::max< UINT64 >((UINT64)std::max(
+    settings->get< int >("output.buffer-size"), 0) * 1024,
+    OUTPUT_MIN_BUFFER_SIZE) & ~(UINT64)(OUTPUT_RECORD_ALIGNMENT - 1);
+
+  g_overflowPolicy = (settings->get< std::string >("output.overflow")
+    == "drop") ? OP_DROP : OP_BLOCK;
+
+  // Print messages directly if the output should not be asynchronous
+  if (!settings->get< bool >("output.async")) return;
+
+  PIN_SemaphoreInit(&g_wakeup);
+
+  if (PIN_SpawnInternalThread(outputThread, NULL, 0, &g_outputThreadUid)
+    == INVALID_THREADID)
+  { // Without the output thread, the messages must be printed directly
+    LOG("Could not start the output thread, output will be synchronous.\n");
+
+    PIN_SemaphoreFini(&g_wakeup);
+
+    return;
+  }
+
+  g_async.store(true, std::memory_order_release);
+}
+
+/**
+ * Prints all messages stored in the output buffers and stops the output thread.
+ *
+ * @note This function is called when the program being analysed is about to
+ *   exit, while the threads of the program may still be running. Any message
+ *   printed after this function starts is printed directly.
+ *
+ * @warning The buffers are not freed as the threads of the program might still
+ *   hold pointers to them. They are freed when the process terminates.
+ */
+VOID finishOutputModule()
+{
+  if (!g_async.load()) return;
+
+  // New messages will be printed directly from now on
+  g_async.store(false);
+
+  // Helper variables
+  THREADID threads = g_threads.load();
+  UINT64 dropped = 0;
+
+  for (THREADID tid = 0; tid < threads; tid++)
+  { // Wait for threads writing to the buffers, the output thread must still
+    // be running as the threads might be waiting for it to make some space
+    OutputBuffer* buffer = g_buffers[tid].load();
+
+    if (buffer == NULL) continue;
+
+    buffer->close();
+  }
+
+  // Stop the output thread, no one else may print the buffered messages now
+  g_stop.store(true, std::memory_order_release);
+
+  PIN_SemaphoreSet(&g_wakeup);
+  PIN_WaitForThreadTermination(g_outputThreadUid, PIN_INFINITE_TIMEOUT, NULL);
+  PIN_SemaphoreFini(&g_wakeup);
+
+  // Print the messages the output thread did not print before it finished
+  drainOutputBuffers();
+
+  for (THREADID tid = 0; tid < threads; tid++)
+  { // All buffers are closed, no thread can drop messages anymore
+    OutputBuffer* buffer = g_buffers[tid].load();
+
+    if (buffer == NULL) continue;
+
+    dropped += buffer->getDropped();
+  }
+
+  if (dropped != 0)
+  { // Let the user know that the output is incomplete
+    CONSOLE("Warning: " + decstr(dropped) + " messages were dropped because "
+      "the output buffers were full.\n");
+  }
+}
+
+/**
+ * Prints a message to a channel.
+ *
+ * @note If the output is asynchronous, the message is stored in the output
+ *   buffer of the thread and printed later by the output thread. The messages
+ *   of a single thread are printed in the order in which they were printed by
+ *   the thread, but the messages of different threads may be interleaved in a
+ *   different order.
+ *
+ * @warning This function must be called from the thread @em tid.
+ *
+ * @param tid A thread printing the message.
+ * @param channel A channel to which the message should be printed.
+ * @param message A message.
+ * @param length A length of the message in bytes.
+ */
+VOID OUTPUT_Print(THREADID tid, OutputChannel channel, const char* message,
+  UINT32 length)
+{
+  if (!g_async.load(std::memory_order_relaxed))
+  { // No output thread, print the message directly
+    printMessage(channel, std::string(message, length));
+
+    return;
+  }
+
+  // Helper variables
+  OutputBuffer* buffer = getOutputBuffer(tid);
+  UINT64 size = OutputBuffer::getRecordSize(length);
+
+  if (!buffer->acquire())
+  { // The output thread is finishing, print the message directly
+    printMessage(channel, std::string(message, length));
+
+    return;
+  }
+
+  if (!g_async.load())
+  { // The output thread started finishing before the buffer was acquired, it
+    // might not have seen the buffer yet, so do not store anything there
+    buffer->release();
+
+    printMessage(channel, std::string(message, length));
+
+    return;
+  }
+
+  if (size > g_bufferSize / 2)
+  { // The message does not fit into the buffer, print it directly, but only
+    // after all of the messages printed by the thread before are printed
+    while (!buffer->empty()) waitForOutputThread();
+
+    buffer->release();
+
+    printMessage(channel, std::string(message, length));
+
+    return;
+  }
+
+  while (!buffer->write(channel, message, length))
+  { // The buffer is full, apply the overflow policy
+    if (g_overflowPolicy == OP_DROP)
+    { // Lose the message, but do not slow down the thread
+      buffer->drop();
+      buffer->release();
+
+      return;
+    }
+
+    waitForOutputThread();
+  }
+
+  // Helper variables
+  UINT64 used = buffer->used();
+
+  // Do not wait for the timeout if the buffer just became half full
+  if (used > g_bufferSize / 2 && used - size <= g_bufferSize / 2)
+    PIN_SemaphoreSet(&g_wakeup);
+
+  // The output thread may finish only after the semaphore is not used anymore
+  buffer->release();
+}
+
+/**
+ * Prints a message to a channel.
+ *
+ * @note If the output is asynchronous, the message is stored in the output
+ *   buffer of the thread and printed later by the output thread.
+ *
+ * @warning This function must be called from the thread @em tid.
+ *
+ * @param tid A thread printing the message.
+ * @param channel A channel to which the message should be printed.
+ * @param message A message.
+ */
+VOID OUTPUT_Print(THREADID tid, OutputChannel channel,
+  const std::string& message)
+{
+  OUTPUT_Print(tid, channel, message.data(), message.size());
+}
+
+/** End of file output.cpp **/
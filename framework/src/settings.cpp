@@ -27,8 +27,8 @@
  * @file      settings.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-20
- * @date      Last Update 2020-04-14
- * @version   0.15.4
+ * @date      Last Update 2026-10-15
+ * @version   0.15.11
  */
 
 #include "settings.h"
@@ -405,7 +405,7 @@ Settings::~Settings()
   // Shut down the analyser (e.g. execute its finalisation code)
   m_analyser->finish();
 
-  // Close the output file used by the synchronisation coverage monitor
+  // Write the synchronisation coverage and close its output file
   m_coverage.sync.close();
 }
 
@@ -493,6 +493,7 @@ void Settings::print(std::ostream& s)
   PRINT_OPTION("analyser", fs::path);
   PRINT_OPTION("debug", std::string);
   PRINT_OPTION("seed", UINT64);
+  PRINT_OPTION("access.batch-size", int);
   PRINT_OPTION("backtrace.type", std::string);
   PRINT_OPTION("backtrace.verbosity", std::string);
   PRINT_OPTION("coverage.synchronisation", bool);
@@ -500,10 +501,21 @@ void Settings::print(std::ostream& s)
   PRINT_OPTION("coverage.predecessors", bool);
   PRINT_OPTION("coverage.filename", std::string);
   PRINT_OPTION("coverage.directory", fs::path);
+  PRINT_OPTION("instrumentation.mode", std::string);
+  PRINT_OPTION("instrumentation.skip-stack-accesses", bool);
+  PRINT_OPTION("instrumentation.skip-readonly-accesses", bool);
   PRINT_NOISE_OPTION("noise");
   PRINT_NOISE_OPTION("noise.read");
   PRINT_NOISE_OPTION("noise.write");
   PRINT_NOISE_OPTION("noise.update");
+  PRINT_OPTION("output.async", bool);
+  PRINT_OPTION("output.buffer-size", int);
+  PRINT_OPTION("output.overflow", std::string);
+  PRINT_OPTION("sampling.enabled", bool);
+  PRINT_OPTION("sampling.initial-rate", int);
+  PRINT_OPTION("sampling.minimum-rate", int);
+  PRINT_OPTION("sampling.backoff", int);
+  PRINT_OPTION("sampling.burst", int);
 
   // Print a section containing internal settings
   s << "\nInternal settings"
@@ -858,6 +870,7 @@ void Settings::loadSettings(int argc, char **argv) throw(SettingsError)
 
   // Define the options which can be set in the configuration file
   config.add_options()
+    ("access.batch-size", po::value< int >()->default_value(1024))
     ("backtrace.type", po::value< std::string >()->default_value("none"))
     ("backtrace.verbosity", po::value< std::string >()->default_value("detailed"))
     ("coverage.synchronisation", po::value< bool >()->default_value(false))
@@ -865,6 +878,9 @@ void Settings::loadSettings(int argc, char **argv) throw(SettingsError)
     ("coverage.predecessors", po::value< bool >()->default_value(false))
     ("coverage.filename", po::value< std::string >()->default_value("{ts}-{pn}.{cts}"))
     ("coverage.directory", po::value< fs::path >()->default_value(fs::path("./coverage")))
+    ("instrumentation.mode", po::value< std::string >()->default_value("image"))
+    ("instrumentation.skip-stack-accesses", po::value< bool >()->default_value(false))
+    ("instrumentation.skip-readonly-accesses", po::value< bool >()->default_value(false))
     ("noise.filters", po::value< std::string >()->default_value(""))
     ("noise.filters.sharedvars.type",
       po::value< std::string >()->default_value("all"))
@@ -874,7 +890,15 @@ void Settings::loadSettings(int argc, char **argv) throw(SettingsError)
       po::value< std::string >()->default_value("./coverage/{lts}-{pn}.{cts}"))
     ("noise.type", po::value< std::string >()->default_value("sleep"))
     ("noise.frequency", po::value< int >()->default_value(0))
-    ("noise.strength", po::value< int >()->default_value(0));
+    ("noise.strength", po::value< int >()->default_value(0))
+    ("output.async", po::value< bool >()->default_value(true))
+    ("output.buffer-size", po::value< int >()->default_value(1024))
+    ("output.overflow", po::value< std::string >()->default_value("block"))
+    ("sampling.enabled", po::value< bool >()->default_value(false))
+    ("sampling.initial-rate", po::value< int >()->default_value(1000))
+    ("sampling.minimum-rate", po::value< int >()->default_value(1))
+    ("sampling.backoff", po::value< int >()->default_value(10))
+    ("sampling.burst", po::value< int >()->default_value(10));
 
   // Define the options which can be set through the command line
   cmdline.add_options()
@@ -1562,7 +1586,9 @@ void Settings::setupNoise() throw(SettingsError)
 
     if (fs::exists(file))
     { // If the path (expanded pattern) is valid, load the shared variables
-      m_coverage.svars.load(file);
+      // (binary files are detected automatically and mapped to the memory)
+      if (!m_coverage.svars.load(file)) SETTINGS_ERROR(FORMAT_STR(
+        "File '%1%' containing the shared variables is corrupted!\n", file));
 
       LOG("Shared variables loaded from file '" + file + "'.\n");
     }
@@ -1580,7 +1606,9 @@ void Settings::setupNoise() throw(SettingsError)
 
     if (fs::exists(file))
     { // If the path (expanded pattern) is valid, load the predecessors
-      m_coverage.preds.load(file);
+      // (binary files are detected automatically and mapped to the memory)
+      if (!m_coverage.preds.load(file)) SETTINGS_ERROR(FORMAT_STR(
+        "File '%1%' containing the predecessors is corrupted!\n", file));
 
       LOG("Predecessors loaded from file '" + file + "'.\n");
     }
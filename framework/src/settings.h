@@ -25,8 +25,8 @@
  * @file      settings.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-20
- * @date      Last Update 2020-04-14
- * @version   0.15.4
+ * @date      Last Update 2026-10-15
+ * @version   0.15.6
  */
 
 #ifndef __PINTOOL_ANACONDA__SETTINGS_H__
@@ -296,9 +296,9 @@ class Settings
    */
   typedef struct CoverageMonitors_s
   {
-    SyncCoverageMonitor< FileWriter > sync; //!< Synchronisation coverage.
-    SharedVariablesMonitor< FileWriter > svars; //!< Shared variables.
-    PredecessorsMonitor< FileWriter > preds; //!< Predecessors.
+    SyncCoverageMonitor< BinaryFileWriter > sync; //!< Sync coverage.
+    SharedVariablesMonitor< BinaryFileWriter > svars; //!< Shared variables.
+    PredecessorsMonitor< BinaryFileWriter > preds; //!< Predecessors.
   } CoverageMonitors;
 
   typedef InvalidatingTreeFilter< PatternInfo > Filter;
@@ -26,8 +26,8 @@
  * @file      types.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-02-13
- * @date      Last Update 2016-05-09
- * @version   0.4.2
+ * @date      Last Update 2026-10-16
+ * @version   0.4.4
  */
 
 #ifndef __PINTOOL_ANACONDA__TYPES_H__
@@ -78,14 +78,9 @@ typedef struct Variable_s
  */
 typedef struct Location_s
 {
-  std::string file; //!< A name of a file.
+  const std::string& file; //!< A name of a file.
   INT32 line; //!< A line number.
 
-  /**
-   * Constructs an object representing a source code location.
-   */
-  Location_s() : file(), line(-1) {}
-
   /**
    * Constructs an object representing a source code location.
    *
@@ -116,7 +111,7 @@ typedef struct Image_s
  */
 typedef struct Function_s
 {
-  const std::string name; //!< A name of the function.
+  const std::string& name; //!< A name of the function.
   const std::string& signature; //!< A (mangled) signature of the function.
   const index_t image; //!< An index of the image containing the function.
 
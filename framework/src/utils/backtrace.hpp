@@ -26,8 +26,8 @@
  * @file      backtrace.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-11-26
- * @date      Last Update 2013-05-30
- * @version   0.2.0.2
+ * @date      Last Update 2026-10-15
+ * @version   0.3
  */
 
 #ifndef __PINTOOL_ANACONDA__UTILS__BACKTRACE_HPP__
@@ -35,8 +35,15 @@
 
 #include "pin.H"
 
+#include <atomic>
+
 #include "../settings.h"
 
+/**
+ * @brief A number of buckets in a backtrace location cache.
+ */
+#define BACKTRACE_LOCATION_CACHE_BUCKETS 4096
+
 /**
  * @brief An enumeration of types of function implementations.
  */
@@ -106,6 +113,178 @@ std::string makeBacktraceLocation(ADDRINT insAddr)
   return location;
 }
 
+/**
+ * @brief A concurrent cache of locations of instructions used in backtraces.
+ *
+ * A lock-free hash table mapping addresses of instructions to their locations.
+ *   The table is append-only, locations are never removed or updated once they
+ *   are inserted, so the lookups do not need any locks. Insertions prepend the
+ *   new location to the chain of its bucket using a compare-and-swap.
+ *
+ * @note Obtained references to locations in the cache are always valid as the
+ *   locations are never removed.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+class BacktraceLocationCache
+{
+  private: // Type definitions
+    /**
+     * @brief A structure representing a cached location.
+     */
+    typedef struct Entry_s
+    {
+      ADDRINT addr; //!< An address of an instruction.
+      std::string location; //!< A location of the instruction.
+      Entry_s* next; //!< The next location in the same bucket.
+
+      /**
+       * Constructs an Entry_s object.
+       *
+       * @param a An address of an instruction.
+       * @param l A location of the instruction.
+       */
+      Entry_s(ADDRINT a, const std::string& l) : addr(a), location(l),
+        next(NULL) {}
+    } Entry;
+  private: // Internal variables
+    /**
+     * @brief Chains of cached locations (the most recently inserted first).
+     */
+    std::atomic< Entry* > m_buckets[BACKTRACE_LOCATION_CACHE_BUCKETS];
+  public: // Constructors
+    /**
+     * Constructs an empty backtrace location cache.
+     */
+    BacktraceLocationCache()
+    {
+      for (int i = 0; i < BACKTRACE_LOCATION_CACHE_BUCKETS; i++)
+        m_buckets[i].store(NULL, std::memory_order_relaxed);
+    }
+  public: // Inline generated methods
+    /**
+     * Gets a location of an instruction.
+     *
+     * @param addr An address of the instruction.
+     * @return The location of the instruction or @em NULL if the location is
+     *   not cached yet.
+     */
+    const std::string* find(ADDRINT addr) const
+    {
+      return this->find(addr, this->bucket(addr).load(
+        std::memory_order_acquire), NULL);
+    }
+
+    /**
+     * Inserts a location of an instruction.
+     *
+     * @note If some other thread inserted the location of the instruction in
+     *   the meantime, the location inserted by the other thread is used.
+     *
+     * @param addr An address of the instruction.
+     * @param location A location of the instruction.
+     * @return The location of the instruction stored in the cache.
+     */
+    const std::string& insert(ADDRINT addr, const std::string& location)
+    {
+      // Helper variables
+      std::atomic< Entry* >& bucket = this->bucket(addr);
+      Entry* entry = new Entry(addr, location);
+      Entry* head = bucket.load(std::memory_order_acquire);
+      const std::string* cached;
+
+      do
+      { // Entries are only prepended, check only the ones added since the
+        // last attempt, older entries were checked before
+        if ((cached = this->find(addr, head, entry->next)) != NULL)
+        { // Some other thread was faster, use its location
+          delete entry;
+
+          return *cached;
+        }
+
+        entry->next = head;
+      } while (!bucket.compare_exchange_weak(head, entry,
+        std::memory_order_release, std::memory_order_acquire));
+
+      return entry->location;
+    }
+  private: // Internal helper methods
+    /**
+     * Gets a bucket in which a location of an instruction is stored.
+     *
+     * @param addr An address of the instruction.
+     * @return The bucket in which the location of the instruction is stored.
+     */
+    std::atomic< Entry* >& bucket(ADDRINT addr)
+    {
+      return m_buckets[(addr ^ (addr >> 12)) % BACKTRACE_LOCATION_CACHE_BUCKETS];
+    }
+
+    /**
+     * Gets a bucket in which a location of an instruction is stored.
+     *
+     * @param addr An address of the instruction.
+     * @return The bucket in which the location of the instruction is stored.
+     */
+    const std::atomic< Entry* >& bucket(ADDRINT addr) const
+    {
+      return m_buckets[(addr ^ (addr >> 12)) % BACKTRACE_LOCATION_CACHE_BUCKETS];
+    }
+
+    /**
+     * Searches a part of a chain of cached locations for a location of an
+     *   instruction.
+     *
+     * @param addr An address of the instruction.
+     * @param first The first entry to check.
+     * @param last The entry at which the search stops (not checked).
+     * @return The location of the instruction or @em NULL if not found.
+     */
+    const std::string* find(ADDRINT addr, const Entry* first,
+      const Entry* last) const
+    {
+      for (const Entry* e = first; e != last; e = e->next)
+      { // The entries are immutable after they are inserted, no locks needed
+        if (e->addr == addr) return &e->location;
+      }
+
+      return NULL;
+    }
+};
+
+/**
+ * Creates a location for an instruction on a specific address which will be
+ *   used in a backtrace. Locations are cached, so each location is created
+ *   only once and the PIN client lock is taken only when creating it.
+ *
+ * @note This function can be used in PIN analysis functions.
+ *
+ * @tparam BV Determines how detailed the location will be.
+ *
+ * @param insAddr An address of an instruction.
+ * @return A location of the instruction.
+ */
+template < BacktraceVerbosity BV >
+inline
+const std::string& makeCachedBacktraceLocation(ADDRINT insAddr)
+{
+  // Each verbosity has its own cache, locations differ for each verbosity
+  static BacktraceLocationCache g_cache;
+
+  // Most of the locations are already cached, so try to find them first
+  const std::string* location = g_cache.find(insAddr);
+
+  if (location != NULL) return *location;
+
+  // Only locations not found in the cache need to be created (under a lock)
+  return g_cache.insert(insAddr, makeBacktraceLocation< BV, FI_LOCKED >(
+    insAddr));
+}
+
 /**
  * Creates a location for an instruction which will be used in a backtrace.
  *
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Contains implementation of functions for measuring time.
+ *
+ * A file containing implementation of functions for measuring time. Unlike the
+ *   local time provided by Boost, these functions do not use any shared state,
+ *   so they may be called from analysis routines without taking any locks.
+ *
+ * @file      clock.hpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+
+#ifndef __PINTOOL_ANACONDA__UTILS__CLOCK_HPP__
+  #define __PINTOOL_ANACONDA__UTILS__CLOCK_HPP__
+
+#include "pin.H"
+
+#ifdef TARGET_LINUX
+  #include <time.h>
+#else
+  #include <chrono>
+#endif
+
+// Helper macros for converting time units to nanoseconds
+#define NSECS_PER_USEC 1000ULL
+#define NSECS_PER_MSEC 1000000ULL
+#define NSECS_PER_SEC  1000000000ULL
+
+/**
+ * Gets the current value of a monotonic clock.
+ *
+ * @note On Linux, the clock is read through @c clock_gettime(CLOCK_MONOTONIC),
+ *   which is served by the vDSO without entering the kernel. The value is not
+ *   related to the wall-clock time and is only meaningful when compared with
+ *   other values returned by this function.
+ *
+ * @return The current value of the monotonic clock in nanoseconds.
+ */
+inline
+UINT64 getMonotonicTime()
+{
+#ifdef TARGET_LINUX
+  // Helper variables
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (UINT64)ts.tv_sec * NSECS_PER_SEC + (UINT64)ts.tv_nsec;
+#else
+  return std::chrono::duration_cast< std::chrono::nanoseconds >(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Gets a deadline lying a specific number of nanoseconds in the future.
+ *
+ * @param ns A number of nanoseconds from now.
+ * @return A value of the monotonic clock at which the deadline expires.
+ */
+inline
+UINT64 getDeadline(UINT64 ns)
+{
+  return getMonotonicTime() + ns;
+}
+
+#endif /* __PINTOOL_ANACONDA__UTILS__CLOCK_HPP__ */
+
+/** End of file clock.hpp **/
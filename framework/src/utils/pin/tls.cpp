@@ -20,52 +20,102 @@
 /**
  * @brief Contains implementation of TLS-related helper functions.
  *
- * A file containing implementation of functions for working with PIN's thread
+ * A file containing implementation of functions for working with the thread
  *   local storage (TLS).
  *
  * @file      tls.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-02-04
- * @date      Last Update 2012-02-04
- * @version   0.1
+ * @date      Last Update 2026-10-16
+ * @version   0.2.1
  */
 
 #include "tls.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+
+namespace
+{ // Static global variables (usable only within this module)
+  /**
+   * @brief Blocks of slots holding the data of the threads (indexed by thread
+   *   IDs).
+   */
+  THREAD_CONTEXT g_threadContexts[PIN_MAX_THREADS];
+  /**
+   * @brief Functions freeing the data stored in the slots (indexed by keys).
+   */
+  DESTRUCTFUN g_destructors[TLS_MAX_SLOTS];
+  /**
+   * @brief A key which will be allocated next.
+   */
+  std::atomic< TLS_KEY > g_nextKey(0);
+}
+
 /**
  * Allocates a new TLS key and associate it with a given destruction function.
  *
+ * @note Keys may be allocated during static initialisation, the variables used
+ *   here are initialised statically (before any code is executed).
+ *
+ * @warning If there are no free slots left, the program is terminated. Keys
+ *   are used without checking them, using an invalid key would corrupt the
+ *   data of other keys.
+ *
  * @param dfunc A function called before a thread finishes.
- * @return A new TLS key or -1 if the key cannot be created.
+ * @return A new TLS key.
  */
 TLS_KEY TLS_CreateThreadDataKey(DESTRUCTFUN dfunc)
 {
-  return PIN_CreateThreadDataKey(dfunc);
+  TLS_KEY key = g_nextKey++;
+
+  if (key >= TLS_MAX_SLOTS)
+  { // No more free slots, may be called before PIN is initialised, so print
+    // the error directly to the standard error output
+    fprintf(stderr, "error: cannot create a TLS key, all %d slots are used.\n",
+      TLS_MAX_SLOTS);
+    exit(EXIT_FAILURE);
+  }
+
+  g_destructors[key] = dfunc;
+
+  return key;
 }
 
 /**
- * Gets data stored in a specific TLS slot of a thread.
+ * Gets an array containing blocks of slots holding the data of the threads.
  *
- * @param key A TLS key identifying the slot where the data are stored.
- * @param tid A number uniquely identifying the thread.
- * @return The data stored in the slot.
+ * @return The array containing blocks of slots holding the data of the threads
+ *   (indexed by thread IDs).
  */
-VOID* TLS_GetThreadData(TLS_KEY key, THREADID tid)
+THREAD_CONTEXT* TLS_GetThreadContexts()
 {
-  return PIN_GetThreadData(key, tid);
+  return g_threadContexts;
 }
 
 /**
- * Stores data in a specific TLS slot of a thread.
+ * Frees all data stored in the thread local storage of a thread.
+ *
+ * @note This function is called when a thread finishes, the slots are cleared,
+ *   so a new thread with the same ID will start with empty slots.
  *
- * @param key A TLS key identifying the slot where the data should be stored.
- * @param data The data which should be stored in the slot.
- * @param tid A number uniquely identifying the thread.
- * @return @em True if the specified key is allocated, @em false otherwise.
+ * @param tid A number identifying the thread.
  */
-BOOL TLS_SetThreadData(TLS_KEY key, const VOID* data, THREADID tid)
+VOID freeThreadData(THREADID tid)
 {
-  return PIN_SetThreadData(key, data, tid);
+  // Helper variables
+  VOID* data;
+
+  for (TLS_KEY key = 0; key < TLS_MAX_SLOTS && key < g_nextKey; key++)
+  { // Free the data using the function associated with the key
+    if ((data = g_threadContexts[tid].slots[key]) == NULL) continue;
+
+    g_threadContexts[tid].slots[key] = NULL;
+
+    if (g_destructors[key] != NULL) g_destructors[key](data);
+  }
 }
 
 /** End of file tls.cpp **/
@@ -20,14 +20,16 @@
 /**
  * @brief Contains definitions of TLS-related helper functions.
  *
- * A file containing definitions of functions for working with PIN's thread
- *   local storage (TLS).
+ * A file containing definitions of functions for working with the thread local
+ *   storage (TLS). Instead of PIN's thread local storage, each thread has its
+ *   own block of slots in a dense array indexed by thread IDs, so the data can
+ *   be accessed by inline functions without calling into PIN or the framework.
  *
  * @file      tls.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2012-02-04
- * @date      Last Update 2013-06-05
- * @version   0.1.0.2
+ * @date      Last Update 2026-10-16
+ * @version   0.2.2
  */
 
 #ifndef __PINTOOL_ANACONDA__PIN__TLS_H__
@@ -35,11 +37,142 @@
 
 #include "pin.H"
 
+#include <assert.h>
+
 #include "../../defs.h"
 
+// A maximum number of slots (keys) available in the thread local storage
+#define TLS_MAX_SLOTS 32
+
+/**
+ * @brief A structure holding data stored in the thread local storage of a
+ *   thread.
+ *
+ * @note Blocks of different threads start at cache line boundaries, so threads
+ *   accessing their own data do not share cache lines.
+ */
+typedef struct alignas(CACHE_LINE_SIZE) ThreadContext_s
+{
+  VOID* slots[TLS_MAX_SLOTS]; //!< Data stored in each of the slots (keys).
+} THREAD_CONTEXT;
+
 API_FUNCTION TLS_KEY TLS_CreateThreadDataKey(DESTRUCTFUN dfunc);
-API_FUNCTION VOID* TLS_GetThreadData(TLS_KEY key, THREADID tid);
-API_FUNCTION BOOL TLS_SetThreadData(TLS_KEY key, const VOID* data, THREADID tid);
+API_FUNCTION THREAD_CONTEXT* TLS_GetThreadContexts();
+
+// Definitions of helper functions
+VOID freeThreadData(THREADID tid);
+
+/**
+ * Gets an array containing blocks of slots holding the data of the threads.
+ *
+ * @note The address of the array never changes, so it is obtained from the
+ *   framework only once (when first needed) and cached for later use.
+ *
+ * @return The array containing blocks of slots holding the data of the threads
+ *   (indexed by thread IDs).
+ */
+inline
+THREAD_CONTEXT* getThreadContexts()
+{
+  static THREAD_CONTEXT* const contexts = TLS_GetThreadContexts();
+
+  return contexts;
+}
+
+/**
+ * Gets data stored in a specific TLS slot of a thread.
+ *
+ * @param key A TLS key identifying the slot where the data are stored.
+ * @param tid A number uniquely identifying the thread.
+ * @return The data stored in the slot.
+ */
+inline
+VOID* TLS_GetThreadData(TLS_KEY key, THREADID tid)
+{
+  assert(key >= 0 && key < TLS_MAX_SLOTS && tid < PIN_MAX_THREADS);
+
+  return getThreadContexts()[tid].slots[key];
+}
+
+/**
+ * Stores data in a specific TLS slot of a thread.
+ *
+ * @param key A TLS key identifying the slot where the data should be stored.
+ * @param data The data which should be stored in the slot.
+ * @param tid A number uniquely identifying the thread.
+ * @return @em True if the specified key is allocated, @em false otherwise.
+ */
+inline
+BOOL TLS_SetThreadData(TLS_KEY key, const VOID* data, THREADID tid)
+{
+  if (key < 0 || key >= TLS_MAX_SLOTS || tid >= PIN_MAX_THREADS) return false;
+
+  getThreadContexts()[tid].slots[key] = const_cast< VOID* >(data);
+
+  return true;
+}
+
+/**
+ * @brief A slot in the thread local storage holding data of a specific type.
+ *
+ * Wraps a TLS key, so the data stored in the slot do not have to be cast from
+ *   and to @c VOID* by the user. The data of a thread are deleted when the
+ *   thread finishes.
+ *
+ * @tparam T A type of the data stored in the slot.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+template< typename T >
+class TlsSlot
+{
+  private: // Internal variables
+    TLS_KEY m_key; //!< A key identifying the slot.
+  public: // Constructors
+    /**
+     * Constructs a TlsSlot object.
+     */
+    TlsSlot() : m_key(TLS_CreateThreadDataKey(free)) {}
+
+  private: // Internal functions for releasing data
+    /**
+     * Frees data of a thread.
+     *
+     * @param data A pointer to the data.
+     */
+    static VOID free(VOID* data)
+    {
+      delete static_cast< T* >(data);
+    }
+
+  public: // Methods for accessing the data
+    /**
+     * Gets data of a thread stored in the slot.
+     *
+     * @param tid A number uniquely identifying the thread.
+     * @return The data of the thread.
+     */
+    inline
+    T* get(THREADID tid) const
+    {
+      return static_cast< T* >(TLS_GetThreadData(m_key, tid));
+    }
+
+    /**
+     * Stores data of a thread in the slot.
+     *
+     * @param tid A number uniquely identifying the thread.
+     * @param data The data of the thread.
+     */
+    inline
+    VOID set(THREADID tid, T* data) const
+    {
+      TLS_SetThreadData(m_key, data, tid);
+    }
+};
 
 #endif /* __PINTOOL_ANACONDA__PIN__TLS_H__ */
 
@@ -25,8 +25,8 @@
  * @file      random.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-05-10
- * @date      Last Update 2013-05-14
- * @version   0.2
+ * @date      Last Update 2026-10-16
+ * @version   0.3.1
  */
 
 #include "random.hpp"
@@ -34,31 +34,83 @@
 namespace detail
 { // Implementation details, never use directly!
 
+/**
+ * Deletes a random number generator of a thread.
+ *
+ * @param rng A random number generator.
+ */
+VOID deleteRng(VOID* rng)
+{
+  delete static_cast< RngEngine* >(rng);
+}
+
 // Initialise internal global variables
-RngEngine g_rng;
-PIN_MUTEX g_rngLock;
+TLS_KEY g_rngTlsKey = TLS_CreateThreadDataKey(deleteRng);
+UINT64 g_seed = 0; //!< A seed from which the seeds of all threads are derived.
+RngEngine g_unknownThreadRng;
+PIN_MUTEX g_unknownThreadRngLock;
 
 /**
- * Setups the random number generation module. Initialises the random number
- *   generator and locks ensuring exclusive access to it.
+ * Derives a seed of a random number generator of a thread from the global
+ *   seed.
+ *
+ * @param tid A number identifying the thread.
+ * @return The seed of the random number generator of the thread.
+ */
+inline
+RngEngine::result_type getSeed(THREADID tid)
+{
+  // Mix the global seed with the thread ID (the SplitMix64 finaliser), so the
+  // streams of threads with consecutive IDs are not correlated
+  UINT64 seed = g_seed + (tid + 1) * 0x9e3779b97f4a7c15ULL;
+  seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+  seed = seed ^ (seed >> 31);
+
+  return static_cast< RngEngine::result_type >(seed);
+}
+
+/**
+ * Creates a random number generator of a thread. The generator is seeded from
+ *   the global seed and the number identifying the thread, so each thread gets
+ *   its own stream of random numbers which is the same in every run using the
+ *   same global seed.
+ *
+ * @param tid A number identifying the thread.
+ * @return The random number generator of the thread.
+ */
+RngEngine* createRng(THREADID tid)
+{
+  RngEngine* rng = new RngEngine(getSeed(tid));
+
+  TLS_SetThreadData(g_rngTlsKey, rng, tid);
+
+  return rng;
+}
+
+/**
+ * Setups the random number generation module. Stores the seed from which the
+ *   random number generators of all threads are seeded and seeds the generator
+ *   used by threads not known to PIN.
  *
  * @param settings An object containing the ANaConDA framework's settings.
  */
 inline
 VOID setupRandomModule(Settings* settings)
 {
-  // Initialise a lock guarding access to the random number generator
-  PIN_MutexInit(&g_rngLock);
+  g_seed = settings->getSeed();
+
+  // Threads not known to PIN share a single generator with its own seed
+  g_unknownThreadRng.seed(getSeed(INVALID_THREADID));
 
-  // Initialise the random number generator
-  g_rng.seed(static_cast< RngEngine::result_type >(settings->getSeed()));
+  PIN_MutexInit(&g_unknownThreadRngLock);
 }
 
 } // namespace detail
 
 /**
- * Setups the random number generation module. Initialises the random number
- *   generator and locks ensuring exclusive access to it.
+ * Setups the random number generation module. Stores the seed from which the
+ *   random number generators of all threads are seeded.
  *
  * @param settings An object containing the ANaConDA framework's settings.
  */
@@ -27,8 +27,8 @@
  * @file      random.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-05-10
- * @date      Last Update 2013-05-30
- * @version   0.2.0.1
+ * @date      Last Update 2026-10-16
+ * @version   0.3.1
  */
 
 #ifndef __PINTOOL_ANACONDA__UTILS__RANDOM_HPP__
@@ -39,6 +39,8 @@
 
 #include "../settings.h"
 
+#include "pin/tls.h"
+
 #include "scopedlock.hpp"
 
 namespace detail
@@ -47,19 +49,72 @@ namespace detail
 // Type definitions
 typedef boost::random::mt11213b RngEngine;
 
-extern RngEngine g_rng; //!< A random number generator.
 /**
- * @brief A lock guarding access to the random number generator.
+ * @brief A TLS key identifying the random number generator of a thread.
+ *
+ * Each thread has its own random number generator, so threads never need to
+ *   synchronise when generating random numbers.
+ */
+extern TLS_KEY g_rngTlsKey;
+
+/**
+ * @brief A random number generator used by code not running in any thread
+ *   known to PIN (e.g., the code executed before the program starts).
+ *
+ * Such code may run in several threads at once, so the generator must always
+ *   be accessed while holding the @c g_unknownThreadRngLock lock.
+ */
+extern RngEngine g_unknownThreadRng;
+extern PIN_MUTEX g_unknownThreadRngLock; //!< Guards @c g_unknownThreadRng.
+
+// Definitions of internal functions
+RngEngine* createRng(THREADID tid);
+
+/**
+ * Gets a random number generator of a thread.
  *
- * Only the thread holding this lock might use the random number generator.
+ * @param tid A number identifying the thread.
+ * @return The random number generator of the thread.
  */
-extern PIN_MUTEX g_rngLock;
+inline
+RngEngine& getRng(THREADID tid)
+{
+  RngEngine* rng = static_cast< RngEngine* >(TLS_GetThreadData(g_rngTlsKey,
+    tid));
+
+  // First random number generated by the thread, create its generator
+  if (rng == NULL) rng = createRng(tid);
+
+  return *rng;
+}
 
 /**
  * Generates a random integer from the <@em min , @em max> interval.
  *
  * @tparam IT A type of the integer generated.
  *
+ * @param tid A number identifying the thread which generates the integer.
+ * @param min A minimal integer which might be generated.
+ * @param max A maximal integer which might be generated.
+ * @return An integer from the <@em min , @em max> interval.
+ */
+template< typename IT >
+inline
+IT randomInt(THREADID tid, IT min, IT max)
+{
+  // Restrict the generated integer to the <min, max> interval
+  boost::random::uniform_int_distribution< IT > dist(min, max);
+
+  // Each thread uses its own generator, no need to lock anything
+  return dist(getRng(tid));
+}
+
+/**
+ * Generates a random integer from the <@em min , @em max> interval in a thread
+ *   not known to PIN.
+ *
+ * @tparam IT A type of the integer generated.
+ *
  * @param min A minimal integer which might be generated.
  * @param max A maximal integer which might be generated.
  * @return An integer from the <@em min , @em max> interval.
@@ -69,13 +124,12 @@ inline
 IT randomInt(IT min, IT max)
 {
   // Restrict the generated integer to the <min, max> interval
-  boost::random::uniform_int_distribution<> dist(min, max);
+  boost::random::uniform_int_distribution< IT > dist(min, max);
 
-  // Random number generation is not thread-safe, must be done exclusively
-  ScopedLock lock(detail::g_rngLock);
+  // The generator is shared by all unknown threads, need to lock it
+  ScopedLock lock(g_unknownThreadRngLock);
 
-  // Generate a new random integer from the <min, max> interval
-  return dist(detail::g_rng);
+  return dist(g_unknownThreadRng);
 }
 
 } // namespace detail
@@ -85,6 +139,26 @@ IT randomInt(IT min, IT max)
  *
  * @tparam IT A type of the integer generated. Default is @c UINT32.
  *
+ * @param tid A number identifying the thread which generates the integer.
+ * @param min A minimal integer which might be generated.
+ * @param max A maximal integer which might be generated.
+ * @return An integer from the <@em min , @em max> interval.
+ */
+template< typename IT = UINT32 >
+inline
+IT randomInt(THREADID tid, IT min, IT max)
+{
+  return detail::randomInt< IT >(tid, min, max); // Concrete implementation
+}
+
+/**
+ * Generates a random integer from the <@em min , @em max> interval.
+ *
+ * @note Prefer the version taking the number identifying the thread when this
+ *   number is available, this version needs to obtain it from Intel PIN.
+ *
+ * @tparam IT A type of the integer generated. Default is @c UINT32.
+ *
  * @param min A minimal integer which might be generated.
  * @param max A maximal integer which might be generated.
  * @return An integer from the <@em min , @em max> interval.
@@ -93,7 +167,14 @@ template< typename IT = UINT32 >
 inline
 IT randomInt(IT min, IT max)
 {
-  return detail::randomInt< IT >(min, max); // Concrete implementation
+  // Helper variables
+  THREADID tid = PIN_ThreadId();
+
+  // Before the program starts, the thread is not known to PIN, so it has no
+  // generator of its own, use the generator reserved for such threads
+  if (tid == INVALID_THREADID) return detail::randomInt< IT >(min, max);
+
+  return detail::randomInt< IT >(tid, min, max); // Concrete implementation
 }
 
 // Definitions of helper functions
@@ -25,8 +25,8 @@
  * @file      tldata.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-05-31
- * @date      Last Update 2013-06-04
- * @version   0.2.0.1
+ * @date      Last Update 2026-10-15
+ * @version   0.2.1
  */
 
 #ifndef __PINTOOL_ANACONDA__UTILS__TLDATA_HPP__
@@ -36,6 +36,8 @@
 
 #include "thread.h"
 
+#include "pin/tls.h"
+
 /**
  * @brief Simplifies management of thread local data.
  *
@@ -66,21 +68,12 @@ class ThreadLocalData
     /**
      * Constructs a ThreadLocalData object.
      */
-    ThreadLocalData() : m_tlsKey(PIN_CreateThreadDataKey(free))
+    ThreadLocalData() : m_tlsKey(TLS_CreateThreadDataKey(free))
     {
       // Automatically initialise the data when a thread starts
       addThreadInitFunction(init, &m_tlsKey);
     }
 
-  public: // Destructors
-    /**
-     * Destroys a ThreadLocalData object.
-     */
-    ~ThreadLocalData()
-    {
-      PIN_DeleteThreadDataKey(m_tlsKey);
-    }
-
   private: // Internal functions for initialising and releasing data
     /**
      * Initialises local data of a thread.
@@ -91,7 +84,7 @@ class ThreadLocalData
      */
     static VOID init(THREADID tid, VOID* data)
     {
-      PIN_SetThreadData(*static_cast< TLS_KEY* >(data), new T(), tid);
+      TLS_SetThreadData(*static_cast< TLS_KEY* >(data), new T(), tid);
     }
 
     /**
@@ -114,7 +107,7 @@ class ThreadLocalData
     inline
     T* get(THREADID tid)
     {
-      return static_cast< T* >(PIN_GetThreadData(m_tlsKey, tid));
+      return static_cast< T* >(TLS_GetThreadData(m_tlsKey, tid));
     }
 };
 
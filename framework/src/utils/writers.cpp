@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2013-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2013-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -25,8 +25,8 @@
  * @file      writers.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-02-07
- * @date      Last Update 2015-06-01
- * @version   0.1.1
+ * @date      Last Update 2026-10-15
+ * @version   0.2
  */
 
 #include "writers.h"
@@ -69,4 +69,34 @@ void FileWriter::writeln(const std::string& data)
   m_file << data.c_str() << "\n";
 }
 
+/**
+ * Opens a file for writing binary data.
+ *
+ * @param path A path to the file.
+ */
+void BinaryFileWriter::open(const std::string& path)
+{
+  m_file.open(path, std::fstream::out | std::fstream::trunc
+    | std::fstream::binary);
+}
+
+/**
+ * Closes a file.
+ */
+void BinaryFileWriter::close()
+{
+  m_file.close();
+}
+
+/**
+ * Writes binary data to a file.
+ *
+ * @param data The data.
+ * @param size A size of the data in bytes.
+ */
+void BinaryFileWriter::write(const void* data, size_t size)
+{
+  m_file.write(static_cast< const char* >(data), size);
+}
+
 /** End of file writers.cpp **/
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2013-2020 Jan Fiedor <fiedorjan@centrum.cz>
+ * Copyright (C) 2013-2026 Jan Fiedor <fiedorjan@centrum.cz>
  *
  * This file is part of ANaConDA.
  *
@@ -25,14 +25,15 @@
  * @file      writers.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-02-07
- * @date      Last Update 2013-05-30
- * @version   0.1.0.1
+ * @date      Last Update 2026-10-15
+ * @version   0.2
  */
 
 #ifndef __PINTOOL_ANACONDA__UTILS__WRITERS_H__
   #define __PINTOOL_ANACONDA__UTILS__WRITERS_H__
 
 #include <fstream>
+#include <string>
 
 /**
  * @brief A class for writing data to a file.
@@ -56,6 +57,27 @@ class FileWriter
     void writeln(const std::string& data);
 };
 
+/**
+ * @brief A class for writing binary data to a file.
+ *
+ * Writes binary data to a file.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+class BinaryFileWriter
+{
+  private: // Internal variables
+    std::fstream m_file; //!< A file to which will the data be written.
+  public: // Control methods
+    void open(const std::string& path);
+    void close();
+  protected: // Write methods
+    void write(const void* data, size_t size);
+};
+
 #endif /* __PINTOOL_ANACONDA__UTILS__WRITERS_H__ */
 
 /** End of file writers.h **/
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 Jan Fiedor <fiedorjan@centrum.cz>
+ *
+ * This file is part of ANaConDA.
+ *
+ * ANaConDA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * ANaConDA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ANaConDA. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief A program printing binary coverage files in a text form.
+ *
+ * A program printing binary coverage files produced by the ANaConDA framework
+ *   in a text form.
+ *
+ * @file      covdump.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.2
+ */
+
+#include <string.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../src/monitors/format.h"
+
+namespace
+{ // Static global variables (usable only within this module)
+  const char* g_syncCoverageEventString[] = {
+    "VISITED",
+    "BLOCKED",
+    "BLOCKING"
+  };
+}
+
+/**
+ * Prints a synchronisation coverage file in a text form.
+ *
+ * @note Each record is printed on a separate line in the following format:
+ *   @c <function> @c <event-type> @c <count>.
+ *
+ * @param path A path to the file.
+ * @param data The content of the file.
+ * @return @em True if the file was printed successfully, @em false otherwise.
+ */
+bool dumpSyncCoverage(const char* path, const std::vector< char >& data)
+{
+  // Helper variables
+  SyncCoverageHeader header;
+
+  if (data.size() < sizeof(header))
+  { // All binary coverage files start with a header
+    std::cerr << path << ": truncated file\n";
+    return false;
+  }
+
+  memcpy(&header, data.data(), sizeof(header));
+
+  if (header.version != SYNC_COVERAGE_VERSION)
+  { // Older or newer versions of the format are not supported
+    std::cerr << path << ": unsupported version " << header.version << "\n";
+    return false;
+  }
+
+  if (header.records
+    > (data.size() - sizeof(header)) / sizeof(SyncCoverageRecord))
+  { // The file is shorter than its header claims
+    std::cerr << path << ": truncated file\n";
+    return false;
+  }
+
+  // Helper variables
+  std::vector< SyncCoverageRecord > records(header.records);
+  std::vector< std::string > functions;
+  const char* names = data.data() + sizeof(header)
+    + records.size() * sizeof(SyncCoverageRecord);
+  const char* end = data.data() + data.size();
+
+  if (!records.empty())
+    memcpy(records.data(), data.data() + sizeof(header),
+      records.size() * sizeof(SyncCoverageRecord));
+
+  while (functions.size() < header.functions && names < end)
+  { // Names of the functions are NUL-terminated
+    functions.push_back(std::string(names, strnlen(names, end - names)));
+    names += functions.back().size() + 1;
+  }
+
+  if (functions.size() < header.functions || names > end)
+  { // The file is shorter than its header claims
+    std::cerr << path << ": truncated file\n";
+    return false;
+  }
+
+  for (const SyncCoverageRecord& record : records)
+  { // Check the indices before using them, the file might be corrupted
+    if (record.function >= functions.size() || record.event >= SCE_COUNT)
+    { // The file is corrupted, do not print anything more
+      std::cerr << path << ": invalid record\n";
+      return false;
+    }
+
+    std::cout << functions[record.function] << " "
+      << g_syncCoverageEventString[record.event] << " " << record.count
+      << "\n";
+  }
+
+  return true;
+}
+
+/**
+ * Prints a shared variables file in a text form.
+ *
+ * @note The names of the shared variables are printed first, one per line, in
+ *   the same format as the text shared variables files. The addresses of the
+ *   shared variables follow in the @c <address> @c <name> format.
+ *
+ * @param path A path to the file.
+ * @param data The content of the file.
+ * @return @em True if the file was printed successfully, @em false otherwise.
+ */
+bool dumpSvarsCoverage(const char* path, const std::vector< char >& data)
+{
+  // Helper variables
+  const SvarsCoverageHeader* header = getSvarsCoverage(data.data(),
+    data.size());
+
+  if (header == NULL)
+  { // The file is corrupted or has an unsupported version
+    std::cerr << path << ": invalid or unsupported file\n";
+    return false;
+  }
+
+  // Helper variables
+  const SvarsCoverageAddress* addresses = getSvarsCoverageAddresses(header);
+  const uint32_t* variables = getSvarsCoverageVariables(header);
+  const char* strings = getSvarsCoverageStrings(header);
+
+  for (uint32_t i = 0; i < header->variables; i++)
+  { // Print the names in the format of the text files
+    std::cout << strings + variables[i] << "\n";
+  }
+
+  for (uint64_t i = 0; i < header->addresses; i++)
+  { // Print the addresses as hexadecimal numbers
+    std::cout << "0x" << std::hex << addresses[i].addr << std::dec << " "
+      << strings + variables[addresses[i].variable] << "\n";
+  }
+
+  return true;
+}
+
+/**
+ * Prints a predecessors file in a text form.
+ *
+ * @note The addresses of the instructions with predecessors are printed one
+ *   per line, in the same format as the text predecessors files.
+ *
+ * @param path A path to the file.
+ * @param data The content of the file.
+ * @return @em True if the file was printed successfully, @em false otherwise.
+ */
+bool dumpPredsCoverage(const char* path, const std::vector< char >& data)
+{
+  // Helper variables
+  const PredsCoverageHeader* header = getPredsCoverage(data.data(),
+    data.size());
+
+  if (header == NULL)
+  { // The file is corrupted or has an unsupported version
+    std::cerr << path << ": invalid or unsupported file\n";
+    return false;
+  }
+
+  // Helper variables
+  const uint64_t* instructions = getPredsCoverageInstructions(header);
+
+  for (uint64_t i = 0; i < header->instructions; i++)
+  { // Print the addresses as hexadecimal numbers
+    std::cout << "0x" << std::hex << instructions[i] << std::dec << "\n";
+  }
+
+  return true;
+}
+
+/**
+ * Prints binary coverage files in a text form.
+ *
+ * @param argc A number of arguments passed to the program.
+ * @param argv A list of arguments passed to the program.
+ * @return @em 0 if all files were printed successfully, @em 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  { // At least one file must be specified
+    std::cerr << "usage: " << argv[0] << " <coverage-file>...\n";
+    return 1;
+  }
+
+  // Helper variables
+  int result = 0;
+
+  for (int i = 1; i < argc; i++)
+  { // Print all of the files given, one after another
+    std::ifstream f(argv[i], std::ifstream::in | std::ifstream::binary);
+
+    if (!f)
+    { // Skip files which cannot be opened
+      std::cerr << argv[i] << ": cannot open the file\n";
+      result = 1;
+      continue;
+    }
+
+    // The files are processed in the memory, read the whole file
+    std::vector< char > data((std::istreambuf_iterator< char >(f)),
+      std::istreambuf_iterator< char >());
+
+    if (hasCoverageMagic(data.data(), data.size(), SYNC_COVERAGE_MAGIC))
+    { // Synchronisation coverage
+      if (!dumpSyncCoverage(argv[i], data)) result = 1;
+    }
+    else if (hasCoverageMagic(data.data(), data.size(), SVARS_COVERAGE_MAGIC))
+    { // Shared variables
+      if (!dumpSvarsCoverage(argv[i], data)) result = 1;
+    }
+    else if (hasCoverageMagic(data.data(), data.size(), PREDS_COVERAGE_MAGIC))
+    { // Predecessors
+      if (!dumpPredsCoverage(argv[i], data)) result = 1;
+    }
+    else
+    { // Unknown type of file
+      std::cerr << argv[i] << ": not a binary coverage file\n";
+      result = 1;
+    }
+  }
+
+  return result;
+}
+
+/** End of file covdump.cpp **/
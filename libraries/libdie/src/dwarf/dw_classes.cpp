@@ -27,8 +27,8 @@
  * @file      dw_classes.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-08-02
- * @date      Last Update 2013-03-26
- * @version   0.6
+ * @date      Last Update 2026-10-16
+ * @version   0.7.1
  */
 
 #include "dw_classes.h"
@@ -2293,7 +2293,8 @@ DwEnumerator::~DwEnumerator()
  * Constructs a DwSubprogram object.
  */
 DwSubprogram::DwSubprogram()
-  : DwTag< DwSubprogram, DW_TAG_subprogram >()
+  : DwTag< DwSubprogram, DW_TAG_subprogram >(), m_dataObjects(),
+  m_dataObjectsCompiled(false)
 {
 }
 
@@ -2303,7 +2304,8 @@ DwSubprogram::DwSubprogram()
  * @param die A DWARF debugging information entry.
  */
 DwSubprogram::DwSubprogram(Dwarf_Die& die)
-  : DwTag< DwSubprogram, DW_TAG_subprogram >(die)
+  : DwTag< DwSubprogram, DW_TAG_subprogram >(die), m_dataObjects(),
+  m_dataObjectsCompiled(false)
 {
 }
 
@@ -2313,7 +2315,8 @@ DwSubprogram::DwSubprogram(Dwarf_Die& die)
  * @param s A DWARF subprogram debugging information entry object.
  */
 DwSubprogram::DwSubprogram(const DwSubprogram& s)
-  : DwTag< DwSubprogram, DW_TAG_subprogram >(s)
+  : DwTag< DwSubprogram, DW_TAG_subprogram >(s),
+  m_dataObjects(s.m_dataObjects), m_dataObjectsCompiled(s.m_dataObjectsCompiled)
 {
 }
 
@@ -2325,21 +2328,17 @@ DwSubprogram::~DwSubprogram()
 }
 
 /**
- * Finds a data object (variable, formal parameter or constant) which is stored
- *   at a specific address.
+ * Compiles the locations of all data objects (variables and formal parameters)
+ *   of a subprogram into a flat table which can be searched without walking
+ *   the tree of DWARF debugging information entries of the subprogram.
  *
- * @param accessedAddr An address at which is the data object stored.
- * @param insAddr An address of the instruction which accessed the data object.
- *   Needed to compute the frame base address if needed.
- * @param registers An object holding the content of the registers.
- * @param offset An offset between the accessed address and the base address at
- *   which is the found data object stored. If @em NULL, the offset will not be
- *   set by the method.
- * @return The data object which is stored at the specified address or @em NULL
- *   if no data object was found.
+ * @note Only locations which are frame base, register or base register based
+ *   are stored in the table as other locations cannot be evaluated anyway.
+ *
+ * @warning This method is not thread-safe. It should be called once when the
+ *   debugging information is loaded, before the table is used by any thread.
  */
-DwDie* DwSubprogram::findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
-  DwRegisters& registers, unsigned int* offset)
+void DwSubprogram::compileDataObjects()
 {
   // A visitor for finding variables, formal parameters and constants
   DwDataObjectFinder finder;
@@ -2347,27 +2346,27 @@ DwDie* DwSubprogram::findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
   // Find all variables, formal parameters and constants
   this->accept(finder);
 
-  // Get the frame base for the instruction which has accessed the data object
-  Dwarf_Addr frameBaseAddr = this->getFrameBaseAddress(insAddr, registers);
-
   // Helper variables
   std::list< DwDie* >::const_iterator it;
 
+  // Start with an empty table, the method may be called more than once
+  m_dataObjects.clear();
+
   for (it = finder.getDataObjects().begin();
     it != finder.getDataObjects().end(); it++)
-  { // Search through all found data objects
+  { // Process all found data objects
     Dwarf_Loc *location = NULL;
-    Dwarf_Unsigned size = 0;
+    Dwarf_Data_Object dobj;
 
     switch ((*it)->getTag())
     { // Get the location and size of the data object
       case DW_TAG_variable:// The data object is a variable
         location = static_cast< DwVariable* >(*it)->getLocation();
-        size = static_cast< DwVariable* >(*it)->getSize();
+        dobj.size = static_cast< DwVariable* >(*it)->getSize();
         break;
       case DW_TAG_formal_parameter: // The data object is a formal parameter
         location = static_cast< DwFormalParameter* >(*it)->getLocation();
-        size = static_cast< DwFormalParameter* >(*it)->getSize();
+        dobj.size = static_cast< DwFormalParameter* >(*it)->getSize();
         break;
       default: // The data object finder may collect only the above DIE objects
         assert(false);
@@ -2377,8 +2376,94 @@ DwDie* DwSubprogram::findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
     // Data objects without location are present only in the source code
     if (location == NULL) continue;
 
-    // Evaluate the address at which is the data object stored
-    Dwarf_Addr baseAddr = evaluateLocExpr(*location, registers, frameBaseAddr);
+    if (location->lr_atom == DW_OP_fbreg)
+    { // The address is 'frame base address + signed constant'
+      dobj.kind = DW_OP_fbreg;
+      dobj.reg = 0;
+      dobj.offset = (Dwarf_Signed)location->lr_number;
+    }
+    else if (DW_OP_reg0 <= location->lr_atom && location->lr_atom <= DW_OP_reg31)
+    { // The address is in a register
+      dobj.kind = DW_OP_reg0;
+      dobj.reg = location->lr_atom - DW_OP_reg0;
+      dobj.offset = 0;
+    }
+    else if (DW_OP_breg0 <= location->lr_atom
+      && location->lr_atom <= DW_OP_breg31)
+    { // The address is 'register + signed constant'
+      dobj.kind = DW_OP_breg0;
+      dobj.reg = location->lr_atom - DW_OP_breg0;
+      dobj.offset = (Dwarf_Signed)location->lr_number;
+    }
+    else
+    { // Other locations cannot be evaluated, no need to keep them
+      continue;
+    }
+
+    dobj.die = *it;
+
+    // Keep the order of the DIE tree, the first data object found at an address
+    // is returned, so overlapping data objects (e.g. variables from disjoint
+    // lexical blocks sharing a stack slot or a data object containing another
+    // one) must be checked in the same order as when walking the tree
+    m_dataObjects.push_back(dobj);
+  }
+
+  m_dataObjectsCompiled = true;
+}
+
+/**
+ * Finds a data object (variable, formal parameter or constant) which is stored
+ *   at a specific address.
+ *
+ * @note If the table of data objects is not compiled yet, it is compiled when
+ *   this method is called for the first time.
+ *
+ * @param accessedAddr An address at which is the data object stored.
+ * @param insAddr An address of the instruction which accessed the data object.
+ *   Needed to compute the frame base address if needed.
+ * @param registers An object holding the content of the registers.
+ * @param offset An offset between the accessed address and the base address at
+ *   which is the found data object stored. If @em NULL, the offset will not be
+ *   set by the method.
+ * @return The data object which is stored at the specified address or @em NULL
+ *   if no data object was found.
+ */
+DwDie* DwSubprogram::findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
+  DwRegisters& registers, unsigned int* offset)
+{
+  // The table is usually compiled when the debugging information is loaded
+  if (!m_dataObjectsCompiled) this->compileDataObjects();
+
+  // Helper variables
+  Dwarf_Addr frameBaseAddr = 0;
+  bool frameBaseAddrValid = false;
+  Dwarf_Data_Object_Table::const_iterator it;
+
+  for (it = m_dataObjects.begin(); it != m_dataObjects.end(); it++)
+  { // Search through all data objects
+    Dwarf_Addr baseAddr = 0;
+
+    switch (it->kind)
+    { // Evaluate the address at which is the data object stored
+      case DW_OP_fbreg: // The address is 'frame base address + signed constant'
+        if (!frameBaseAddrValid)
+        { // Get the frame base for the instruction which accessed the data
+          frameBaseAddr = this->getFrameBaseAddress(insAddr, registers);
+          frameBaseAddrValid = true;
+        }
+        baseAddr = frameBaseAddr + it->offset;
+        break;
+      case DW_OP_reg0: // The address is in a register
+        baseAddr = registers.getValue(it->reg);
+        break;
+      case DW_OP_breg0: // The address is 'register + signed constant'
+        baseAddr = registers.getValue(it->reg) + it->offset;
+        break;
+      default: // Only the above locations are stored in the table
+        assert(false);
+        break;
+    }
 
     if (baseAddr == accessedAddr)
     { // The accessed address matches the base address of some data object
@@ -2386,16 +2471,16 @@ DwDie* DwSubprogram::findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
       { // Accessed the beginning of some data object => no offset
         *offset = 0;
       } // Return the found data object
-      return *it;
+      return it->die;
     }
 
-    if (baseAddr <= accessedAddr && accessedAddr < baseAddr + size)
+    if (baseAddr <= accessedAddr && accessedAddr < baseAddr + it->size)
     { // The accessed address is in a range of memory of a larger data object
       if (offset != NULL)
       { // Compute the offset between the accessed address and the base address
         *offset = accessedAddr - baseAddr;
       } // Return the found data object
-      return *it;
+      return it->die;
     }
   }
 
@@ -25,8 +25,8 @@
  * @file      dw_classes.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-08-02
- * @date      Last Update 2013-03-26
- * @version   0.6
+ * @date      Last Update 2026-10-16
+ * @version   0.7.1
  */
 
 #ifndef __LIBDIE__DWARF__DW_CLASSES_H__
@@ -34,6 +34,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #include "boost/shared_ptr.hpp"
 
@@ -1244,6 +1245,32 @@ class DwEnumerator
     virtual ~DwEnumerator();
 };
 
+/**
+ * @brief A structure representing a precompiled location of a data object.
+ *
+ * Represents a location of a data object (variable or formal parameter) local
+ *   to a subprogram in a form which can be evaluated without walking the tree
+ *   of DWARF debugging information entries of the subprogram.
+ *
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+typedef struct Dwarf_Data_Object_s
+{
+  /**
+   * @brief Determines how to evaluate the location of the data object. Can be
+   *   @c DW_OP_fbreg, @c DW_OP_reg0 (any register) or @c DW_OP_breg0 (any base
+   *   register).
+   */
+  Dwarf_Small kind;
+  Dwarf_Half reg; //!< A DWARF register number (for register locations only).
+  Dwarf_Signed offset; //!< A constant added to the frame base or register.
+  Dwarf_Unsigned size; //!< A size in bytes of the data object.
+  DwDie* die; //!< A DWARF DIE object representing the data object.
+} Dwarf_Data_Object;
+
 /**
  * @brief A class representing a DWARF subprogram debugging information entry.
  *
@@ -1251,12 +1278,25 @@ class DwEnumerator
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-08-02
- * @date      Last Update 2011-12-05
- * @version   0.1.3.2
+ * @date      Last Update 2026-10-15
+ * @version   0.2
  */
 class DwSubprogram
   : public DwTag< DwSubprogram, DW_TAG_subprogram >
 {
+  public: // Type definitions
+    typedef std::vector< Dwarf_Data_Object > Dwarf_Data_Object_Table;
+  private: // Created variables
+    /**
+     * @brief A table containing precompiled locations of all data objects
+     *   (variables and formal parameters) of the subprogram, in the order in
+     *   which they appear in the tree of DWARF debugging information entries.
+     */
+    Dwarf_Data_Object_Table m_dataObjects;
+    /**
+     * @brief A flag determining if the table of data objects is compiled.
+     */
+    bool m_dataObjectsCompiled;
   public: // Constructors
     DwSubprogram();
     DwSubprogram(Dwarf_Die& die);
@@ -1264,9 +1304,22 @@ class DwSubprogram
   public: // Destructors
     virtual ~DwSubprogram();
   public: // Member methods
+    void compileDataObjects();
     DwDie* findDataObject(Dwarf_Addr accessedAddr, Dwarf_Addr insAddr,
       DwRegisters& registers, unsigned int* offset = NULL);
   public: // Inline member methods
+    /**
+     * Gets a read-only table containing precompiled locations of all data
+     *   objects (variables and formal parameters) of a subprogram.
+     *
+     * @return A read-only table containing precompiled locations of all data
+     *   objects of the subprogram.
+     */
+    const Dwarf_Data_Object_Table& getDataObjects() const
+    {
+      return m_dataObjects;
+    }
+
     /**
      * Gets a relocated address of the first machine instruction generated for
      *   a subroutine (subprogram).
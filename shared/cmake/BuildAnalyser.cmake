@@ -1,5 +1,5 @@
 #
-# Copyright (C) 2012-2020 Jan Fiedor <fiedorjan@centrum.cz>
+# Copyright (C) 2012-2026 Jan Fiedor <fiedorjan@centrum.cz>
 #
 # This file is part of ANaConDA.
 #
@@ -23,8 +23,8 @@
 # File:      BuildAnalyser.cmake
 # Author:    Jan Fiedor (fiedorjan@centrum.cz)
 # Date:      Created 2012-02-26
-# Date:      Last Update 2019-02-01
-# Version:   0.8
+# Date:      Last Update 2026-10-16
+# Version:   0.9.1
 #
 
 # Set the minimum CMake version needed
@@ -88,6 +88,8 @@ if (UNIX)
     add_definitions(-m32)
     # Link the analysers against 32-bit libraries (default are 64-bit)
     set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} -m32")
+    # Link the programs accompanying the analysers against them too
+    set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -m32")
   endif (CROSS_COMPILING_32_ON_64)
   # Perform no optimizations and include debugging information in debug mode
   if (DEBUG)
@@ -114,4 +116,16 @@ endif (WIN32)
 # Install the analyser
 install(TARGETS anaconda-${ANALYSER_NAME} DESTINATION ${CMAKE_INSTALL_LIBDIR})
 
+# Create programs accompanying the analyser (e.g., programs processing files
+# written by the analyser), each source file in the tools directory is one
+# standalone program which does not use PIN or the framework
+file(GLOB TOOLS tools/*.cpp)
+
+foreach (TOOL ${TOOLS})
+  get_filename_component(TOOL_NAME ${TOOL} NAME_WE)
+  add_executable(anaconda-${ANALYSER_NAME}-${TOOL_NAME} ${TOOL})
+  install(TARGETS anaconda-${ANALYSER_NAME}-${TOOL_NAME}
+    DESTINATION ${CMAKE_INSTALL_BINDIR})
+endforeach (TOOL)
+
 # End of file BuildAnalyser.cmake
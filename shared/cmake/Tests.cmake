@@ -23,8 +23,8 @@
 # File:      Tests.cmake
 # Author:    Jan Fiedor (fiedorjan@centrum.cz)
 # Date:      Created 2016-03-24
-# Date:      Last Update 2020-05-30
-# Version:   0.14
+# Date:      Last Update 2026-10-16
+# Version:   0.15.1
 #
 
 # Enable commands for defining tests 
@@ -311,6 +311,14 @@ macro(ADD_ANACONDA_TEST TEST)
   # Schedule the test to perform
   add_test(${TEST} bash -o pipefail -c "${CMD}")
 
+  # Run the test in its directory, so files it creates do not clash
+  set_tests_properties(${TEST} PROPERTIES
+    WORKING_DIRECTORY "${TEST_DIR}/${TEST}/${TEST_WORK_DIR}")
+
+  # Output filters may run the framework again (e.g. to load files it wrote)
+  set_tests_properties(${TEST} PROPERTIES
+    ENVIRONMENT "SOURCE_DIR=$ENV{SOURCE_DIR}")
+
   # Set a timeout for the test
   if (TEST_CONFIG_TIMEOUT)
     set_tests_properties(${TEST} PROPERTIES TIMEOUT ${TEST_CONFIG_TIMEOUT})
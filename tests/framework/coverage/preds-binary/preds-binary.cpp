@@ -0,0 +1,25 @@
+/**
+ * @brief Tests writing and loading predecessors.
+ *
+ * @file      preds-binary.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#include "../../../shared/defs.h"
+
+int g_shared = 0;
+
+int main(int argc, char* argv[])
+{
+  FUNCTION_START
+
+  g_shared = 1;
+  g_shared = 2;
+
+  FUNCTION_EXIT
+}
+
+/** End of file preds-binary.cpp **/
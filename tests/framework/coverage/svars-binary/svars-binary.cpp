@@ -0,0 +1,44 @@
+/**
+ * @brief Tests writing shared variables in the binary format.
+ *
+ * @file      svars-binary.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#include <thread>
+
+#include "../../../shared/defs.h"
+
+int g_shared = 0;
+int g_private = 0;
+
+void worker_thread(int n)
+{
+  FUNCTION_START
+
+  g_shared = n;
+
+  FUNCTION_EXIT
+}
+
+int main(int argc, char* argv[])
+{
+  FUNCTION_START
+
+  g_private = 1;
+
+  std::thread first (worker_thread, 1);
+
+  first.join();
+
+  std::thread second (worker_thread, 2);
+
+  second.join();
+
+  FUNCTION_EXIT
+}
+
+/** End of file svars-binary.cpp **/
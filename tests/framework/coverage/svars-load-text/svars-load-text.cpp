@@ -0,0 +1,26 @@
+/**
+ * @brief Tests loading shared variables from a file.
+ *
+ * @file      svars-load-text.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#include "../../../shared/defs.h"
+
+int g_shared = 0;
+int g_private = 0;
+
+int main(int argc, char* argv[])
+{
+  FUNCTION_START
+
+  g_private = 1;
+  g_shared = 1;
+
+  FUNCTION_EXIT
+}
+
+/** End of file svars-load-text.cpp **/
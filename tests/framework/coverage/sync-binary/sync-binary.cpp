@@ -0,0 +1,21 @@
+/**
+ * @brief Tests writing synchronisation coverage in the binary format.
+ *
+ * @file      sync-binary.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-16
+ * @date      Last Update 2026-10-16
+ * @version   0.1
+ */
+
+#include <mutex>
+
+int main(int argc, char* argv[])
+{
+  std::mutex lock;
+
+  lock.lock();
+  lock.unlock();
+}
+
+/** End of file sync-binary.cpp **/
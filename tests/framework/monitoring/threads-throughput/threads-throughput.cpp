@@ -0,0 +1,59 @@
+/**
+ * @brief Measures the throughput of monitored thread creation.
+ *
+ * Creates many short-lived threads in small batches (like a thread pool does)
+ *   and prints how many threads were created per second. The throughput is
+ *   printed to the standard error output, so it is not compared with the
+ *   expected result.
+ *
+ * @file      threads-throughput.cpp
+ * @author    Jan Fiedor (fiedorjan@centrum.cz)
+ * @date      Created 2026-10-15
+ * @date      Last Update 2026-10-15
+ * @version   0.1
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../../shared/defs.h"
+
+#define THREAD_COUNT 1000
+#define BATCH_SIZE 8
+
+void short_lived_thread()
+{
+}
+
+int main(int argc, char* argv[])
+{
+  FUNCTION_START
+
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+
+  for (int created = 0; created < THREAD_COUNT; created += BATCH_SIZE)
+  { // Create a batch of threads and wait until all of them finish
+    std::vector< std::thread > batch;
+
+    for (int i = 0; i < BATCH_SIZE; i++)
+      batch.push_back(std::thread(short_lived_thread));
+
+    for (std::thread& thread : batch)
+      thread.join();
+  }
+
+  std::chrono::duration< double > elapsed
+    = std::chrono::steady_clock::now() - start;
+
+  printf("created %d threads\n", THREAD_COUNT);
+  fflush(stdout);
+
+  fprintf(stderr, "thread creation throughput: %.0f threads/s\n",
+    THREAD_COUNT / elapsed.count());
+
+  FUNCTION_EXIT
+}
+
+/** End of file threads-throughput.cpp **/
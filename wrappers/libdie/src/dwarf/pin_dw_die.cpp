@@ -27,8 +27,8 @@
  * @file      pin_dw_die.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-12
- * @date      Last Update 2019-02-05
- * @version   0.2.2
+ * @date      Last Update 2026-10-16
+ * @version   0.2.5
  */
 
 #include "pin_dw_die.h"
@@ -395,6 +395,98 @@ void dwarf_get_data_object(T* dobj, unsigned int* offset, Dwarf_Unsigned size,
   }
 }
 
+/**
+ * Gets a name and type of a global variable.
+ *
+ * @param var A global variable.
+ * @param name A reference to a string to which will be stored the name of the
+ *   variable.
+ * @param type A reference to a string to which will be stored the type of the
+ *   variable.
+ */
+inline
+void dwarf_get_global_variable_info(DwVariable* var, std::string& name,
+  std::string& type)
+{
+  DwDie* spec = var->getSpecification();
+
+  if (spec != NULL)
+  { // Referencing to a specification, must be a static data member
+    assert(spec->getTag() == DW_TAG_member);
+
+    name = spec->getParent()->getName() + std::string(".") + spec->getName();
+    type = static_cast< DwMember* >(spec)->getDeclarationSpecifier();
+  }
+  else
+  { // No reference to a specification, must be a global variable
+    name = var->getName();
+    type = var->getDeclarationSpecifier();
+  }
+}
+
+/**
+ * Gets a global variable stored on an accessed address.
+ *
+ * @note The accessed address may point anywhere inside the variable, e.g., to
+ *   a member of a structure or to an element of an array.
+ *
+ * @param accessAddr The accessed address.
+ * @param name A reference to a string to which will be stored the name of the
+ *   variable.
+ * @param type A reference to a string to which will be stored the type of the
+ *   variable.
+ * @return @em True if the variable was found, @em false otherwise.
+ */
+bool dwarf_get_global_variable(ADDRINT accessAddr, std::string& name,
+  std::string& type)
+{
+  // Global variables are indexed by the addresses where they are stored
+  Dwarf_Variable_Map::iterator it = g_globalVarMap.find(accessAddr);
+
+  if (it == g_globalVarMap.end()) return false; // No global variable here
+
+  // TODO: Provide also the offset of inner accesses within global variables
+  dwarf_get_global_variable_info(it->second, name, type);
+
+  return true;
+}
+
+/**
+ * Enumerates global variables of an image (executable, shared object, dynamic
+ *   library, ...).
+ *
+ * @note The image must be opened before its global variables are enumerated.
+ *
+ * @param image An object representing the image.
+ * @param callback A function called for each global variable of the image.
+ * @param val A pointer to arbitrary data passed to the callback function.
+ */
+void dwarf_get_global_variables(IMG image, GLOBALVARFUNPTR callback, VOID* val)
+{
+  // Get the debugging information extracted when the image was opened
+  std::map< std::string, DebugInfo* >::iterator dbgInfo = g_dbgInfoMap.find(
+    IMG_Name(image));
+
+  if (dbgInfo == g_dbgInfoMap.end()) return; // Image not opened
+
+  // Index only the global variables of the specified image
+  Dwarf_Variable_Map index;
+  DwGlobalVariableIndexer globalVarIndexer(index);
+  // The debug info must always be DWARF debug info here, static cast to it
+  static_cast< DwarfDebugInfo* >(dbgInfo->second)->accept(globalVarIndexer);
+
+  // Helper variables
+  std::string name;
+  std::string type;
+
+  for (Dwarf_Variable_Map::iterator it = index.begin(); it != index.end(); it++)
+  { // The index maps the whole address range at which is the variable situated
+    dwarf_get_global_variable_info(it->second, name, type);
+
+    callback(it->first.min, it->first.max, name, type, val);
+  }
+}
+
 /**
  * Gets a variable stored on an accessed address.
  *
@@ -423,26 +515,7 @@ bool dwarf_get_variable(ADDRINT rtnAddr, ADDRINT insnAddr, ADDRINT accessAddr,
   if (offset == NULL) offset = &tempOffset;
 
   // Check if the variable accessed is not a global variable first
-  Dwarf_Variable_Map::iterator it = g_globalVarMap.find(accessAddr);
-
-  if (it != g_globalVarMap.end())
-  { // A global variable is accessed, get its name and type
-    // TODO: Provide also the offset of inner accesses within global variables
-    DwDie* spec = it->second->getSpecification();
-
-    if (spec != NULL)
-    { // Referencing to a specification, must be a static data member
-      assert(spec->getTag() == DW_TAG_member);
-
-      name = spec->getParent()->getName() + std::string(".") + spec->getName();
-      type = static_cast< DwMember* >(spec)->getDeclarationSpecifier();
-    }
-    else
-    { // No reference to a specification, must be a global variable
-      name = it->second->getName();
-      type = it->second->getDeclarationSpecifier();
-    }
-  }
+  dwarf_get_global_variable(accessAddr, name, type);
 
   if (g_functionMap.find(rtnAddr) == g_functionMap.end())
   { // No information about variables in the specified routine
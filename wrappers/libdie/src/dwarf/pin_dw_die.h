@@ -27,8 +27,8 @@
  * @file      pin_dw_die.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-10-12
- * @date      Last Update 2012-02-11
- * @version   0.1.1
+ * @date      Last Update 2026-10-16
+ * @version   0.1.3
  */
 
 #ifndef __LIBPIN_DIE__DWARF__PIN_DW_DIE_H__
@@ -38,10 +38,17 @@
 
 #include "pin.H"
 
+#include "../pin_die.h"
+
 void dwarf_open(IMG image);
 
 void dwarf_print(IMG image);
 
+bool dwarf_get_global_variable(ADDRINT accessAddr, std::string& name,
+  std::string& type);
+
+void dwarf_get_global_variables(IMG image, GLOBALVARFUNPTR callback, VOID* val);
+
 bool dwarf_get_variable(ADDRINT rtnAddr, ADDRINT insnAddr, ADDRINT accessAddr,
   INT32 size, const CONTEXT *registers, std::string& name, std::string& type,
   UINT32 *offset = NULL);
@@ -27,8 +27,8 @@
  * @file      pin_dw_visitors.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-09-15
- * @date      Last Update 2013-03-08
- * @version   0.2
+ * @date      Last Update 2026-10-15
+ * @version   0.2.1
  */
 
 #include "pin_dw_visitors.h"
@@ -55,6 +55,10 @@ DwFunctionIndexer::~DwFunctionIndexer()
 void DwFunctionIndexer::visit(DwSubprogram& s)
 {
   m_index[s.getLowPC()] = &s;
+
+  // Precompile the locations of the variables and parameters of the function
+  // now, the lookup performed on each memory access can then use them as is
+  s.compileDataObjects();
 }
 
 /**
@@ -27,8 +27,8 @@
  * @file      pin_die.cpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-09-13
- * @date      Last Update 2012-05-31
- * @version   0.1.2
+ * @date      Last Update 2026-10-16
+ * @version   0.1.5
  */
 
 #include "pin_die.h"
@@ -60,6 +60,50 @@ void DIE_Print(IMG image)
 #endif
 }
 
+/**
+ * Gets a global variable stored on an accessed address.
+ *
+ * @note Unlike DIE_GetVariable, this function does not need the values of the
+ *   registers, so it can be used at instrumentation time when the accessed
+ *   address is known statically. The accessed address may point anywhere
+ *   inside the variable.
+ *
+ * @param accessAddr The accessed address.
+ * @param name A reference to a string to which will be stored the name of the
+ *   variable.
+ * @param type A reference to a string to which will be stored the type of the
+ *   variable.
+ * @return @em True if the variable was found, @em false otherwise.
+ */
+bool DIE_GetGlobalVariable(ADDRINT accessAddr, std::string& name,
+  std::string& type)
+{
+#ifdef TARGET_LINUX
+  return dwarf_get_global_variable(accessAddr, name, type);
+#else
+  return false;
+#endif
+}
+
+/**
+ * Enumerates global variables of an image (executable, shared object, dynamic
+ *   library, ...).
+ *
+ * @note The image must be opened before its global variables are enumerated.
+ *   The callback function gets the range of addresses at which the variable
+ *   is stored (the upper bound is the first address after the variable).
+ *
+ * @param image An object representing the image.
+ * @param callback A function called for each global variable of the image.
+ * @param val A pointer to arbitrary data passed to the callback function.
+ */
+void DIE_GetGlobalVariables(IMG image, GLOBALVARFUNPTR callback, VOID* val)
+{
+#ifdef TARGET_LINUX
+  dwarf_get_global_variables(image, callback, val);
+#endif
+}
+
 /**
  * Gets a variable stored on an accessed address.
  *
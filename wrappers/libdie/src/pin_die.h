@@ -27,8 +27,8 @@
  * @file      pin_die.h
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2011-09-13
- * @date      Last Update 2012-02-11
- * @version   0.1.1
+ * @date      Last Update 2026-10-16
+ * @version   0.1.3
  */
 
 #ifndef __LIBPIN_DIE__PIN_DIE_H__
@@ -38,10 +38,19 @@
 
 #include "pin.H"
 
+// Type definitions
+typedef VOID (*GLOBALVARFUNPTR)(ADDRINT low, ADDRINT high,
+  const std::string& name, const std::string& type, VOID* val);
+
 void DIE_Open(IMG image);
 
 void DIE_Print(IMG image);
 
+bool DIE_GetGlobalVariable(ADDRINT accessAddr, std::string& name,
+  std::string& type);
+
+void DIE_GetGlobalVariables(IMG image, GLOBALVARFUNPTR callback, VOID* val);
+
 bool DIE_GetVariable(ADDRINT rtnAddr, ADDRINT insnAddr, ADDRINT accessAddr,
   INT32 size, const CONTEXT *registers, std::string& name, std::string& type,
   UINT32 *offset = NULL);
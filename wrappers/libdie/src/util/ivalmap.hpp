@@ -25,8 +25,8 @@
  * @file      ivalmap.hpp
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-03-07
- * @date      Last Update 2013-03-08
- * @version   0.3
+ * @date      Last Update 2026-10-16
+ * @version   0.3.2
  */
 
 #ifndef __LIBPIN_DIE__UTIL__IVALMAP_HPP__
@@ -49,8 +49,8 @@
  *
  * @author    Jan Fiedor (fiedorjan@centrum.cz)
  * @date      Created 2013-03-07
- * @date      Last Update 2013-03-08
- * @version   0.3
+ * @date      Last Update 2026-10-16
+ * @version   0.3.2
  */
 template< typename KEY, typename VALUE >
 class IntervalMap
@@ -118,12 +118,26 @@ class IntervalMap
       iterator it = m_map.lower_bound(Interval(key, key));
 
       // Lower bound will give us the only interval which may contain the key
-      if (it->first.min <= key && key < it->first.max) return it;
+      // (there is no such interval if the key is below all of the intervals)
+      if (it != m_map.end() && it->first.min <= key && key < it->first.max)
+        return it;
 
       // No interval found
       return m_map.end();
     }
 
+    /**
+     * Returns an iterator referring to the first element in the map container.
+     *
+     * @note The elements are ordered from the highest interval to the lowest.
+     *
+     * @return An iterator to the first element in the container.
+     */
+    iterator begin()
+    {
+      return m_map.begin();
+    }
+
     /**
      * Returns an iterator referring to the @em past-the-end element in the map
      *   container.